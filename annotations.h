@@ -89,6 +89,14 @@
 # define UNREACHABLE ASSUME(false)
 #endif
 
+#if __has_builtin(__builtin_expect) || defined(__GNUC__)
+# define LIKELY(x) __builtin_expect(!!(x), 1)
+# define UNLIKELY(x) __builtin_expect(!!(x), 0)
+#else
+# define LIKELY(x) (x)
+# define UNLIKELY(x) (x)
+#endif
+
 #if __has_feature(nullability)
 # define ASSUME_NONNULL_BEGIN _Pragma("clang assume_nonnull begin")
 # define ASSUME_NONNULL_END _Pragma("clang assume_nonnull end")
@@ -0,0 +1,42 @@
+/*
+  bench.h
+  sc_bench
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#ifndef SC_BENCH_H
+#define SC_BENCH_H
+
+#include <stdio.h>
+#include <time.h>
+
+#include "annotations.h"
+
+
+/* Keeps the optimizer from deleting the work being measured */
+extern volatile long long g_benchSink;
+
+static inline double bench_now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* Prints one result line in a format that's easy to diff between runs */
+static inline void bench_report(const char* _Nonnull name, unsigned long long iters, double seconds) {
+	printf("%-32s %12llu iters %10.2f ns/iter\n", name, iters, seconds * 1e9 / (double)iters);
+}
+
+/* Run `body` `iters` times with loop counter `i` and report the average time per iteration */
+#define BENCH(name, iters, i, body) do { \
+	unsigned long long _iters = (iters); \
+	double _start = bench_now(); \
+	for(unsigned long long i = 0; i < _iters; i++) { \
+		body; \
+	} \
+	bench_report((name), _iters, bench_now() - _start); \
+} while(0)
+
+#endif /* SC_BENCH_H */
@@ -0,0 +1,80 @@
+/*
+  bench_batch.c
+  sc_bench
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "bench.h"
+#include "generic.h"
+#include "supercalc.h"
+
+#define LINES 1000000
+
+volatile long long g_benchSink;
+
+
+static void genInput(FILE* fp) {
+	for(int i = 0; i < LINES; i++) {
+		switch(i % 4) {
+			case 0: fprintf(fp, "x = %d\n", i); break;
+			case 1: fprintf(fp, "x * 3 + %d / 7\n", i); break;
+			case 2: fprintf(fp, "<x, %d> * 2\n", i % 1000); break;
+			case 3: fprintf(fp, "(x - %d) ^ 2 / 3 + 0.5\n", i % 100); break;
+		}
+	}
+}
+
+static void reportLines(const char* name, double seconds) {
+	bench_report(name, LINES, seconds);
+	printf("%-32s %12.0f lines/sec\n", "", LINES / seconds);
+}
+
+int main(void) {
+	char path[] = "/tmp/sc_bench_XXXXXX";
+	int fd = mkstemp(path);
+	FILE* fp = fdopen(fd, "w");
+	genInput(fp);
+	fclose(fp);
+	
+	int devnull = open("/dev/null", O_WRONLY);
+	int savedStdout = dup(STDOUT_FILENO);
+	fflush(stdout);
+	
+	/* The interactive loop, reading with getline and printing each result with printf */
+	Input_current()->file = fopen(path, "r");
+	SuperCalc* sc = SuperCalc_new();
+	dup2(devnull, STDOUT_FILENO);
+	double start = bench_now();
+	SuperCalc_run(sc);
+	fflush(stdout);
+	double seconds = bench_now() - start;
+	dup2(savedStdout, STDOUT_FILENO);
+	SuperCalc_free(sc);
+	fclose(Input_current()->file);
+	Input_current()->file = NULL;
+	reportLines("SuperCalc_run 1M lines", seconds);
+	
+	/* Batch mode, mapping the input and buffering the output */
+	FILE* out = fdopen(devnull, "w");
+	fd = open(path, O_RDONLY);
+	sc = SuperCalc_new();
+	start = bench_now();
+	g_benchSink = SuperCalc_runBatch(sc, fd, out);
+	seconds = bench_now() - start;
+	SuperCalc_free(sc);
+	close(fd);
+	reportLines("SuperCalc_runBatch 1M lines", seconds);
+	
+	fclose(out);
+	close(savedStdout);
+	unlink(path);
+	return 0;
+}
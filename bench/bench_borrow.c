@@ -0,0 +1,68 @@
+/*
+  bench_borrow.c
+  sc_bench
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "generic.h"
+#include "value.h"
+#include "context.h"
+#include "statement.h"
+
+#define ITERS 100000ull
+#define LENGTH 256
+
+volatile long long g_benchSink;
+
+
+static void run(Context* ctx, const char* line) {
+	Statement* stmt = Statement_parse(&line);
+	Value_free(Statement_eval(stmt, ctx, V_NONE));
+	Statement_free(stmt);
+}
+
+static void bench_expr(const Context* ctx, const char* expr) {
+	const char* p = expr;
+	Value* tree = Value_parseTop(&p);
+	
+	BENCH(expr, ITERS, i, {
+		Value* ret = Value_eval(tree, ctx);
+		g_benchSink = ret->type;
+		Value_free(ret);
+	});
+	
+	Value_free(tree);
+}
+
+int main(void) {
+	Context* ctx = Context_new();
+	
+	/* Reading these globals used to copy all of them first */
+	char* line = fmalloc(LENGTH * 8 + 16);
+	strcpy(line, "v = <0");
+	unsigned i;
+	for(i = 1; i < LENGTH; i++) {
+		sprintf(line + strlen(line), ", %u", i);
+	}
+	strcat(line, ">");
+	run(ctx, line);
+	destroy(line);
+	
+	run(ctx, "g = |x| x * 3 + 1");
+	run(ctx, "w = <1, 2, 3>");
+	
+	bench_expr(ctx, "dot(v, v)");
+	bench_expr(ctx, "dot(w, w)");
+	bench_expr(ctx, "map(g, w)");
+	bench_expr(ctx, "mag(w)");
+	
+	Context_free(ctx);
+	return 0;
+}
@@ -0,0 +1,72 @@
+/*
+  bench_ddreal.c
+  sc_bench
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "bench.h"
+#include "ddreal.h"
+
+#define ITERS 2000000ull
+#define TERMS 1000000
+
+volatile long long g_benchSink;
+
+
+int main(void) {
+	/* Cost of each double-double kernel relative to plain doubles */
+	double d = 1.0;
+	BENCH("double mul+add", ITERS, i, {
+		d = d * 1.0000001 + 1e-9;
+	});
+	g_benchSink = (long long)d;
+	
+	DDReal x = DDReal_fromDouble(1.0);
+	const DDReal m = DDReal_fromDouble(1.0000001);
+	const DDReal c = DDReal_fromDouble(1e-9);
+	BENCH("ddreal mul+add", ITERS, i, {
+		x = DDReal_add(DDReal_mul(x, m), c);
+	});
+	g_benchSink = (long long)x.hi;
+	
+	BENCH("ddreal div", ITERS, i, {
+		x = DDReal_div(c, DDReal_fromInt((long long)i + 1));
+	});
+	g_benchSink = (long long)x.hi;
+	
+	BENCH("ddreal sqrt", ITERS / 10, i, {
+		x = DDReal_sqrt(DDReal_fromInt((long long)i + 2));
+	});
+	g_benchSink = (long long)x.hi;
+	
+	BENCH("ddreal exp", ITERS / 100, i, {
+		x = DDReal_exp(DDReal_fromFrac((long long)i % 1000, 100));
+	});
+	g_benchSink = (long long)x.hi;
+	
+	/* Accuracy: sum 1/k backwards with both representations and compare to a double-double reference */
+	double dsum = 0.0;
+	DDReal xsum = DDReal_fromDouble(0.0);
+	for(long long k = TERMS; k > 0; k--) {
+		dsum += 1.0 / (double)k;
+		xsum = DDReal_add(xsum, DDReal_fromFrac(1, k));
+	}
+	
+	double fwd = 0.0;
+	for(long long k = 1; k <= TERMS; k++) {
+		fwd += 1.0 / (double)k;
+	}
+	
+	char* repr = DDReal_repr(xsum);
+	printf("\nH(%d) as ddreal:           %s\n", TERMS, repr);
+	free(repr);
+	printf("double error (backward):  %.3g\n", fabs(DDReal_asReal(DDReal_sub(DDReal_fromDouble(dsum), xsum))));
+	printf("double error (forward):   %.3g\n", fabs(DDReal_asReal(DDReal_sub(DDReal_fromDouble(fwd), xsum))));
+	return 0;
+}
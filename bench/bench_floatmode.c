@@ -0,0 +1,69 @@
+/*
+  bench_floatmode.c
+  sc_bench
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "generic.h"
+#include "value.h"
+#include "context.h"
+#include "statement.h"
+#include "defaults.h"
+
+#define ITERS 20000ull
+
+volatile long long g_benchSink;
+
+/* Expressions in the style of the README examples */
+static const char* _exprs[] = {
+	"(2 / 7) ^ 2",
+	"-(3 + 4!/7)^3",
+	"sqrt(9/16) + 5/4",
+	"(1/3 + 1/5) * 7/11 - 2/9",
+	"2 ^ (3/4) * 3 ^ -2",
+	"<1, 4, 5> / <4, 6, 2>",
+	"dot(<1/2, 1/3, 1/5>, <3/7, 2/9, 4/11>)"
+};
+
+
+static void bench_mode(Context* ctx, Statement** stmts, NUMMODE mode, const char* name) {
+	Context_setMode(ctx, mode);
+	
+	BENCH(name, ITERS, i, {
+		for(unsigned s = 0; s < ARRSIZE(_exprs); s++) {
+			Value* ret = Statement_eval(stmts[s], ctx, V_NONE);
+			g_benchSink = ret->type;
+			Value_free(ret);
+		}
+	});
+}
+
+int main(void) {
+	Context* ctx = Context_new();
+	Input_current()->file = fopen("/dev/null", "r");
+	
+	Statement* stmts[ARRSIZE(_exprs)];
+	for(unsigned s = 0; s < ARRSIZE(_exprs); s++) {
+		const char* p = _exprs[s];
+		stmts[s] = Statement_parse(&p);
+	}
+	
+	printf("Evaluating %u expressions per iteration\n", (unsigned)ARRSIZE(_exprs));
+	bench_mode(ctx, stmts, MODE_EXACT, "exact mode");
+	bench_mode(ctx, stmts, MODE_FLOAT, "float mode");
+	
+	for(unsigned s = 0; s < ARRSIZE(_exprs); s++) {
+		Statement_free(stmts[s]);
+	}
+	
+	fclose(Input_current()->file);
+	Input_current()->file = NULL;
+	Context_free(ctx);
+	return 0;
+}
@@ -0,0 +1,85 @@
+/*
+  bench_fracsum.c
+  sc_bench
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "generic.h"
+#include "value.h"
+#include "context.h"
+#include "vector.h"
+#include "arglist.h"
+
+#define TERMS 200000ull
+#define DOT_LEN 2000u
+#define DOT_ITERS 20ull
+
+volatile long long g_benchSink;
+
+
+/* Sum of (i%7 + 1)/(i%12 + 2), where the lowest-terms denominator stays small */
+static Value* sum_series(bool eager) {
+	Value* acc = ValInt(0);
+	
+	for(unsigned long long i = 0; i < TERMS; i++) {
+		Fraction term = {(long long)(i % 7) + 1, (long long)(i % 12) + 2};
+		Value* next = Fraction_add(&term, acc);
+		
+		if(eager) {
+			/* What every operation used to cost */
+			Value_canonicalize(next);
+		}
+		
+		Value_free(acc);
+		acc = next;
+	}
+	
+	Value_canonicalize(acc);
+	return acc;
+}
+
+static Vector* frac_vector(unsigned count, long long seed) {
+	ArgList* vals = ArgList_new(count);
+	
+	for(unsigned i = 0; i < count; i++) {
+		vals->args[i] = ValFrac(Fraction_new((long long)(i % 5) + seed, (long long)(i % 8) + 2));
+	}
+	
+	return Vector_new(vals);
+}
+
+int main(void) {
+	Context* ctx = Context_new();
+	
+	BENCH("fraction series (eager gcd)", 1, i, {
+		Value* sum = sum_series(true);
+		g_benchSink = sum->type;
+		Value_free(sum);
+	});
+	
+	BENCH("fraction series (lazy gcd)", 1, i, {
+		Value* sum = sum_series(false);
+		g_benchSink = sum->type;
+		Value_free(sum);
+	});
+	
+	Vector* u = frac_vector(DOT_LEN, 1);
+	Vector* v = frac_vector(DOT_LEN, 3);
+	
+	BENCH("dot of fraction vectors", DOT_ITERS, i, {
+		Value* dot = Vector_dot(u, v, ctx);
+		g_benchSink = dot->type;
+		Value_free(dot);
+	});
+	
+	Vector_free(u);
+	Vector_free(v);
+	Context_free(ctx);
+	return 0;
+}
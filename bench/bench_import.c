@@ -0,0 +1,66 @@
+/*
+  bench_import.c
+  sc_bench
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "generic.h"
+#include "supercalc.h"
+#include "scc.h"
+
+#define ITERS 20ull
+#define DEFS 2000
+
+volatile long long g_benchSink;
+
+
+/* A large library of function definitions in the style of std/turing.scs */
+static void genLibrary(FILE* fp) {
+	for(int i = 0; i < DEFS; i++) {
+		fprintf(fp, "# helper %d\n", i);
+		fprintf(fp, "f%d(a, b) = b_and(a * %d + b ^ 2, <a, b, %d.5>) - (a + b) / %d\n", i, i, i, i + 1);
+	}
+}
+
+static void benchImport(const char* name, const char* path, bool compile) {
+	BENCH(name, ITERS, i, {
+		SuperCalc* sc = SuperCalc_new();
+		sc->compileImports = compile;
+		Error* err = SuperCalc_importFile(sc, path);
+		g_benchSink = (long long)(size_t)err;
+		Error_free(err);
+		SuperCalc_free(sc);
+	});
+}
+
+int main(void) {
+	Input_current()->file = fopen("/dev/null", "r");
+	
+	char path[] = "/tmp/sc_bench_XXXXXX";
+	int fd = mkstemp(path);
+	FILE* fp = fdopen(fd, "w");
+	genLibrary(fp);
+	fclose(fp);
+	
+	benchImport("import 2k defs (parse)", path, false);
+	
+	/* First import writes the .scc, so every timed one loads it */
+	benchImport("import 2k defs (compiled)", path, true);
+	
+	char* sccPath = Scc_path(path);
+	unlink(sccPath);
+	destroy(sccPath);
+	unlink(path);
+	
+	fclose(Input_current()->file);
+	Input_current()->file = NULL;
+	return 0;
+}
@@ -0,0 +1,85 @@
+/*
+  bench_intops.c
+  sc_bench
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "generic.h"
+#include "value.h"
+#include "context.h"
+
+#define ITERS 20000000ull
+#define EVAL_ITERS 2000000ull
+
+volatile long long g_benchSink;
+
+
+/* Baseline: the raw machine operation with no overflow check */
+static void bench_kernels(void) {
+	long long acc = 1;
+	
+	BENCH("add (unchecked)", ITERS, i, {
+		acc = (long long)((unsigned long long)acc + i) ^ (acc >> 3);
+	});
+	g_benchSink = acc;
+	
+	BENCH("add_overflow", ITERS, i, {
+		if(UNLIKELY(add_overflow(acc, (long long)i, &acc))) {
+			acc = 0;
+		}
+		acc ^= acc >> 3;
+	});
+	g_benchSink = acc;
+	
+	BENCH("mul (unchecked)", ITERS, i, {
+		acc = (long long)((unsigned long long)acc * (i | 1));
+	});
+	g_benchSink = acc;
+	
+	BENCH("mul_overflow", ITERS, i, {
+		if(UNLIKELY(mul_overflow(acc, (long long)(i & 0xff) | 1, &acc))) {
+			acc = 1;
+		}
+	});
+	g_benchSink = acc;
+	
+	BENCH("ipow_overflow(3, 39)", ITERS / 10, i, {
+		long long r;
+		ipow_overflow(3, 39 - (long long)(i & 1), &r);
+		acc ^= r;
+	});
+	g_benchSink = acc;
+}
+
+/* Full interpreter path: BinOp_eval on two integer literals */
+static void bench_eval(const Context* ctx, const char* name, BINTYPE op, long long a, long long b) {
+	BinOp* node = BinOp_new(op, ValInt(a), ValInt(b));
+	
+	BENCH(name, EVAL_ITERS, i, {
+		Value* ret = BinOp_eval(node, ctx);
+		g_benchSink = ret->type;
+		Value_free(ret);
+	});
+	
+	BinOp_free(node);
+}
+
+int main(void) {
+	Context* ctx = Context_new();
+	
+	bench_kernels();
+	
+	bench_eval(ctx, "eval 123456 + 654321", BIN_ADD, 123456, 654321);
+	bench_eval(ctx, "eval 123456 * 654321", BIN_MUL, 123456, 654321);
+	bench_eval(ctx, "eval 3 ^ 39", BIN_POW, 3, 39);
+	bench_eval(ctx, "eval 2^62 * 4 (overflow)", BIN_MUL, 1ll << 62, 4);
+	
+	Context_free(ctx);
+	return 0;
+}
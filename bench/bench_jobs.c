@@ -0,0 +1,73 @@
+/*
+  bench_jobs.c
+  sc_bench
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "bench.h"
+#include "generic.h"
+#include "supercalc.h"
+
+#define LINES 200000
+
+volatile long long g_benchSink;
+
+
+/* Mostly independent lines, with an assignment acting as a barrier now and then */
+static void genInput(FILE* fp) {
+	fprintf(fp, "f(a) = a ^ 2 + 1\nv = <1, 2, 3>\n");
+	for(int i = 0; i < LINES; i++) {
+		switch(i % 4) {
+			case 0: fprintf(fp, "%d * 3 + %d / 7\n", i, i); break;
+			case 1: fprintf(fp, "f(%d) - 2\n", i % 50); break;
+			case 2: fprintf(fp, "v * %d\n", i % 9); break;
+			case 3: fprintf(fp, "(%d - v[1]) ^ 3 / 11\n", i % 100); break;
+		}
+		
+		if(i % 5000 == 4999) {
+			fprintf(fp, "v = v + <1, 1, 1>\n");
+		}
+	}
+}
+
+static void benchJobs(const char* name, const char* path, FILE* out, unsigned jobs) {
+	int fd = open(path, O_RDONLY);
+	SuperCalc* sc = SuperCalc_new();
+	sc->jobs = jobs;
+	
+	double start = bench_now();
+	g_benchSink = SuperCalc_runBatch(sc, fd, out);
+	double seconds = bench_now() - start;
+	
+	SuperCalc_free(sc);
+	close(fd);
+	
+	bench_report(name, LINES, seconds);
+	printf("%-32s %12.0f lines/sec\n", "", LINES / seconds);
+}
+
+int main(void) {
+	char path[] = "/tmp/sc_bench_XXXXXX";
+	int fd = mkstemp(path);
+	FILE* fp = fdopen(fd, "w");
+	genInput(fp);
+	fclose(fp);
+	
+	FILE* out = fopen("/dev/null", "w");
+	
+	benchJobs("batch 200k lines, 1 job", path, out, 1);
+	benchJobs("batch 200k lines, 2 jobs", path, out, 2);
+	benchJobs("batch 200k lines, 4 jobs", path, out, 4);
+	
+	fclose(out);
+	unlink(path);
+	return 0;
+}
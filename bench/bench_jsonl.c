@@ -0,0 +1,75 @@
+/*
+  bench_jsonl.c
+  sc_bench
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "bench.h"
+#include "generic.h"
+#include "supercalc.h"
+
+#define LINES 500000
+
+volatile long long g_benchSink;
+
+
+static void genInput(FILE* fp, bool jsonl) {
+	char expr[64];
+	for(int i = 0; i < LINES; i++) {
+		switch(i % 4) {
+			case 0: snprintf(expr, sizeof(expr), "x = %d", i); break;
+			case 1: snprintf(expr, sizeof(expr), "x * 3 + %d / 7", i); break;
+			case 2: snprintf(expr, sizeof(expr), "<x, %d> * 2", i % 1000); break;
+			case 3: snprintf(expr, sizeof(expr), "(x - %d) ^ 2 / 3 + 0.5", i % 100); break;
+		}
+		
+		if(jsonl) {
+			fprintf(fp, "{\"id\": %d, \"expr\": \"%s\"}\n", i, expr);
+		}
+		else {
+			fprintf(fp, "%s\n", expr);
+		}
+	}
+}
+
+static void reportRequests(const char* name, double seconds) {
+	bench_report(name, LINES, seconds);
+	printf("%-32s %12.3f us/request\n", "", seconds * 1e6 / LINES);
+}
+
+static double timeMode(bool jsonl, FILE* out) {
+	char path[] = "/tmp/sc_bench_XXXXXX";
+	int fd = mkstemp(path);
+	FILE* fp = fdopen(fd, "w");
+	genInput(fp, jsonl);
+	fclose(fp);
+	
+	fd = open(path, O_RDONLY);
+	SuperCalc* sc = SuperCalc_new();
+	double start = bench_now();
+	g_benchSink = jsonl ? SuperCalc_runJsonl(sc, fd, out) : SuperCalc_runBatch(sc, fd, out);
+	double seconds = bench_now() - start;
+	SuperCalc_free(sc);
+	close(fd);
+	unlink(path);
+	return seconds;
+}
+
+int main(void) {
+	FILE* out = fopen("/dev/null", "w");
+	
+	/* Same expressions as plain lines, to show what the JSON framing costs */
+	reportRequests("SuperCalc_runBatch 500k lines", timeMode(false, out));
+	reportRequests("SuperCalc_runJsonl 500k requests", timeMode(true, out));
+	
+	fclose(out);
+	return 0;
+}
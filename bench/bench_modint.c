@@ -0,0 +1,75 @@
+/*
+  bench_modint.c
+  sc_bench
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "bench.h"
+#include "modint.h"
+#include "generic.h"
+#include "value.h"
+#include "context.h"
+#include "statement.h"
+#include "defaults.h"
+
+#define ITERS 200000ull
+#define STMT_ITERS 2000ull
+
+volatile long long g_benchSink;
+
+
+/* Square-and-multiply using a 128-bit remainder for every product */
+static uint64_t naivePowmod(uint64_t base, uint64_t exp, uint64_t m) {
+	uint64_t ret = 1 % m;
+	while(exp > 0) {
+		if(exp & 1) {
+			ret = (uint64_t)((unsigned __int128)ret * base % m);
+		}
+		base = (uint64_t)((unsigned __int128)base * base % m);
+		exp >>= 1;
+	}
+	return ret;
+}
+
+int main(void) {
+	/* Largest 63-bit prime, so every product needs the full width */
+	const uint64_t m = 9223372036854775783ull;
+	ModRing ring;
+	ModRing_init(&ring, m);
+	
+	uint64_t acc = 0;
+	BENCH("powmod (128-bit remainder)", ITERS, i, {
+		acc += naivePowmod(i + 2, m - 2, m);
+	});
+	g_benchSink = (long long)acc;
+	
+	acc = 0;
+	BENCH("powmod (Montgomery)", ITERS, i, {
+		acc += ModRing_pow(&ring, i + 2, m - 2);
+	});
+	g_benchSink = (long long)acc;
+	
+	/* End to end through the builtin, elementwise over a vector */
+	Context* ctx = Context_new();
+	Input_current()->file = fopen("/dev/null", "r");
+	
+	const char* expr = "powmod(<2, 3, 5, 7, 11, 13, 17, 19>, 9223372036854775781, 9223372036854775783)";
+	Statement* stmt = Statement_parse(&expr);
+	BENCH("powmod builtin over 8 residues", STMT_ITERS, i, {
+		Value* ret = Statement_eval(stmt, ctx, V_NONE);
+		g_benchSink = ret->type;
+		Value_free(ret);
+	});
+	
+	Statement_free(stmt);
+	fclose(Input_current()->file);
+	Input_current()->file = NULL;
+	Context_free(ctx);
+	return 0;
+}
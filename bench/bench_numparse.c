@@ -0,0 +1,67 @@
+/*
+  bench_numparse.c
+  sc_bench
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "generic.h"
+#include "value.h"
+#include "statement.h"
+
+#define LITERALS 1000000
+
+volatile long long g_benchSink;
+
+
+/* A vector literal holding LITERALS numbers in a mix of integer, decimal and scientific forms */
+static char* genLiterals(void) {
+	char* ret = fmalloc(LITERALS * 24 + 3);
+	char* p = ret;
+	
+	*p++ = '<';
+	for(int i = 0; i < LITERALS; i++) {
+		switch(i % 4) {
+			case 0: p += sprintf(p, "%d", i); break;
+			case 1: p += sprintf(p, "%d.%03d", i % 1000, i % 997); break;
+			case 2: p += sprintf(p, "0.%06d", i); break;
+			case 3: p += sprintf(p, "%d.%de-%d", i % 10, i % 100, i % 20); break;
+		}
+		
+		*p++ = i + 1 < LITERALS ? ',' : '>';
+	}
+	*p = '\0';
+	
+	return ret;
+}
+
+static void benchParse(const char* name, const char* expr) {
+	BENCH(name, 1, i, {
+		const char* p = expr;
+		Statement* stmt = Statement_parse(&p);
+		g_benchSink = (long long)(size_t)stmt;
+		Statement_free(stmt);
+	});
+}
+
+int main(void) {
+	Input_current()->file = fopen("/dev/null", "r");
+	char* expr = genLiterals();
+	
+	benchParse("parse 1M literals", expr);
+	
+	Input_current()->exactDecimals = true;
+	benchParse("parse 1M literals (exact decimals)", expr);
+	Input_current()->exactDecimals = false;
+	
+	destroy(expr);
+	fclose(Input_current()->file);
+	Input_current()->file = NULL;
+	return 0;
+}
@@ -0,0 +1,89 @@
+/*
+  bench_parse.c
+  sc_bench
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "generic.h"
+#include "value.h"
+#include "statement.h"
+#include "symbol.h"
+
+#define ITERS 20000ull
+#define TERMS 100000
+
+volatile long long g_benchSink;
+
+/* Identifier-heavy statements in the style of an imported .scs library */
+static const char* _stmts[] = {
+	"area(width, height) = width * height",
+	"volume(width, height, depth) = area(width, height) * depth",
+	"hypot(side_a, side_b) = sqrt(side_a^2 + side_b^2)",
+	"lerp(start, stop, amount) = start + (stop - start) * amount",
+	"circumference = 2 * pi * radius",
+	"total = subtotal + subtotal * tax_rate - discount"
+};
+
+
+/* Builds a generated expression with TERMS terms, each formatted by `term` */
+static char* genExpr(const char* term, const char* sep) {
+	size_t termLen = strlen(term) + strlen(sep) + 8;
+	char* ret = fmalloc(TERMS * termLen + 1);
+	char* p = ret;
+	
+	for(int i = 0; i < TERMS; i++) {
+		p += sprintf(p, term, i % 97 + 1);
+		if(i + 1 < TERMS) {
+			p += sprintf(p, "%s", sep);
+		}
+	}
+	
+	return ret;
+}
+
+static void benchLong(const char* name, const char* term, const char* sep) {
+	char* expr = genExpr(term, sep);
+	
+	BENCH(name, 1, i, {
+		const char* p = expr;
+		Statement* stmt = Statement_parse(&p);
+		g_benchSink = (long long)(size_t)stmt;
+		Statement_free(stmt);
+	});
+	
+	destroy(expr);
+}
+
+int main(void) {
+	Input_current()->file = fopen("/dev/null", "r");
+	
+	/* Intern names like an interpreter does */
+	SymbolTable* symbols = SymbolTable_new();
+	Input_current()->symbols = symbols;
+	
+	BENCH("parse identifier-heavy stmts", ITERS, i, {
+		for(unsigned s = 0; s < ARRSIZE(_stmts); s++) {
+			const char* p = _stmts[s];
+			Statement* stmt = Statement_parse(&p);
+			g_benchSink = (long long)(size_t)stmt;
+			Statement_free(stmt);
+		}
+	});
+	
+	benchLong("parse 100k-term polynomial", "%d*x^2", " + ");
+	benchLong("parse 100k-term power tower", "x%d", "^");
+	
+	Input_current()->symbols = NULL;
+	SymbolTable_free(symbols);
+	
+	fclose(Input_current()->file);
+	Input_current()->file = NULL;
+	return 0;
+}
@@ -0,0 +1,85 @@
+/*
+  bench_prepared.c
+  sc_bench
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "generic.h"
+#include "value.h"
+#include "supercalc.h"
+#include "prepared.h"
+
+#define ITERS 200000ull
+#define CSV_ROWS 200000u
+
+volatile long long g_benchSink;
+
+
+static char* writeCsv(void) {
+	char path[] = "/tmp/sc_bench_XXXXXX";
+	FILE* fp = fdopen(mkstemp(path), "w");
+	fprintf(fp, "x,y\n");
+	for(unsigned i = 0; i < CSV_ROWS; i++) {
+		fprintf(fp, "%u,%u.5\n", i % 1000, i % 77);
+	}
+	fclose(fp);
+	return strdup(path);
+}
+
+int main(void) {
+	Input_current()->file = fopen("/dev/null", "r");
+	SuperCalc* sc = SuperCalc_new();
+	const char* expr = "3x^2 + y";
+	char line[128];
+	
+	/* Without a prepared expression, every row assigns the parameters and evaluates the text */
+	BENCH("assign + run line", ITERS, i, {
+		snprintf(line, sizeof(line), "x = %llu", (unsigned long long)(i % 1000));
+		Value_free(SuperCalc_runLine(sc, line, V_NONE));
+		snprintf(line, sizeof(line), "y = %llu.5", (unsigned long long)(i % 77));
+		Value_free(SuperCalc_runLine(sc, line, V_NONE));
+		strcpy(line, expr);
+		Value* val = SuperCalc_runLine(sc, line, V_NONE);
+		g_benchSink = val->type;
+		Value_free(val);
+	});
+	
+	char noVars[] = "~~~";
+	Value_free(SuperCalc_runLine(sc, noVars, V_NONE));
+	
+	Error* err;
+	Prepared* prep = SuperCalc_prepare(sc, expr, &err);
+	BENCH("bind + eval prepared", ITERS, i, {
+		Prepared_bind(prep, 0, ValInt((long long)(i % 1000)));
+		Prepared_bind(prep, 1, ValReal((double)(i % 77) + 0.5));
+		Value* val = Prepared_eval(prep);
+		g_benchSink = val->type;
+		Value_free(val);
+	});
+	Prepared_free(prep);
+	
+	/* End to end, including reading and parsing the fields */
+	char* csvPath = writeCsv();
+	FILE* devnull = fopen("/dev/null", "w");
+	BENCH("--prepare over 200k csv rows", 3, i, {
+		FILE* fp = fopen(csvPath, "r");
+		g_benchSink = SuperCalc_runCsv(sc, expr, fileno(fp), devnull);
+		fclose(fp);
+	});
+	fclose(devnull);
+	unlink(csvPath);
+	destroy(csvPath);
+	
+	SuperCalc_free(sc);
+	fclose(Input_current()->file);
+	Input_current()->file = NULL;
+	return 0;
+}
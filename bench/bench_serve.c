@@ -0,0 +1,223 @@
+/*
+  bench_serve.c
+  sc_bench
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+/*
+ Load generator for `sc --serve`. With no arguments, it starts a server in
+ this process on a temporary socket, with a library of LIB_LINES definitions.
+ Given a socket path, it connects to a server that's already running instead
+ (which should have imported an equivalent library).
+
+ Usage: bench_serve [SOCKET [CLIENTS [REQUESTS [WINDOW]]]]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "bench.h"
+#include "generic.h"
+#include "supercalc.h"
+#include "server.h"
+
+#define LIB_LINES 500
+
+volatile long long g_benchSink;
+
+struct Client {
+	const char* path;
+	unsigned index;
+	unsigned requests;
+	unsigned window;
+	
+	/* Seconds from sending each request until its response arrived */
+	double* latencies;
+	bool failed;
+};
+
+
+static void writeLibrary(const char* path) {
+	FILE* fp = fopen(path, "w");
+	fprintf(fp, "poly(x) = 3 * x ^ 2 + 2 * x + 1\n");
+	fprintf(fp, "mean(a, b) = (a + b) / 2\n");
+	for(int i = 0; i < LIB_LINES; i++) {
+		fprintf(fp, "c%d = %d / 7 + poly(%d)\n", i, i, i % 10);
+	}
+	fclose(fp);
+}
+
+static int connectTo(const char* path) {
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+	
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(fd < 0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+		perror("connect");
+		exit(1);
+	}
+	
+	return fd;
+}
+
+static void* runClient(void* data) {
+	struct Client* client = data;
+	int fd = connectTo(client->path);
+	FILE* in = fdopen(dup(fd), "r");
+	double* sent = fcalloc(client->requests, sizeof(*sent));
+	
+	/* Keep up to `window` requests in flight at once */
+	unsigned next = 0;
+	unsigned done = 0;
+	char line[256];
+	while(done < client->requests) {
+		while(next < client->requests && next - done < client->window) {
+			int len = snprintf(line, sizeof(line),
+				"{\"id\": %u, \"expr\": \"poly(%u) + mean(c%u, ans)\"}\n",
+				next, next % 100, (next * 7 + client->index) % LIB_LINES);
+			sent[next++] = bench_now();
+			if(write(fd, line, (size_t)len) != len) {
+				client->failed = true;
+				goto out;
+			}
+		}
+		
+		if(fgets(line, sizeof(line), in) == NULL || strstr(line, "\"error\":null") == NULL) {
+			client->failed = true;
+			goto out;
+		}
+		
+		/* Responses come back in order */
+		client->latencies[done] = bench_now() - sent[done];
+		done++;
+	}
+
+out:
+	destroy(sent);
+	fclose(in);
+	close(fd);
+	return NULL;
+}
+
+static int compareDoubles(const void* a, const void* b) {
+	double x = *(const double*)a;
+	double y = *(const double*)b;
+	return (x > y) - (x < y);
+}
+
+static void runLoad(const char* path, unsigned clients, unsigned requests, unsigned window) {
+	struct Client* all = fcalloc(clients, sizeof(*all));
+	pthread_t* threads = fcalloc(clients, sizeof(*threads));
+	size_t total = (size_t)clients * requests;
+	double* latencies = fcalloc(total, sizeof(*latencies));
+	
+	double start = bench_now();
+	for(unsigned i = 0; i < clients; i++) {
+		all[i].path = path;
+		all[i].index = i;
+		all[i].requests = requests;
+		all[i].window = window;
+		all[i].latencies = latencies + (size_t)i * requests;
+		pthread_create(&threads[i], NULL, &runClient, &all[i]);
+	}
+	
+	for(unsigned i = 0; i < clients; i++) {
+		pthread_join(threads[i], NULL);
+		if(all[i].failed) {
+			fprintf(stderr, "Client %u got an unexpected response\n", i);
+			exit(1);
+		}
+	}
+	double seconds = bench_now() - start;
+	
+	char name[64];
+	snprintf(name, sizeof(name), "%u clients, window %u", clients, window);
+	bench_report(name, total, seconds);
+	
+	qsort(latencies, total, sizeof(*latencies), &compareDoubles);
+	printf("%-32s %12.0f requests/sec, latency p50 %.1f us, p99 %.1f us\n", "",
+		(double)total / seconds, latencies[total / 2] * 1e6, latencies[total * 99 / 100] * 1e6);
+	
+	destroy(latencies);
+	destroy(threads);
+	destroy(all);
+}
+
+static void* runServer(void* data) {
+	Server_run(data);
+	return NULL;
+}
+
+int main(int argc, char** argv) {
+	const char* path = argc > 1 ? argv[1] : NULL;
+	unsigned clients = argc > 2 ? (unsigned)atoi(argv[2]) : 0;
+	unsigned requests = argc > 3 ? (unsigned)atoi(argv[3]) : 20000;
+	unsigned window = argc > 4 ? (unsigned)atoi(argv[4]) : 0;
+	
+	char libPath[] = "/tmp/sc_bench_XXXXXX";
+	close(mkstemp(libPath));
+	writeLibrary(libPath);
+	
+	/* What every request costs without a server: a fresh session replaying the library */
+	BENCH("new session + import + eval", 50, i, {
+		SuperCalc* sc = SuperCalc_new();
+		Error* err = SuperCalc_importFile(sc, libPath);
+		char expr[] = "poly(3) + mean(c1, 2)";
+		Value* val = SuperCalc_runLine(sc, expr, V_NONE);
+		g_benchSink += err == NULL && val != NULL;
+		Value_free(val);
+		SuperCalc_free(sc);
+	});
+	
+	SuperCalc* lib = NULL;
+	Server* server = NULL;
+	pthread_t serverThread;
+	char sockPath[64];
+	if(path == NULL) {
+		lib = SuperCalc_new();
+		Error* err = SuperCalc_importFile(lib, libPath);
+		if(err != NULL) {
+			Error_raise(err, true);
+		}
+		
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		snprintf(sockPath, sizeof(sockPath), "%s.sock", libPath);
+		server = Server_new(lib, sockPath, cpus > 0 ? (unsigned)cpus : 1, &err);
+		if(server == NULL) {
+			Error_raise(CAST_NONNULL(err), true);
+		}
+		
+		pthread_create(&serverThread, NULL, &runServer, server);
+		path = sockPath;
+	}
+	
+	if(clients != 0) {
+		runLoad(path, clients, requests, window ? window : 1);
+	}
+	else {
+		/* One request at a time shows the round trip, pipelining and more clients show throughput */
+		runLoad(path, 1, requests, 1);
+		runLoad(path, 1, requests, 32);
+		runLoad(path, 8, requests / 8, 1);
+		runLoad(path, 64, requests / 64, 16);
+	}
+	
+	if(server != NULL) {
+		Server_stop(server);
+		pthread_join(serverThread, NULL);
+		Server_free(server);
+		SuperCalc_free(lib);
+	}
+	
+	unlink(libPath);
+	return 0;
+}
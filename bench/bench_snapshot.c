@@ -0,0 +1,76 @@
+/*
+  bench_snapshot.c
+  sc_bench
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "generic.h"
+#include "supercalc.h"
+
+#define ITERS 20ull
+#define DEFS 2000
+
+volatile long long g_benchSink;
+
+
+/* Same library as bench_import, so the numbers can be compared */
+static void genLibrary(FILE* fp) {
+	for(int i = 0; i < DEFS; i++) {
+		fprintf(fp, "f%d(a, b) = b_and(a * %d + b ^ 2, <a, b, %d.5>) - (a + b) / %d\n", i, i, i, i + 1);
+		fprintf(fp, "c%d = %d/7\n", i, i + 1);
+	}
+}
+
+int main(void) {
+	Input_current()->file = fopen("/dev/null", "r");
+	
+	char path[] = "/tmp/sc_bench_XXXXXX";
+	int fd = mkstemp(path);
+	FILE* fp = fdopen(fd, "w");
+	genLibrary(fp);
+	fclose(fp);
+	
+	char snapPath[] = "/tmp/sc_bench_XXXXXX";
+	close(mkstemp(snapPath));
+	
+	SuperCalc* sc = SuperCalc_new();
+	Error* err = SuperCalc_importFile(sc, path);
+	if(err == NULL) {
+		err = SuperCalc_saveSnapshot(sc, snapPath);
+	}
+	if(err != NULL) {
+		Error_raise(err, true);
+	}
+	SuperCalc_free(sc);
+	
+	BENCH("import 4k globals", ITERS, i, {
+		sc = SuperCalc_new();
+		err = SuperCalc_importFile(sc, path);
+		g_benchSink = (long long)(size_t)err;
+		Error_free(err);
+		SuperCalc_free(sc);
+	});
+	
+	BENCH("load 4k globals", ITERS, i, {
+		sc = SuperCalc_new();
+		err = SuperCalc_loadSnapshot(sc, snapPath);
+		g_benchSink = (long long)(size_t)err;
+		Error_free(err);
+		SuperCalc_free(sc);
+	});
+	
+	unlink(snapPath);
+	unlink(path);
+	
+	fclose(Input_current()->file);
+	Input_current()->file = NULL;
+	return 0;
+}
@@ -0,0 +1,53 @@
+/*
+  bench_startup.c
+  sc_bench
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "generic.h"
+#include "value.h"
+#include "supercalc.h"
+
+#define ITERS 200000ull
+
+volatile long long g_benchSink;
+
+
+int main(void) {
+	Input_current()->file = fopen("/dev/null", "r");
+	
+	BENCH("create and free interpreter", ITERS, i, {
+		SuperCalc* sc = SuperCalc_new();
+		g_benchSink = (long long)(size_t)sc;
+		SuperCalc_free(sc);
+	});
+	
+	SuperCalc* sc = SuperCalc_new();
+	char line[8];
+	
+	BENCH("reset with ~~~", ITERS, i, {
+		strcpy(line, "~~~");
+		Value* val = SuperCalc_runLine(sc, line, V_NONE);
+		g_benchSink = (long long)(size_t)val;
+	});
+	
+	/* Builtins are now found after missing the globals */
+	BENCH("call a builtin", ITERS, i, {
+		strcpy(line, "cos(0)");
+		Value* val = SuperCalc_runLine(sc, line, V_NONE);
+		g_benchSink = val->ival;
+		Value_free(val);
+	});
+	
+	SuperCalc_free(sc);
+	fclose(Input_current()->file);
+	Input_current()->file = NULL;
+	return 0;
+}
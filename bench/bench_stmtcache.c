@@ -0,0 +1,49 @@
+/*
+  bench_stmtcache.c
+  sc_bench
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "generic.h"
+#include "value.h"
+#include "supercalc.h"
+
+#define ITERS 200000ull
+
+volatile long long g_benchSink;
+
+/* The kind of lines a batch input repeats over and over */
+static const char* _lines[] = {
+	"principal = 250000",
+	"rate = 0.0425 / 12",
+	"payment = principal * rate / (1 - (1 + rate) ^ -360)",
+	"total = payment * 360 - principal  # interest paid",
+	"ans * 2 + sqrt(total) / 3"
+};
+
+
+int main(void) {
+	Input_current()->file = fopen("/dev/null", "r");
+	SuperCalc* sc = SuperCalc_new();
+	char line[128];
+	
+	BENCH("run repeated lines", ITERS, i, {
+		const char* src = _lines[i % ARRSIZE(_lines)];
+		strcpy(line, src);
+		Value* val = SuperCalc_runLine(sc, line, V_NONE);
+		g_benchSink = (long long)(size_t)val;
+		Value_free(val);
+	});
+	
+	SuperCalc_free(sc);
+	fclose(Input_current()->file);
+	Input_current()->file = NULL;
+	return 0;
+}
@@ -0,0 +1,52 @@
+/*
+  bench_subscript.c
+  sc_bench
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "generic.h"
+#include "value.h"
+#include "context.h"
+
+#define ITERS 1000000ull
+
+volatile long long g_benchSink;
+
+
+static Value* parse(const char* expr) {
+	return Value_parseTop(&expr);
+}
+
+static void bench_expr(const Context* ctx, const char* expr) {
+	Value* tree = parse(expr);
+	
+	BENCH(expr, ITERS, i, {
+		Value* ret = Value_eval(tree, ctx);
+		g_benchSink = ret->type;
+		Value_free(ret);
+	});
+	
+	Value_free(tree);
+}
+
+int main(void) {
+	Context* ctx = Context_new();
+	
+	/* Indexing a variable used to evaluate a copy of the whole vector first */
+	Value* vec = parse("<1, 2, 3, 4, 5, 6, 7, 8, <9, 10, <11, 12>>, 1/3, 2/3, 0.5>");
+	Context_setGlobal(ctx, "v", Value_eval(vec, ctx));
+	Value_free(vec);
+	
+	bench_expr(ctx, "v[3]");
+	bench_expr(ctx, "v[8][2][1]");
+	bench_expr(ctx, "<1, 2, 3>[1]");
+	
+	Context_free(ctx);
+	return 0;
+}
@@ -0,0 +1,53 @@
+/*
+  bench_template.c
+  sc_bench
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+/*
+ Builtins that are written as templates (see template.h), evaluated from
+ already parsed expressions so only the builtin's own work is measured.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "generic.h"
+#include "value.h"
+#include "context.h"
+
+#define ITERS 500000ull
+
+volatile long long g_benchSink;
+
+
+static void bench_expr(const Context* ctx, const char* expr) {
+	const char* cur = expr;
+	Value* tree = Value_parseTop(&cur);
+	
+	BENCH(expr, ITERS, i, {
+		Value* ret = Value_eval(tree, ctx);
+		g_benchSink = ret->type;
+		Value_free(ret);
+	});
+	
+	Value_free(tree);
+}
+
+int main(void) {
+	Context* ctx = Context_new();
+	
+	bench_expr(ctx, "sqrt(2)");
+	bench_expr(ctx, "exp(3)");
+	bench_expr(ctx, "dot(<1,2,3>, <4,5,6>)");
+	bench_expr(ctx, "cross(<1,2,3>, <4,5,6>)");
+	bench_expr(ctx, "mag(<3,4>)");
+	bench_expr(ctx, "norm(<3,4>)");
+	bench_expr(ctx, "map(sqrt, <1,4,9,16>)");
+	
+	Context_free(ctx);
+	return 0;
+}
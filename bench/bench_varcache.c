@@ -0,0 +1,64 @@
+/*
+  bench_varcache.c
+  sc_bench
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "generic.h"
+#include "value.h"
+#include "context.h"
+#include "statement.h"
+
+#define ITERS 1000000ull
+#define GLOBALS 64
+
+volatile long long g_benchSink;
+
+
+static void run(Context* ctx, const char* line) {
+	Statement* stmt = Statement_parse(&line);
+	Value_free(Statement_eval(stmt, ctx, V_NONE));
+	Statement_free(stmt);
+}
+
+static void bench_expr(const Context* ctx, const char* expr) {
+	const char* p = expr;
+	Value* tree = Value_parseTop(&p);
+	
+	BENCH(expr, ITERS, i, {
+		Value* ret = Value_eval(tree, ctx);
+		g_benchSink = ret->type;
+		Value_free(ret);
+	});
+	
+	Value_free(tree);
+}
+
+int main(void) {
+	Context* ctx = Context_new();
+	
+	/* Lookups walk every global defined after the one being found, then the builtins */
+	run(ctx, "a = 3");
+	run(ctx, "f(x) = x * a + 1");
+	
+	unsigned i;
+	for(i = 0; i < GLOBALS; i++) {
+		char line[32];
+		snprintf(line, sizeof(line), "g%u = %u", i, i);
+		run(ctx, line);
+	}
+	
+	bench_expr(ctx, "a");
+	bench_expr(ctx, "sqrt(a)");
+	bench_expr(ctx, "f(2)");
+	bench_expr(ctx, "f(f(f(2)))");
+	
+	Context_free(ctx);
+	return 0;
+}
@@ -13,11 +13,13 @@
 #include <string.h>
 #include <math.h>
 #include <ctype.h>
+#include <limits.h>
 
 #include "support.h"
 #include "error.h"
 #include "fraction.h"
 #include "vector.h"
+#include "ddreal.h"
 
 typedef Value* (*binop_t)(const Context*, const Value*, const Value*);
 
@@ -28,6 +30,7 @@ static Value* binop_mul(const Context* ctx, const Value* a, const Value* b);
 static Value* binop_div(const Context* ctx, const Value* a, const Value* b);
 static Value* binop_mod(const Context* ctx, const Value* a, const Value* b);
 static Value* binop_pow(const Context* ctx, const Value* a, const Value* b);
+static Value* binop_xreal(BINTYPE type, const Value* a, const Value* b);
 static BINTYPE nextSpecialOp(const char** expr);
 
 static binop_t _binop_table[BIN_COUNT] = {
@@ -71,12 +74,17 @@ static Value* val_ipow(long long base, long long exp) {
 	
 	if(exp < 0) {
 		/* base^-exp is same as 1/base^exp */
-		result = ipow(base, -exp);
+		if(UNLIKELY(exp == LLONG_MIN || ipow_overflow(base, -exp, &result))) {
+			/* Too small for a fraction, but the magnitude itself didn't overflow */
+			return ValReal(pow((double)base, (double)exp));
+		}
 		
 		return ValFrac(Fraction_new(1, result));
 	}
 	
-	result = ipow(base, exp);
+	if(UNLIKELY(ipow_overflow(base, exp, &result))) {
+		return ValOverflow(pow((double)base, (double)exp));
+	}
 	
 	return ValInt(result);
 }
@@ -100,7 +108,13 @@ static Value* binop_add(const Context* ctx, const Value* a, const Value* b) {
 		ret = Fraction_add(b->frac, a);
 	}
 	else if(a->type == VAL_INT && b->type == VAL_INT) {
-		ret = ValInt(a->ival + b->ival);
+		long long sum;
+		if(UNLIKELY(add_overflow(a->ival, b->ival, &sum))) {
+			ret = ValOverflow((double)a->ival + (double)b->ival);
+		}
+		else {
+			ret = ValInt(sum);
+		}
 	}
 	else {
 		double a1, a2;
@@ -152,7 +166,13 @@ static Value* binop_sub(const Context* ctx, const Value* a, const Value* b) {
 		Fraction_free(f);
 	}
 	else if(a->type == VAL_INT && b->type == VAL_INT) {
-		ret = ValInt(a->ival - b->ival);
+		long long diff;
+		if(UNLIKELY(sub_overflow(a->ival, b->ival, &diff))) {
+			ret = ValOverflow((double)a->ival - (double)b->ival);
+		}
+		else {
+			ret = ValInt(diff);
+		}
 	}
 	else {
 		double s1, s2;
@@ -200,7 +220,13 @@ static Value* binop_mul(const Context* ctx, const Value* a, const Value* b) {
 		ret = Fraction_mul(b->frac, a);
 	}
 	else if(a->type == VAL_INT && b->type == VAL_INT) {
-		ret = ValInt(a->ival * b->ival);
+		long long prod;
+		if(UNLIKELY(mul_overflow(a->ival, b->ival, &prod))) {
+			ret = ValOverflow((double)a->ival * (double)b->ival);
+		}
+		else {
+			ret = ValInt(prod);
+		}
 	}
 	else {
 		double m1, m2;
@@ -255,9 +281,16 @@ static Value* binop_div(const Context* ctx, const Value* a, const Value* b) {
 		if(b->ival == 0) {
 			ret = ValErr(zeroDivError());
 		}
+		else if(UNLIKELY(b->ival == -1 && a->ival == LLONG_MIN)) {
+			/* The only quotient of two integers that doesn't fit */
+			ret = ValOverflow(-(double)LLONG_MIN);
+		}
 		else if(a->ival % b->ival == 0) {
 			ret = ValInt(a->ival / b->ival);
 		}
+		else if(Context_getMode(ctx) == MODE_FLOAT) {
+			ret = ValReal((double)a->ival / (double)b->ival);
+		}
 		else {
 			ret = ValFrac(Fraction_new(a->ival, b->ival));
 		}
@@ -308,6 +341,10 @@ static Value* binop_mod(const Context* ctx, const Value* a, const Value* b) {
 		if(b->ival == 0) {
 			ret = ValErr(zeroModError());
 		}
+		else if(b->ival == -1) {
+			/* Avoid trapping on LLONG_MIN % -1 */
+			ret = ValInt(0);
+		}
 		else {
 			ret = ValInt(a->ival % b->ival);
 		}
@@ -364,7 +401,8 @@ static Value* binop_pow(const Context* ctx, const Value* a, const Value* b) {
 		/* Shortcut execution of x^0 to not evaluate x */
 		ret = ValInt(1);
 	}
-	else if(a->type == VAL_INT && b->type == VAL_INT) {
+	else if(a->type == VAL_INT && b->type == VAL_INT
+	&& !(b->ival < 0 && Context_getMode(ctx) == MODE_FLOAT)) {
 		ret = val_ipow(a->ival, b->ival);
 	}
 	else if(a->type == VAL_VEC) {
@@ -443,6 +481,62 @@ BinOp* BinOp_copy(const BinOp* node) {
 	return BinOp_new(node->type, Value_copy(node->a), bCopy);
 }
 
+/* Double-double arithmetic, used when either operand is an XREAL or in extended mode */
+static Value* binop_xreal(BINTYPE type, const Value* a, const Value* b) {
+	DDReal x, y, ret;
+	
+	if(!DDReal_fromValue(a, &x)) {
+		return ValErr(badOpType("left", a->type));
+	}
+	
+	if(!DDReal_fromValue(b, &y)) {
+		return ValErr(badOpType("right", b->type));
+	}
+	
+	switch(type) {
+		case BIN_ADD:
+			ret = DDReal_add(x, y);
+			break;
+		
+		case BIN_SUB:
+			ret = DDReal_sub(x, y);
+			break;
+		
+		case BIN_MUL:
+			ret = DDReal_mul(x, y);
+			break;
+		
+		case BIN_DIV:
+			if(DDReal_isZero(y)) {
+				return ValErr(zeroDivError());
+			}
+			
+			ret = DDReal_div(x, y);
+			break;
+		
+		case BIN_MOD:
+			if(DDReal_isZero(y)) {
+				return ValErr(zeroModError());
+			}
+			
+			ret = DDReal_mod(x, y);
+			break;
+		
+		case BIN_POW:
+			if(x.hi < 0.0 && !(y.lo == 0.0 && y.hi == floor(y.hi))) {
+				return ValErr(mathError("Power result is complex"));
+			}
+			
+			ret = DDReal_pow(x, y);
+			break;
+		
+		default:
+			DIE("Invalid binop type: %d", type);
+	}
+	
+	return ValXReal(ret);
+}
+
 Value* BinOp_eval(const BinOp* node, const Context* ctx) {
 	assert(node->b != NULL);
 	
@@ -457,7 +551,34 @@ Value* BinOp_eval(const BinOp* node, const Context* ctx) {
 		return b;
 	}
 	
-	Value* ret = _binop_table[node->type](ctx, a, b);
+	Value* ret;
+	bool numbers = Value_isNumber(a) && Value_isNumber(b);
+	bool extended = numbers && Context_getMode(ctx) == MODE_EXTENDED;
+	if(UNLIKELY(a->type == VAL_XREAL || b->type == VAL_XREAL) && numbers) {
+		ret = binop_xreal(node->type, a, b);
+	}
+	else if(UNLIKELY(extended) && (a->type == VAL_REAL || b->type == VAL_REAL)) {
+		/* The result would be a double, so skip straight to the extended precision one */
+		ret = binop_xreal(node->type, a, b);
+	}
+	else {
+		ret = _binop_table[node->type](ctx, a, b);
+		
+		/* In extended mode, redo anything that had to fall back to a double, like an overflowing integer */
+		if(UNLIKELY(extended) && ret->type == VAL_REAL) {
+			VALFLAGS flags = ret->flags;
+			Value_free(ret);
+			ret = binop_xreal(node->type, a, b);
+			if(ret->type == VAL_XREAL) {
+				ret->flags |= flags;
+			}
+		}
+	}
+	
+	/* Results computed from an overflowed operand are just as approximate */
+	if((ret->type == VAL_REAL || ret->type == VAL_XREAL) && ((a->flags | b->flags) & VF_OVERFLOW)) {
+		ret->flags |= VF_OVERFLOW;
+	}
 	
 	Value_free(a);
 	Value_free(b);
@@ -22,34 +22,6 @@
 #include "variable.h"
 
 
-Builtin* Builtin_new(char* name, builtin_eval_t evaluator, bool isFunction) {
-	Builtin* ret = fmalloc(sizeof(*ret));
-	
-	ret->name = name;
-	ret->evaluator = evaluator;
-	ret->isFunction = isFunction;
-	
-	return ret;
-}
-
-void Builtin_free(Builtin* blt) {
-	if(!blt) {
-		return;
-	}
-	
-	destroy(blt->name);
-	destroy(blt);
-}
-
-Builtin* Builtin_copy(const Builtin* blt) {
-	return Builtin_new(strdup(blt->name), blt->evaluator, blt->isFunction);
-}
-
-void Builtin_register(Builtin* blt, Context* ctx) {
-	Variable* var = Variable_new(strdup(blt->name), ValBuiltin(blt));
-	Context_addGlobal(ctx, var);
-}
-
 Value* Builtin_eval(const Builtin* blt, const Context* ctx, const ArgList* arglist, bool internal) {
 	/* Call the builtin's evaluator function */
 	Value* ret = blt->evaluator(ctx, arglist, internal);
@@ -14,6 +14,7 @@
 typedef struct Builtin Builtin;
 #include "context.h"
 #include "arglist.h"
+#include "variable.h"
 #include "value.h"
 #include "generic.h"
 
@@ -22,23 +23,19 @@ ASSUME_NONNULL_BEGIN
 
 typedef Value* _Nonnull (*builtin_eval_t)(const Context* _Nonnull, const ArgList* _Nonnull, bool);
 
+/*
+ Builtins are static and immutable, so values refer to them without owning
+ or copying them. They aren't stored in the Context either: a lookup that
+ finds no variable falls back to Builtin_lookup.
+*/
 struct Builtin {
-	OWNED char* name;
+	const char* name;
 	builtin_eval_t evaluator;
 	bool isFunction;
 };
 
-/* Constructor */
-RETURNS_OWNED Builtin* Builtin_new(CONSUMED char* name, builtin_eval_t evaluator, bool isFunction);
-
-/* Destructor */
-void Builtin_free(CONSUMED Builtin* _Nullable blt);
-
-/* Copying */
-RETURNS_OWNED Builtin* Builtin_copy(const Builtin* blt);
-
-/* Registration */
-void Builtin_register(IN Builtin* blt, IN Context* ctx);
+/* Lookup, which returns a static variable that must not be modified or freed */
+RETURNS_UNOWNED Variable* _Nullable Builtin_lookup(const char* name);
 
 /* Evaluation */
 RETURNS_OWNED Value* Builtin_eval(
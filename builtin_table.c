@@ -0,0 +1,149 @@
+/*
+  builtin_table.c
+  SuperCalc
+
+  Generated by tools/gen_builtin_table.py. Do not edit, run it again instead.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include "builtin.h"
+#include <string.h>
+#include <stdint.h>
+
+#include "defaults.h"
+#include "value.h"
+#include "variable.h"
+
+
+#define BUILTIN_COUNT 44
+#define BUILTIN_SLOT_BITS 7
+#define BUILTIN_SEED 0xf03u
+
+/* Values and variables handed out by Builtin_lookup */
+static Value _builtinValues[BUILTIN_COUNT] = {
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[0]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[1]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[2]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[3]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[4]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[5]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[6]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[7]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[8]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[9]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[10]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[11]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[12]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[13]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[14]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[15]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[16]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[17]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[18]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[19]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[20]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[21]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[22]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[23]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[24]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[25]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[26]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[27]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[28]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[29]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[30]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[31]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[32]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[33]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[34]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[35]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[36]},
+	{.type = VAL_BUILTIN, .blt = &g_mathBuiltins[37]},
+	{.type = VAL_BUILTIN, .blt = &g_vectorBuiltins[0]},
+	{.type = VAL_BUILTIN, .blt = &g_vectorBuiltins[1]},
+	{.type = VAL_BUILTIN, .blt = &g_vectorBuiltins[2]},
+	{.type = VAL_BUILTIN, .blt = &g_vectorBuiltins[3]},
+	{.type = VAL_BUILTIN, .blt = &g_vectorBuiltins[4]},
+	{.type = VAL_BUILTIN, .blt = &g_vectorBuiltins[5]}
+};
+
+static Variable _builtinVars[BUILTIN_COUNT] = {
+	{(char*)"pi", &_builtinValues[0]},
+	{(char*)"e", &_builtinValues[1]},
+	{(char*)"phi", &_builtinValues[2]},
+	{(char*)"sqrt", &_builtinValues[3]},
+	{(char*)"abs", &_builtinValues[4]},
+	{(char*)"exp", &_builtinValues[5]},
+	{(char*)"sin", &_builtinValues[6]},
+	{(char*)"cos", &_builtinValues[7]},
+	{(char*)"tan", &_builtinValues[8]},
+	{(char*)"sec", &_builtinValues[9]},
+	{(char*)"csc", &_builtinValues[10]},
+	{(char*)"cot", &_builtinValues[11]},
+	{(char*)"asin", &_builtinValues[12]},
+	{(char*)"acos", &_builtinValues[13]},
+	{(char*)"atan", &_builtinValues[14]},
+	{(char*)"asec", &_builtinValues[15]},
+	{(char*)"acsc", &_builtinValues[16]},
+	{(char*)"acot", &_builtinValues[17]},
+	{(char*)"sinh", &_builtinValues[18]},
+	{(char*)"cosh", &_builtinValues[19]},
+	{(char*)"tanh", &_builtinValues[20]},
+	{(char*)"sech", &_builtinValues[21]},
+	{(char*)"csch", &_builtinValues[22]},
+	{(char*)"coth", &_builtinValues[23]},
+	{(char*)"asinh", &_builtinValues[24]},
+	{(char*)"acosh", &_builtinValues[25]},
+	{(char*)"atanh", &_builtinValues[26]},
+	{(char*)"asech", &_builtinValues[27]},
+	{(char*)"acsch", &_builtinValues[28]},
+	{(char*)"acoth", &_builtinValues[29]},
+	{(char*)"log", &_builtinValues[30]},
+	{(char*)"log2", &_builtinValues[31]},
+	{(char*)"ln", &_builtinValues[32]},
+	{(char*)"logbase", &_builtinValues[33]},
+	{(char*)"atan2", &_builtinValues[34]},
+	{(char*)"powmod", &_builtinValues[35]},
+	{(char*)"mulmod", &_builtinValues[36]},
+	{(char*)"invmod", &_builtinValues[37]},
+	{(char*)"dot", &_builtinValues[38]},
+	{(char*)"cross", &_builtinValues[39]},
+	{(char*)"map", &_builtinValues[40]},
+	{(char*)"elem", &_builtinValues[41]},
+	{(char*)"mag", &_builtinValues[42]},
+	{(char*)"norm", &_builtinValues[43]}
+};
+
+/* One more than the index of the builtin in each hash slot, or zero if it's empty */
+static const uint8_t _builtinSlots[1 << BUILTIN_SLOT_BITS] = {
+	 0,  0,  0,  0, 44,  0,  0,  0,  0, 37,  0,  0,  0, 13,  0,  0,
+	 0,  0,  1, 41,  0,  0,  0,  0,  0,  0, 18, 14, 19,  0, 17, 43,
+	28,  9, 33,  0,  0,  0,  0,  0,  0, 34,  0,  0,  0, 24,  0,  0,
+	 0,  4,  0,  0,  0,  0, 32, 39,  0,  0, 20,  0,  0,  0,  0,  5,
+	 0,  0,  7,  0,  0,  0,  0, 35,  0, 10, 11, 30, 21,  0,  8, 12,
+	 0,  0,  0,  0,  0, 23,  0,  0,  0, 31,  0,  0,  0,  0, 26,  0,
+	 0, 36,  0,  6,  0,  0, 29, 40,  0, 22, 27, 15,  0,  0, 25,  0,
+	 0,  2,  0,  0,  0,  0,  0,  0, 42,  0, 16, 38,  0,  3,  0,  0
+};
+
+
+static unsigned builtinSlot(const char* name) {
+	uint32_t hash = 2166136261u ^ BUILTIN_SEED;
+	
+	for(; *name != '\0'; name++) {
+		hash ^= (unsigned char)*name;
+		hash *= 16777619u;
+	}
+	
+	return hash >> (32 - BUILTIN_SLOT_BITS);
+}
+
+Variable* Builtin_lookup(const char* name) {
+	unsigned index = _builtinSlots[builtinSlot(name)];
+	if(index == 0) {
+		return NULL;
+	}
+	
+	Variable* var = &_builtinVars[index - 1];
+	return strcmp(var->name, name) == 0 ? var : NULL;
+}
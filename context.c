@@ -13,6 +13,7 @@
 
 #include "generic.h"
 #include "variable.h"
+#include "builtin.h"
 
 
 struct VarNode {
@@ -28,8 +29,22 @@ struct ContextStack {
 struct Context {
 	struct VarNode* globals;
 	struct ContextStack* locals;
+	NUMMODE mode;
+	
+	/* In a fork, set whenever its private "ans" is read */
+	bool* _Nullable ansRead;
+	
+	/* Read-only globals searched after these ones */
+	const Context* _Nullable base;
+	
+	/* Changes whenever a global is added or deleted, shared with every frame and fork */
+	unsigned long long* version;
+	bool ownsVersion;
 };
 
+/* No two versions of any contexts are the same, so a VarCache can't mix them up */
+static unsigned long long _context_versions = 0;
+
 
 static void freeVars(struct VarNode* vars);
 static void freeStack(struct ContextStack* stack);
@@ -40,7 +55,25 @@ static struct VarNode* findPrev(struct VarNode* cur, const char* name);
 static bool isFirst(struct VarNode* cur, const char* name);
 static struct VarNode* findNode(struct VarNode* cur, const char* name);
 static Variable* findVar(struct VarNode* cur, const char* name);
+static Variable* findGlobal(const Context* ctx, const char* name);
+static unsigned long long nextVersion(void);
+static void newVersion(Context* ctx);
+static void bumpVersion(const Context* ctx);
+
 
+static unsigned long long nextVersion(void) {
+	return __atomic_add_fetch(&_context_versions, 1, __ATOMIC_RELAXED);
+}
+
+static void newVersion(Context* ctx) {
+	ctx->version = fmalloc(sizeof(*ctx->version));
+	*ctx->version = nextVersion();
+	ctx->ownsVersion = true;
+}
+
+static void bumpVersion(const Context* ctx) {
+	*ctx->version = nextVersion();
+}
 
 Context* Context_new(void) {
 	Context* ret = fmalloc(sizeof(*ret));
@@ -49,6 +82,7 @@ Context* Context_new(void) {
 	ret->globals->var = Variable_new(strdup("ans"), ValInt(0));
 	ret->globals->next = NULL;
 	ret->locals = NULL;
+	newVersion(ret);
 	
 	return ret;
 }
@@ -86,6 +120,9 @@ void Context_free(Context* ctx) {
 	
 	freeVars(ctx->globals);
 	freeStack(ctx->locals);
+	if(ctx->ownsVersion) {
+		destroy(ctx->version);
+	}
 	destroy(ctx);
 }
 
@@ -138,10 +175,13 @@ static struct ContextStack* copyStack(const struct ContextStack* stack) {
 }
 
 Context* Context_copy(const Context* ctx) {
-	Context* ret = Context_new();
+	Context* ret = fmalloc(sizeof(*ret));
 	
 	ret->globals = copyVars(ctx->globals);
 	ret->locals = copyStack(ctx->locals);
+	ret->mode = ctx->mode;
+	ret->base = ctx->base;
+	newVersion(ret);
 	
 	return ret;
 }
@@ -159,6 +199,7 @@ static void addVar(struct VarNode** vars, Variable* var) {
 void Context_addGlobal(const Context* ctx, Variable* var) {
 	/* Always keep "ans" first */
 	addVar(&ctx->globals->next, var);
+	bumpVersion(ctx);
 }
 
 void Context_addLocal(const Context* ctx, Variable* var) {
@@ -182,14 +223,84 @@ void Context_setGlobal(const Context* ctx, const char* name, Value* val) {
 	}
 }
 
-Context* Context_pushFrame(const Context* ctx) {
+void Context_forEachGlobal(const Context* ctx, context_visit_t visit, void* data) {
+	/* "ans" always comes first, then the rest are stored newest first */
+	visit(ctx->globals->var, data);
+	
+	size_t count = 0;
+	struct VarNode* cur;
+	for(cur = ctx->globals->next; cur != NULL; cur = cur->next) {
+		count++;
+	}
+	
+	if(count == 0) {
+		return;
+	}
+	
+	Variable** vars = fcalloc(count, sizeof(*vars));
+	size_t i = count;
+	for(cur = ctx->globals->next; cur != NULL; cur = cur->next) {
+		vars[--i] = cur->var;
+	}
+	
+	for(i = 0; i < count; i++) {
+		visit(vars[i], data);
+	}
+	
+	destroy(vars);
+}
+
+Context* Context_fork(const Context* ctx, bool* ansRead) {
+	Context* ret = fmalloc(sizeof(*ret));
+	
+	/* Only "ans" is private, the rest of the globals are shared */
+	ret->globals = fmalloc(sizeof(*ret->globals));
+	ret->globals->var = Variable_copy(ctx->globals->var);
+	ret->globals->next = ctx->globals->next;
+	ret->mode = ctx->mode;
+	ret->ansRead = ansRead;
+	ret->base = ctx->base;
+	
+	/* "ans" is never cached, so every cache means the same thing in a fork as in `ctx` */
+	ret->version = ctx->version;
+	
+	return ret;
+}
+
+void Context_freeFork(Context* fork) {
+	Variable_free(fork->globals->var);
+	destroy(fork->globals);
+	destroy(fork);
+}
+
+Context* Context_newShared(const Context* base) {
 	Context* ret = Context_new();
+	ret->mode = base->mode;
+	ret->base = base;
+	return ret;
+}
+
+NUMMODE Context_getMode(const Context* ctx) {
+	return ctx->mode;
+}
+
+void Context_setMode(Context* ctx, NUMMODE mode) {
+	ctx->mode = mode;
+}
+
+Context* Context_pushFrame(const Context* ctx) {
+	/* The globals are shared with `ctx`, so don't create another "ans" */
+	Context* ret = fmalloc(sizeof(*ret));
 	ret->globals = ctx->globals;
 	
 	struct ContextStack* frame = fcalloc(1, sizeof(*frame));
 	
 	frame->next = ctx->locals;
 	ret->locals = frame;
+	ret->mode = ctx->mode;
+	ret->ansRead = ctx->ansRead;
+	ret->base = ctx->base;
+	ret->version = ctx->version;
 	
 	return ret;
 }
@@ -218,13 +329,12 @@ static bool isFirst(struct VarNode* cur, const char* name) {
 	return cur && strcmp(cur->var->name, name) == 0;
 }
 
-void Context_del(const Context* ctx, const char* name) {
+Error* Context_del(const Context* ctx, const char* name) {
 	struct VarNode* cur;
 	struct VarNode* prev = NULL;
 	
 	if(strcmp(name, "ans") == 0) {
-		RAISE(nameError("Cannot delete special variable 'ans'."), false);
-		return;
+		return nameError("Cannot delete special variable 'ans'.");
 	}
 	
 	/* First node in locals linked list */
@@ -238,7 +348,8 @@ void Context_del(const Context* ctx, const char* name) {
 			Variable_free(cur->var);
 			destroy(cur);
 			
-			return;
+			bumpVersion(ctx);
+			return NULL;
 		}
 		
 		/* Search current locals stack frame first */
@@ -250,8 +361,15 @@ void Context_del(const Context* ctx, const char* name) {
 	
 	/* If prev is STILL NULL, it wasn't found */
 	if(prev == NULL) {
-		RAISE(varNotFound(name), false);
-		return;
+		if(Builtin_lookup(name) != NULL) {
+			return nameError("Cannot delete builtin '%s'.", name);
+		}
+		
+		if(ctx->base != NULL && findGlobal(ctx->base, name) != NULL) {
+			return nameError("Cannot delete shared variable '%s'.", name);
+		}
+		
+		return varNotFound(name);
 	}
 	
 	cur = prev->next;
@@ -262,6 +380,9 @@ void Context_del(const Context* ctx, const char* name) {
 	/* Free current node */
 	Variable_free(cur->var);
 	destroy(cur);
+	
+	bumpVersion(ctx);
+	return NULL;
 }
 
 void Context_clear(Context* ctx) {
@@ -275,6 +396,8 @@ void Context_clear(Context* ctx) {
 		cur = prev->next;
 	}
 	
+	bumpVersion(ctx);
+	
 	/* Set ans to 0 */
 	Context_setGlobal(ctx, "ans", ValInt(0));
 }
@@ -297,6 +420,21 @@ static Variable* findVar(struct VarNode* cur, const char* name) {
 	return node ? node->var : NULL;
 }
 
+static Variable* findGlobal(const Context* ctx, const char* name) {
+	Variable* ret = findVar(ctx->globals, name);
+	if(ret == ctx->globals->var && ctx->ansRead != NULL) {
+		*ctx->ansRead = true;
+	}
+	
+	/* Each base's own "ans" is hidden by the one in front of it */
+	const Context* base;
+	for(base = ctx->base; ret == NULL && base != NULL; base = base->base) {
+		ret = findVar(base->globals->next, name);
+	}
+	
+	return ret;
+}
+
 Variable* Context_get(const Context* ctx, const char* name) {
 	Variable* ret = NULL;
 	
@@ -305,8 +443,52 @@ Variable* Context_get(const Context* ctx, const char* name) {
 		ret = findVar(ctx->locals->vars, name);
 	}
 	
-	/* Search globals as a last resort only if it wasn't found in locals */
-	return ret ?: findVar(ctx->globals, name);
+	if(ret == NULL) {
+		ret = findGlobal(ctx, name);
+	}
+	
+	/* Search globals only if it wasn't found in locals, and builtins as a last resort */
+	return ret ?: Builtin_lookup(name);
+}
+
+Variable* Context_getCached(const Context* ctx, const char* name, VarCache* cache) {
+	/* Locals are different for every call, so they're always searched */
+	if(ctx->locals != NULL) {
+		Variable* local = findVar(ctx->locals->vars, name);
+		if(local != NULL) {
+			return local;
+		}
+	}
+	
+	/* Read the cache like a seqlock, only trusting it if it didn't change while being read */
+	unsigned long long version = *ctx->version;
+	unsigned seq = __atomic_load_n(&cache->seq, __ATOMIC_ACQUIRE);
+	if((seq & 1) == 0) {
+		Variable* var = __atomic_load_n(&cache->var, __ATOMIC_RELAXED);
+		unsigned long long cached = __atomic_load_n(&cache->version, __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		
+		if(var != NULL && cached == version && __atomic_load_n(&cache->seq, __ATOMIC_RELAXED) == seq) {
+			return var;
+		}
+	}
+	
+	Variable* ret = findGlobal(ctx, name) ?: Builtin_lookup(name);
+	
+	/* "ans" is always found first anyway, and leaving it out lets forks share versions */
+	if(ret == NULL || ret == ctx->globals->var || (seq & 1) != 0) {
+		return ret;
+	}
+	
+	/* Another thread filling it at the same time gets to keep its result */
+	if(__atomic_compare_exchange_n(&cache->seq, &seq, seq + 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+		__atomic_store_n(&cache->var, ret, __ATOMIC_RELAXED);
+		__atomic_store_n(&cache->version, version, __ATOMIC_RELAXED);
+		__atomic_store_n(&cache->seq, seq + 2, __ATOMIC_RELEASE);
+	}
+	
+	return ret;
 }
 
 Variable* Context_getAbove(const Context* ctx, const char* name) {
@@ -321,7 +503,8 @@ Variable* Context_getAbove(const Context* ctx, const char* name) {
 		}
 	}
 	
-	/* Last resort, try to find a global with this name */
-	return findVar(ctx->globals, name);
+	/* Last resort, try to find a global or builtin with this name */
+	Variable* ret = findGlobal(ctx, name);
+	return ret ?: Builtin_lookup(name);
 }
 
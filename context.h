@@ -11,6 +11,22 @@
 
 
 typedef struct Context Context;
+#include "annotations.h"
+
+/*
+ Inline cache for looking up one name from one spot in a parse tree. It
+ remembers which global or builtin the name found, along with the version of
+ the context at the time, which changes whenever a global is added or
+ deleted. Locals are never cached. A cache can be shared by any number of
+ contexts and threads, which just means it's refilled more often.
+*/
+typedef struct VarCache {
+	/* Odd while being filled */
+	unsigned seq;
+	struct Variable* _Nullable var;
+	unsigned long long version;
+} VarCache;
+
 #include "variable.h"
 #include "generic.h"
 #include "value.h"
@@ -18,6 +34,13 @@ typedef struct Context Context;
 
 ASSUME_NONNULL_BEGIN
 
+/* How numeric results are represented */
+typedef enum {
+	MODE_EXACT = 0, /* Prefer fractions over reals whenever possible */
+	MODE_FLOAT,     /* Anything that would be a fraction is a real instead */
+	MODE_EXTENDED   /* Like exact, but reals are double-doubles */
+} NUMMODE;
+
 /* Constructor */
 RETURNS_OWNED Context* Context_new(void);
 
@@ -32,12 +55,37 @@ void Context_addGlobal(const Context* ctx, CONSUMED Variable* var);
 void Context_addLocal(const Context* ctx, CONSUMED Variable* var);
 void Context_setGlobal(const Context* ctx, const char* name, CONSUMED Value* val);
 
+/* Iteration over global variables, oldest first */
+typedef void (*context_visit_t)(const Variable* var, void* _Nullable data);
+void Context_forEachGlobal(const Context* ctx, context_visit_t visit, void* _Nullable data);
+
+/* Numeric mode */
+NUMMODE Context_getMode(const Context* ctx);
+void Context_setMode(Context* ctx, NUMMODE mode);
+
 /* Stack frames */
 RETURNS_OWNED Context* Context_pushFrame(const Context* ctx);
 void Context_popFrame(CONSUMED Context* ctx);
 
-/* Variable deletion */
-void Context_del(const Context* ctx, const char* name);
+/*
+ A fork shares every global except "ans" with `ctx`, and sets `*ansRead`
+ whenever its own "ans" is looked up. Forks can be evaluated on other threads
+ as long as nothing modifies `ctx` until they are freed.
+*/
+RETURNS_OWNED Context* Context_fork(const Context* ctx, UNOWNED bool* _Nullable ansRead);
+void Context_freeFork(CONSUMED Context* fork);
+
+/*
+ A context that sees the globals of `base` (except its "ans") after its own,
+ without ever modifying them. Assigning to one of those names creates a
+ global of its own that hides the shared one. Many of these can share one
+ base, even on other threads, as long as nothing modifies `base` until they
+ are all freed.
+*/
+RETURNS_OWNED Context* Context_newShared(UNOWNED const Context* base);
+
+/* Variable deletion, returning why it couldn't be deleted */
+RETURNS_OWNED Error* _Nullable Context_del(const Context* ctx, const char* name);
 void Context_clear(UNOWNED Context* ctx);
 
 /*
@@ -47,6 +95,9 @@ void Context_clear(UNOWNED Context* ctx);
 RETURNS_UNOWNED Variable* _Nullable Context_get(const Context* ctx, const char* name);
 RETURNS_UNOWNED Variable* _Nullable Context_getAbove(const Context* ctx, const char* name);
 
+/* Context_get, but using and updating `cache` */
+RETURNS_UNOWNED Variable* _Nullable Context_getCached(const Context* ctx, const char* name, VarCache* cache);
+
 ASSUME_NONNULL_END
 
 #endif /* SC_CONTEXT_H */
@@ -0,0 +1,499 @@
+/*
+  ddreal.c
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include "ddreal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "support.h"
+#include "error.h"
+#include "generic.h"
+#include "value.h"
+#include "fraction.h"
+
+/* Significant digits printed for a double-double */
+#define DD_DIG 31
+
+/* Below this, terms of a Taylor series no longer affect the sum */
+#define DD_EPS 4.93038065763132e-32 /* 2^-104 */
+
+
+const DDReal DD_PI  = {3.141592653589793,  1.2246467991473532e-16};
+const DDReal DD_E   = {2.718281828459045,  1.4456468917292502e-16};
+const DDReal DD_PHI = {1.618033988749895,  -5.432115203682506e-17};
+const DDReal DD_LN2 = {0.6931471805599453, 2.3190468138462996e-17};
+const DDReal DD_LN10 = {2.302585092994046, -2.1707562233822494e-16};
+
+static const DDReal DD_ONE = {1.0, 0.0};
+static const DDReal DD_NAN = {NAN, NAN};
+
+static DDReal quickTwoSum(double a, double b);
+static DDReal twoSum(double a, double b);
+static DDReal twoProd(double a, double b);
+static DDReal mulDouble(DDReal a, double b);
+static DDReal ldexpDD(DDReal a, int exp);
+static DDReal floorDD(DDReal a);
+static DDReal powInt(DDReal base, long long exp);
+static DDReal pow10DD(int exp);
+
+
+/*
+ Error-free transformations. Each returns the rounded result in hi and the
+ exact rounding error in lo, so that hi + lo is exactly the true result.
+ Once hi overflows there's no error left to track, and computing it anyway
+ would give inf - inf, so lo is just zero.
+*/
+
+/* Requires |a| >= |b| */
+static DDReal quickTwoSum(double a, double b) {
+	double s = a + b;
+	if(!isfinite(s)) {
+		return (DDReal){s, 0.0};
+	}
+	
+	return (DDReal){s, b - (s - a)};
+}
+
+static DDReal twoSum(double a, double b) {
+	double s = a + b;
+	if(!isfinite(s)) {
+		return (DDReal){s, 0.0};
+	}
+	
+	double bb = s - a;
+	return (DDReal){s, (a - (s - bb)) + (b - bb)};
+}
+
+#ifndef FP_FAST_FMA
+/* Splits a into two 26-bit halves for Dekker's algorithm */
+static DDReal split(double a) {
+	const double splitter = 134217729.0; /* 2^27 + 1 */
+	
+	/* Multiplying by the splitter would overflow near the top of the range, so scale down first */
+	if(fabs(a) > 0x1p996) {
+		a = ldexp(a, -28);
+		double t = splitter * a;
+		double hi = t - (t - a);
+		return (DDReal){ldexp(hi, 28), ldexp(a - hi, 28)};
+	}
+	
+	double t = splitter * a;
+	double hi = t - (t - a);
+	return (DDReal){hi, a - hi};
+}
+#endif /* FP_FAST_FMA */
+
+static DDReal twoProd(double a, double b) {
+	double p = a * b;
+	if(!isfinite(p)) {
+		return (DDReal){p, 0.0};
+	}
+
+#ifdef FP_FAST_FMA
+	return (DDReal){p, fma(a, b, -p)};
+#else /* FP_FAST_FMA */
+	/* Dekker's algorithm: the products of the halves are all exact */
+	DDReal x = split(a);
+	DDReal y = split(b);
+	return (DDReal){p, ((x.hi * y.hi - p) + x.hi * y.lo + x.lo * y.hi) + x.lo * y.lo};
+#endif /* FP_FAST_FMA */
+}
+
+
+DDReal DDReal_fromDouble(double x) {
+	return (DDReal){x, 0.0};
+}
+
+DDReal DDReal_fromInt(long long x) {
+	/* Each 32-bit half converts to a double exactly, and so does their sum */
+	double high = (double)(x >> 32) * 4294967296.0;
+	double low = (double)(x & 0xffffffffll);
+	return twoSum(high, low);
+}
+
+DDReal DDReal_fromFrac(long long n, long long d) {
+	return DDReal_div(DDReal_fromInt(n), DDReal_fromInt(d));
+}
+
+double DDReal_asReal(DDReal x) {
+	return x.hi + x.lo;
+}
+
+DDReal DDReal_neg(DDReal a) {
+	return (DDReal){-a.hi, -a.lo};
+}
+
+DDReal DDReal_add(DDReal a, DDReal b) {
+	DDReal s = twoSum(a.hi, b.hi);
+	DDReal t = twoSum(a.lo, b.lo);
+	
+	s.lo += t.hi;
+	s = quickTwoSum(s.hi, s.lo);
+	s.lo += t.lo;
+	return quickTwoSum(s.hi, s.lo);
+}
+
+DDReal DDReal_sub(DDReal a, DDReal b) {
+	return DDReal_add(a, DDReal_neg(b));
+}
+
+DDReal DDReal_mul(DDReal a, DDReal b) {
+	DDReal p = twoProd(a.hi, b.hi);
+	if(!isfinite(p.hi)) {
+		return p;
+	}
+	
+	p.lo += a.hi * b.lo + a.lo * b.hi;
+	return quickTwoSum(p.hi, p.lo);
+}
+
+static DDReal mulDouble(DDReal a, double b) {
+	DDReal p = twoProd(a.hi, b);
+	if(!isfinite(p.hi)) {
+		return p;
+	}
+	
+	p.lo += a.lo * b;
+	return quickTwoSum(p.hi, p.lo);
+}
+
+DDReal DDReal_div(DDReal a, DDReal b) {
+	/* Long division, one double-sized digit at a time */
+	double q1 = a.hi / b.hi;
+	if(!isfinite(q1) || !isfinite(b.hi)) {
+		return DDReal_fromDouble(q1);
+	}
+	
+	DDReal r = DDReal_sub(a, mulDouble(b, q1));
+	
+	double q2 = r.hi / b.hi;
+	r = DDReal_sub(r, mulDouble(b, q2));
+	
+	double q3 = r.hi / b.hi;
+	
+	DDReal q = quickTwoSum(q1, q2);
+	return DDReal_add(q, DDReal_fromDouble(q3));
+}
+
+static DDReal ldexpDD(DDReal a, int exp) {
+	return (DDReal){ldexp(a.hi, exp), ldexp(a.lo, exp)};
+}
+
+static DDReal floorDD(DDReal a) {
+	double hi = floor(a.hi);
+	double lo = 0.0;
+	
+	if(hi == a.hi) {
+		/* hi is already an integer, so the fractional part is in lo */
+		lo = floor(a.lo);
+	}
+	
+	return quickTwoSum(hi, lo);
+}
+
+DDReal DDReal_mod(DDReal a, DDReal b) {
+	/* Same sign convention as fmod: the result has the sign of a */
+	DDReal q = DDReal_div(a, b);
+	DDReal n = q.hi < 0 ? DDReal_neg(floorDD(DDReal_neg(q))) : floorDD(q);
+	return DDReal_sub(a, DDReal_mul(n, b));
+}
+
+DDReal DDReal_sqrt(DDReal a) {
+	if(a.hi <= 0.0) {
+		return a.hi == 0.0 ? DDReal_fromDouble(0.0) : DD_NAN;
+	}
+	
+	if(isinf(a.hi)) {
+		return a;
+	}
+	
+	/*
+	 Karp's trick: with x ~= 1/sqrt(a) in plain double precision,
+	 sqrt(a) ~= a*x + (a - (a*x)^2) * x / 2, which is accurate to double-double.
+	*/
+	double x = 1.0 / sqrt(a.hi);
+	double ax = a.hi * x;
+	DDReal ax2 = twoProd(ax, ax);
+	double diff = DDReal_sub(a, ax2).hi;
+	return twoSum(ax, diff * x * 0.5);
+}
+
+DDReal DDReal_exp(DDReal a) {
+	if(a.hi > 709.782712893384) {
+		return DDReal_fromDouble(INFINITY);
+	}
+	
+	if(a.hi < -745.1332191019412) {
+		return DDReal_fromDouble(0.0);
+	}
+	
+	/* exp(a) = 2^k * exp(r), where r = a - k*ln(2) and |r| <= ln(2)/2 */
+	double k = floor(a.hi / DD_LN2.hi + 0.5);
+	DDReal r = DDReal_sub(a, mulDouble(DD_LN2, k));
+	
+	/* Shrink r further so the Taylor series converges in a few terms */
+	const int squarings = 10;
+	r = ldexpDD(r, -squarings);
+	
+	/* s = exp(r) - 1, keeping the leading 1 separate to avoid losing bits */
+	DDReal s = r;
+	DDReal term = r;
+	double i;
+	for(i = 2.0; i < 30.0; i++) {
+		term = DDReal_div(DDReal_mul(term, r), DDReal_fromDouble(i));
+		s = DDReal_add(s, term);
+		
+		if(fabs(term.hi) < DD_EPS) {
+			break;
+		}
+	}
+	
+	/* (1 + s)^2 - 1 == 2s + s^2 */
+	int j;
+	for(j = 0; j < squarings; j++) {
+		s = DDReal_add(ldexpDD(s, 1), DDReal_mul(s, s));
+	}
+	
+	return ldexpDD(DDReal_add(s, DD_ONE), (int)k);
+}
+
+DDReal DDReal_log(DDReal a) {
+	if(a.hi <= 0.0) {
+		return a.hi == 0.0 ? DDReal_fromDouble(-INFINITY) : DD_NAN;
+	}
+	
+	if(a.hi == 1.0 && a.lo == 0.0) {
+		return DDReal_fromDouble(0.0);
+	}
+	
+	if(isinf(a.hi)) {
+		return a;
+	}
+	
+	/* One Newton iteration on exp(x) = a doubles the precision of log(a.hi) */
+	DDReal x = DDReal_fromDouble(log(a.hi));
+	DDReal correction = DDReal_mul(a, DDReal_exp(DDReal_neg(x)));
+	return DDReal_sub(DDReal_add(x, correction), DD_ONE);
+}
+
+static DDReal powInt(DDReal base, long long exp) {
+	bool invert = exp < 0;
+	unsigned long long n = invert ? -(unsigned long long)exp : (unsigned long long)exp;
+	DDReal ret = DD_ONE;
+	
+	while(n) {
+		if(n & 1) {
+			ret = DDReal_mul(ret, base);
+		}
+		
+		n >>= 1;
+		if(n) {
+			base = DDReal_mul(base, base);
+		}
+	}
+	
+	return invert ? DDReal_div(DD_ONE, ret) : ret;
+}
+
+DDReal DDReal_pow(DDReal base, DDReal exp) {
+	/* Whole number exponents are computed by repeated squaring, which also handles negative bases */
+	if(exp.lo == 0.0 && exp.hi == floor(exp.hi) && fabs(exp.hi) < 9007199254740992.0) {
+		return powInt(base, (long long)exp.hi);
+	}
+	
+	if(base.hi <= 0.0) {
+		return base.hi == 0.0 && exp.hi > 0.0 ? DDReal_fromDouble(0.0) : DD_NAN;
+	}
+	
+	/* Common enough (via sqrt) to be worth a more accurate special case */
+	if(exp.hi == 0.5 && exp.lo == 0.0) {
+		return DDReal_sqrt(base);
+	}
+	
+	return DDReal_exp(DDReal_mul(exp, DDReal_log(base)));
+}
+
+int DDReal_cmp(DDReal a, DDReal b) {
+	if(a.hi != b.hi) {
+		return a.hi < b.hi ? -1 : 1;
+	}
+	
+	if(a.lo != b.lo) {
+		return a.lo < b.lo ? -1 : 1;
+	}
+	
+	return 0;
+}
+
+bool DDReal_isZero(DDReal a) {
+	return a.hi == 0.0;
+}
+
+DDReal* DDReal_new(DDReal x) {
+	DDReal* ret = fmalloc(sizeof(*ret));
+	*ret = x;
+	return ret;
+}
+
+void DDReal_free(DDReal* x) {
+	destroy(x);
+}
+
+bool DDReal_fromValue(const Value* val, DDReal* result) {
+	switch(val->type) {
+		case VAL_INT:
+			*result = DDReal_fromInt(val->ival);
+			return true;
+		
+		case VAL_REAL:
+			*result = DDReal_fromDouble(val->rval);
+			return true;
+		
+		case VAL_FRAC:
+			*result = DDReal_fromFrac(val->frac->n, val->frac->d);
+			return true;
+		
+		case VAL_XREAL:
+			*result = *val->xreal;
+			return true;
+		
+		default:
+			return false;
+	}
+}
+
+static DDReal pow10DD(int exp) {
+	return powInt(DDReal_fromDouble(10.0), exp);
+}
+
+char* DDReal_repr(DDReal x) {
+	char* ret;
+	
+	if(isnan(x.hi)) {
+		return strdup("nan");
+	}
+	
+	if(isinf(x.hi)) {
+		return strdup(x.hi < 0 ? "-inf" : "inf");
+	}
+	
+	if(x.hi == 0.0) {
+		return strdup("0");
+	}
+	
+	bool negative = x.hi < 0.0;
+	if(negative) {
+		x = DDReal_neg(x);
+	}
+	
+	/* Scale x into [1, 10) */
+	int exp10 = (int)floor(log10(x.hi));
+	DDReal r = exp10 >= 0 ? DDReal_div(x, pow10DD(exp10)) : DDReal_mul(x, pow10DD(-exp10));
+	if(r.hi >= 10.0) {
+		r = DDReal_div(r, DDReal_fromDouble(10.0));
+		exp10++;
+	}
+	else if(r.hi < 1.0) {
+		r = mulDouble(r, 10.0);
+		exp10--;
+	}
+	
+	/* Peel off one more digit than will be printed so the last one can be rounded */
+	int digits[DD_DIG + 1];
+	int i;
+	for(i = 0; i <= DD_DIG; i++) {
+		digits[i] = (int)floor(r.hi);
+		r = mulDouble(DDReal_sub(r, DDReal_fromDouble(digits[i])), 10.0);
+	}
+	
+	/* Round, then fix up any digits that fell outside of 0-9 */
+	if(digits[DD_DIG] >= 5) {
+		digits[DD_DIG - 1]++;
+	}
+	for(i = DD_DIG - 1; i > 0; i--) {
+		if(digits[i] < 0) {
+			digits[i] += 10;
+			digits[i - 1]--;
+		}
+		else if(digits[i] > 9) {
+			digits[i] -= 10;
+			digits[i - 1]++;
+		}
+	}
+	if(digits[0] > 9) {
+		/* Carried all the way out, like 9.99... rounding to 10 */
+		memmove(&digits[1], &digits[0], (DD_DIG - 1) * sizeof(digits[0]));
+		digits[0] = 1;
+		digits[1] = 0;
+		exp10++;
+	}
+	
+	/* Drop trailing zeros */
+	int count = DD_DIG;
+	while(count > 1 && digits[count - 1] == 0) {
+		count--;
+	}
+	
+	/* Room for sign, digits, leading zeros, point, and exponent */
+	char buf[DD_DIG + 32];
+	char* p = buf;
+	if(negative) {
+		*p++ = '-';
+	}
+	
+	if(exp10 < -5 || exp10 >= DD_DIG) {
+		/* Scientific notation, matching %g */
+		*p++ = (char)('0' + digits[0]);
+		if(count > 1) {
+			*p++ = '.';
+			for(i = 1; i < count; i++) {
+				*p++ = (char)('0' + digits[i]);
+			}
+		}
+		sprintf(p, "e%c%02d", exp10 < 0 ? '-' : '+', ABS(exp10));
+	}
+	else if(exp10 < 0) {
+		*p++ = '0';
+		*p++ = '.';
+		for(i = -1; i > exp10; i--) {
+			*p++ = '0';
+		}
+		for(i = 0; i < count; i++) {
+			*p++ = (char)('0' + digits[i]);
+		}
+		*p = '\0';
+	}
+	else {
+		for(i = 0; i < count || i <= exp10; i++) {
+			if(i == exp10 + 1) {
+				*p++ = '.';
+			}
+			*p++ = (char)('0' + (i < count ? digits[i] : 0));
+		}
+		*p = '\0';
+	}
+	
+	ret = strdup(buf);
+	return ret;
+}
+
+char* DDReal_xml(DDReal x) {
+	/*
+	 sc> mode "extended"
+	 sc> ?x sqrt(2)
+	
+	 <xreal>1.41421356237309504880168872421</xreal>
+	*/
+	char* ret;
+	char* repr = DDReal_repr(x);
+	asprintf(&ret, "<xreal>%s</xreal>", repr);
+	destroy(repr);
+	return ret;
+}
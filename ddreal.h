@@ -0,0 +1,73 @@
+/*
+  ddreal.h
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#ifndef SC_DDREAL_H
+#define SC_DDREAL_H
+
+#include <stdbool.h>
+
+typedef struct DDReal DDReal;
+#include "value.h"
+#include "generic.h"
+
+
+ASSUME_NONNULL_BEGIN
+
+/*
+ Double-double real: the unevaluated sum hi + lo, where |lo| <= ulp(hi) / 2.
+ That gives about 106 bits (32 decimal digits) of precision while every
+ operation is just a handful of ordinary double operations.
+*/
+struct DDReal {
+	double hi;
+	double lo;
+};
+
+/* Constants */
+extern const DDReal DD_PI;
+extern const DDReal DD_E;
+extern const DDReal DD_PHI;
+extern const DDReal DD_LN2;
+extern const DDReal DD_LN10;
+
+/* Exact conversions */
+DDReal DDReal_fromDouble(double x);
+DDReal DDReal_fromInt(long long x);
+DDReal DDReal_fromFrac(long long n, INVARIANT(d != 0) long long d);
+double DDReal_asReal(DDReal x);
+
+/* Arithmetic */
+DDReal DDReal_neg(DDReal a);
+DDReal DDReal_add(DDReal a, DDReal b);
+DDReal DDReal_sub(DDReal a, DDReal b);
+DDReal DDReal_mul(DDReal a, DDReal b);
+DDReal DDReal_div(DDReal a, DDReal b);
+DDReal DDReal_mod(DDReal a, DDReal b);
+
+/* Elementary functions */
+DDReal DDReal_sqrt(DDReal a);
+DDReal DDReal_exp(DDReal a);
+DDReal DDReal_log(DDReal a);
+DDReal DDReal_pow(DDReal base, DDReal exp);
+
+/* Comparison */
+int DDReal_cmp(DDReal a, DDReal b);
+bool DDReal_isZero(DDReal a);
+
+/* Value interoperability */
+RETURNS_OWNED DDReal* DDReal_new(DDReal x);
+void DDReal_free(CONSUMED DDReal* _Nullable x);
+bool DDReal_fromValue(const Value* val, OUT DDReal* result);
+
+/* Printing */
+RETURNS_OWNED char* DDReal_repr(DDReal x);
+RETURNS_OWNED char* DDReal_xml(DDReal x);
+
+ASSUME_NONNULL_END
+
+#endif /* SC_DDREAL_H */
@@ -17,6 +17,7 @@
 #include "value.h"
 #include "arglist.h"
 #include "error.h"
+#include "builtin.h"
 
 
 #define EVAL_CONST(name, val) \
@@ -27,6 +28,17 @@ static Value* eval_##name(const Context* ctx, const ArgList* arglist, bool inter
 	return ValReal((val)); \
 }
 
+/* Constant whose value is a DDReal, which is only fully used in extended mode */
+#define EVAL_XCONST(name, xval) \
+static Value* eval_##name(const Context* ctx, const ArgList* arglist, bool internal) { \
+	UNREFERENCED_PARAMETER(arglist); \
+	UNREFERENCED_PARAMETER(internal); \
+	if(Context_getMode(ctx) == MODE_EXTENDED) { \
+		return ValXReal((xval)); \
+	} \
+	return ValReal((xval).hi); \
+}
+
 #define EVAL_FUNC(name, func, nargs) \
 static Value* eval_##name(const Context* ctx, const ArgList* arglist, bool internal) { \
 	UNREFERENCED_PARAMETER(internal); \
@@ -49,8 +61,36 @@ static Value* eval_##name(const Context* ctx, const ArgList* arglist, bool inter
 }
 
 
-void register_math(Context* _Nonnull ctx);
-void register_vector(Context* _Nonnull ctx);
+/* One argument function that evaluates `xfunc` of the DDReal `x` in extended mode */
+#define EVAL_XFUNC(name, func, xfunc) \
+static Value* eval_##name(const Context* ctx, const ArgList* arglist, bool internal) { \
+	UNREFERENCED_PARAMETER(internal); \
+	if(arglist->count != 1) { \
+		return ValErr(builtinArgs(#name, 1, arglist->count)); \
+	} \
+	Value* arg = Value_coerce(arglist->args[0], ctx); \
+	if(arg->type == VAL_ERR) { \
+		return arg; \
+	} \
+	DDReal x; \
+	bool isNumber = DDReal_fromValue(arg, &x); \
+	Value_free(arg); \
+	if(!isNumber) { \
+		return ValErr(badConversion(#name)); \
+	} \
+	if(Context_getMode(ctx) == MODE_EXTENDED) { \
+		return ValXReal((xfunc)); \
+	} \
+	double a[1] = {DDReal_asReal(x)}; \
+	return ValReal((func)); \
+}
+
+
+/* Builtin tables, which are looked up through Builtin_lookup */
+extern const Builtin g_mathBuiltins[];
+extern const unsigned g_mathBuiltinCount;
+extern const Builtin g_vectorBuiltins[];
+extern const unsigned g_vectorBuiltinCount;
 
 
 #endif /* SC_DEFAULTS_H */
@@ -21,12 +21,13 @@
 #include "fraction.h"
 #include "funccall.h"
 #include "template.h"
+#include "ddreal.h"
+#include "modint.h"
 
 
-EVAL_CONST(pi, M_PI);
-EVAL_CONST(e, M_E);
-#define PHI 1.61803398874989484820458683436563811 /* Golden ratio: (1 + sqrt(5)) / 2 */
-EVAL_CONST(phi, PHI);
+EVAL_XCONST(pi, DD_PI);
+EVAL_XCONST(e, DD_E);
+EVAL_XCONST(phi, DD_PHI); /* Golden ratio: (1 + sqrt(5)) / 2 */
 
 
 static Value* eval_sqrt(const Context* ctx, const ArgList* arglist, bool internal) {
@@ -68,6 +69,10 @@ static Value* eval_abs(const Context* ctx, const ArgList* arglist, bool internal
 		case VAL_FRAC:
 			ret = ValFrac(Fraction_new(ABS(val->frac->n), val->frac->d));
 			break;
+		
+		case VAL_XREAL:
+			ret = ValXReal(val->xreal->hi < 0 ? DDReal_neg(*val->xreal) : *val->xreal);
+			break;
 			
 		case VAL_VEC:
 			ret = Vector_magnitude(val->vec, ctx);
@@ -131,63 +136,163 @@ EVAL_FUNC(asech, acosh(1 / a[0]), 1);
 EVAL_FUNC(acsch, asinh(1 / a[0]), 1);
 EVAL_FUNC(acoth, atanh(1 / a[0]), 1);
 
-EVAL_FUNC(log, log10(a[0]), 1);
-EVAL_FUNC(log2, log2(a[0]), 1);
-EVAL_FUNC(ln, log(a[0]), 1);
+EVAL_XFUNC(log, log10(a[0]), DDReal_div(DDReal_log(x), DD_LN10));
+EVAL_XFUNC(log2, log2(a[0]), DDReal_div(DDReal_log(x), DD_LN2));
+EVAL_XFUNC(ln, log(a[0]), DDReal_log(x));
 EVAL_FUNC(logbase, log(a[0]) / log(a[1]), 2);
 
+/* Modular arithmetic */
+typedef bool (*modop_t)(const ModRing* ring, long long a, long long b, OUT uint64_t* result);
 
-static const char* _math_const_names[] = {
-	"pi", "e", "phi"
-};
-
-static builtin_eval_t _math_consts[] = {
-	&eval_pi, &eval_e, &eval_phi
-};
-
-static const char* _math_names[] = {
-	"sqrt", "abs", "exp",
-	"sin", "cos", "tan",
-	"sec", "csc", "cot",
-	"asin", "acos", "atan",
-	"asec", "acsc", "acot",
-	"sinh", "cosh", "tanh",
-	"sech", "csch", "coth",
-	"asinh", "acosh", "atanh",
-	"asech", "acsch", "acoth",
-	"log", "log2", "ln",
-	"logbase", "atan2"
-};
+static bool modop_mul(const ModRing* ring, long long a, long long b, uint64_t* result) {
+	*result = ModRing_mul(ring, ModRing_reduce(ring, a), ModRing_reduce(ring, b));
+	return true;
+}
 
-static builtin_eval_t _math_funcs[] = {
-	&eval_sqrt, &eval_abs, &eval_exp,
-	&eval_sin, &eval_cos, &eval_tan,
-	&eval_sec, &eval_csc, &eval_cot,
-	&eval_asin, &eval_acos, &eval_atan,
-	&eval_asec, &eval_acsc, &eval_acot,
-	&eval_sinh, &eval_cosh, &eval_tanh,
-	&eval_sech, &eval_csch, &eval_coth,
-	&eval_asinh, &eval_acosh, &eval_atanh,
-	&eval_asech, &eval_acsch, &eval_acoth,
-	&eval_log, &eval_log2, &eval_ln,
-	&eval_logbase, &eval_atan2
-};
+static bool modop_pow(const ModRing* ring, long long a, long long b, uint64_t* result) {
+	uint64_t base = ModRing_reduce(ring, a);
+	
+	/* Negative powers are powers of the inverse */
+	if(b < 0 && !ModRing_inv(ring, base, &base)) {
+		return false;
+	}
+	
+	*result = ModRing_pow(ring, base, b < 0 ? 0ull - (unsigned long long)b : (unsigned long long)b);
+	return true;
+}
 
+static bool modop_inv(const ModRing* ring, long long a, long long b, uint64_t* result) {
+	UNREFERENCED_PARAMETER(b);
+	return ModRing_inv(ring, ModRing_reduce(ring, a), result);
+}
 
-void register_math(Context* ctx) {
-	unsigned i;
-	unsigned constCount = ARRSIZE(_math_const_names);
+/* Applies `op` to integers or elementwise over vectors. `b` may be NULL for unary ops. */
+static Value* modElementwise(const char* name, const ModRing* ring, modop_t op, const Value* a, const Value* _Nullable b) {
+	bool aVec = a->type == VAL_VEC;
+	bool bVec = b != NULL && b->type == VAL_VEC;
+	
+	if(aVec || bVec) {
+		unsigned count = aVec ? a->vec->vals->count : b->vec->vals->count;
+		if(aVec && bVec && b->vec->vals->count != count) {
+			return ValErr(mathError("Builtin '%s' expects vectors of the same size.", name));
+		}
+		
+		ArgList* results = ArgList_new(count);
+		
+		unsigned i;
+		for(i = 0; i < count; i++) {
+			Value* elem = modElementwise(name, ring, op,
+			                             aVec ? a->vec->vals->args[i] : a,
+			                             bVec ? b->vec->vals->args[i] : b);
+			if(elem->type == VAL_ERR) {
+				ArgList_free(results);
+				return elem;
+			}
+			
+			results->args[i] = elem;
+		}
+		
+		return ValVec(Vector_new(results));
+	}
+	
+	if(a->type != VAL_INT || (b != NULL && b->type != VAL_INT)) {
+		return ValErr(typeError("Builtin '%s' expects integer arguments.", name));
+	}
 	
-	for(i = 0; i < constCount; i++) {
-		Builtin* blt = Builtin_new(strdup(_math_const_names[i]), _math_consts[i], false);
-		Builtin_register(blt, ctx);
+	uint64_t result;
+	if(!op(ring, a->ival, b ? b->ival : 0, &result)) {
+		return ValErr(mathError("%lld is not invertible modulo %llu.", a->ival, (unsigned long long)ring->m));
 	}
 	
-	unsigned funcCount = ARRSIZE(_math_names);
+	return ValInt((long long)result);
+}
+
+/* Evaluates the arguments and applies `op` over them, with the modulus as the last argument */
+static Value* modBuiltin(const char* name, modop_t op, unsigned nargs, const Context* ctx, const ArgList* arglist) {
+	if(arglist->count != nargs) {
+		return ValErr(builtinArgs(name, nargs, arglist->count));
+	}
 	
-	for(i = 0; i < funcCount; i++) {
-		Builtin* blt = Builtin_new(strdup(_math_names[i]), _math_funcs[i], true);
-		Builtin_register(blt, ctx);
+	Error* err = NULL;
+	ArgList* e = ArgList_eval(arglist, ctx, &err);
+	if(!e) {
+		return ValErr(err);
+	}
+	
+	Value* ret;
+	const Value* m = e->args[nargs - 1];
+	if(m->type != VAL_INT || m->ival < 1) {
+		ret = ValErr(mathError("Builtin '%s' expects a positive integer modulus.", name));
 	}
+	else {
+		ModRing ring;
+		ModRing_init(&ring, (uint64_t)m->ival);
+		ret = modElementwise(name, &ring, op, e->args[0], nargs > 2 ? e->args[1] : NULL);
+	}
+	
+	ArgList_free(e);
+	return ret;
+}
+
+static Value* eval_powmod(const Context* ctx, const ArgList* arglist, bool internal) {
+	UNREFERENCED_PARAMETER(internal);
+	return modBuiltin("powmod", &modop_pow, 3, ctx, arglist);
+}
+
+static Value* eval_mulmod(const Context* ctx, const ArgList* arglist, bool internal) {
+	UNREFERENCED_PARAMETER(internal);
+	return modBuiltin("mulmod", &modop_mul, 3, ctx, arglist);
 }
 
+static Value* eval_invmod(const Context* ctx, const ArgList* arglist, bool internal) {
+	UNREFERENCED_PARAMETER(internal);
+	return modBuiltin("invmod", &modop_inv, 2, ctx, arglist);
+}
+
+
+/* Every name here must also be in the perfect hash table, see builtin_table.c */
+const Builtin g_mathBuiltins[] = {
+	/* Constants */
+	{"pi", &eval_pi, false},
+	{"e", &eval_e, false},
+	{"phi", &eval_phi, false},
+	
+	/* Functions */
+	{"sqrt", &eval_sqrt, true},
+	{"abs", &eval_abs, true},
+	{"exp", &eval_exp, true},
+	{"sin", &eval_sin, true},
+	{"cos", &eval_cos, true},
+	{"tan", &eval_tan, true},
+	{"sec", &eval_sec, true},
+	{"csc", &eval_csc, true},
+	{"cot", &eval_cot, true},
+	{"asin", &eval_asin, true},
+	{"acos", &eval_acos, true},
+	{"atan", &eval_atan, true},
+	{"asec", &eval_asec, true},
+	{"acsc", &eval_acsc, true},
+	{"acot", &eval_acot, true},
+	{"sinh", &eval_sinh, true},
+	{"cosh", &eval_cosh, true},
+	{"tanh", &eval_tanh, true},
+	{"sech", &eval_sech, true},
+	{"csch", &eval_csch, true},
+	{"coth", &eval_coth, true},
+	{"asinh", &eval_asinh, true},
+	{"acosh", &eval_acosh, true},
+	{"atanh", &eval_atanh, true},
+	{"asech", &eval_asech, true},
+	{"acsch", &eval_acsch, true},
+	{"acoth", &eval_acoth, true},
+	{"log", &eval_log, true},
+	{"log2", &eval_log2, true},
+	{"ln", &eval_ln, true},
+	{"logbase", &eval_logbase, true},
+	{"atan2", &eval_atan2, true},
+	{"powmod", &eval_powmod, true},
+	{"mulmod", &eval_mulmod, true},
+	{"invmod", &eval_invmod, true}
+};
+
+const unsigned g_mathBuiltinCount = ARRSIZE(g_mathBuiltins);
@@ -28,15 +28,18 @@ static Value* eval_dot(const Context* ctx, const ArgList* arglist, bool internal
 		return ValErr(builtinArgs("dot", 2, arglist->count));
 	}
 	
-	Value* vector1 = Value_coerce(arglist->args[0], ctx);
+	/* Vectors in variables are read where they're stored */
+	Value* owned1 = NULL;
+	const Value* vector1 = Value_borrow(arglist->args[0], ctx) ?: (owned1 = Value_coerce(arglist->args[0], ctx));
 	if(vector1->type == VAL_ERR) {
-		return vector1;
+		return CAST_NONNULL(owned1);
 	}
 	
-	Value* vector2 = Value_coerce(arglist->args[1], ctx);
+	Value* owned2 = NULL;
+	const Value* vector2 = Value_borrow(arglist->args[1], ctx) ?: (owned2 = Value_coerce(arglist->args[1], ctx));
 	if(vector2->type == VAL_ERR) {
-		Value_free(vector1);
-		return vector2;
+		Value_free(owned1);
+		return CAST_NONNULL(owned2);
 	}
 	
 	if(vector1->type != VAL_VEC || vector2->type != VAL_VEC) {
@@ -47,8 +50,8 @@ static Value* eval_dot(const Context* ctx, const ArgList* arglist, bool internal
 		ret = Vector_dot(vector1->vec, vector2->vec, ctx);
 	}
 	
-	Value_free(vector1);
-	Value_free(vector2);
+	Value_free(owned1);
+	Value_free(owned2);
 	return ret;
 }
 
@@ -99,32 +102,32 @@ static Value* eval_map(const Context* ctx, const ArgList* arglist, bool internal
 		return ValErr(builtinArgs("map", 2, arglist->count));
 	}
 	
-	Value* callable = Value_copy(arglist->args[0]);
+	/* Names are called by name, and functions are borrowed from wherever they're stored */
+	Value* ownedCallable = NULL;
+	const Value* callable = arglist->args[0];
 	if(callable->type != VAL_VAR) {
-		Value* val = Value_eval(callable, ctx);
-		Value_free(callable);
+		callable = Value_borrow(callable, ctx) ?: (ownedCallable = Value_eval(callable, ctx));
 		
-		if(val->type == VAL_ERR) {
-			return val;
+		if(callable->type == VAL_ERR) {
+			return CAST_NONNULL(ownedCallable);
 		}
 		
-		if(!Value_isCallable(val)) {
-			Value_free(val);
+		if(!Value_isCallable(callable)) {
+			Value_free(ownedCallable);
 			return ValErr(typeError("Builtin 'map' expects a callable as its first argument."));
 		}
-		
-		callable = val;
 	}
 	
-	Value* vec = Value_coerce(arglist->args[1], ctx);
+	Value* ownedVec = NULL;
+	const Value* vec = Value_borrow(arglist->args[1], ctx) ?: (ownedVec = Value_coerce(arglist->args[1], ctx));
 	if(vec->type == VAL_ERR) {
-		Value_free(callable);
-		return vec;
+		Value_free(ownedCallable);
+		return CAST_NONNULL(ownedVec);
 	}
 	
 	if(vec->type != VAL_VEC) {
-		Value_free(callable);
-		Value_free(vec);
+		Value_free(ownedCallable);
+		Value_free(ownedVec);
 		return ValErr(typeError("Builtin 'map' expects a vector as its second argument."));
 	}
 	
@@ -133,17 +136,12 @@ static Value* eval_map(const Context* ctx, const ArgList* arglist, bool internal
 	unsigned i;
 	for(i = 0; i < mapping->count; i++) {
 		TP(tp);
-		Value* copiedCallable = Value_copy(callable);
-		Value* arg = Value_copy(vec->vec->vals->args[i]);
-		mapping->args[i] = TP_EVAL(tp, ctx, "@@(@@)",
-								   copiedCallable,
-								   arg);
-		analyzer_consume(copiedCallable);
-		analyzer_consume(arg);
+		const Value* args[] = {callable, vec->vec->vals->args[i]};
+		mapping->args[i] = TP_EVAL_ARGS(tp, ctx, "@@(@@)", args);
 	}
 	
-	Value_free(callable);
-	Value_free(vec);
+	Value_free(ownedCallable);
+	Value_free(ownedVec);
 	return ValVec(Vector_new(mapping));
 }
 
@@ -224,22 +222,14 @@ static Value* eval_norm(const Context* ctx, const ArgList* arglist, bool interna
 	return ret;
 }
 
-static const char* _vector_names[] = {
-	"dot", "cross", "map",
-	"elem", "mag", "norm"
-};
-static builtin_eval_t _vector_funcs[] = {
-	&eval_dot, &eval_cross, &eval_map,
-	&eval_elem, &eval_mag, &eval_norm
+/* Every name here must also be in the perfect hash table, see builtin_table.c */
+const Builtin g_vectorBuiltins[] = {
+	{"dot", &eval_dot, true},
+	{"cross", &eval_cross, true},
+	{"map", &eval_map, true},
+	{"elem", &eval_elem, true},
+	{"mag", &eval_mag, true},
+	{"norm", &eval_norm, true}
 };
 
-/* This is just a copy of register_math remade for vectors */
-void register_vector(Context* ctx) {
-	unsigned count = ARRSIZE(_vector_names);
-	unsigned i;
-	for(i = 0; i < count; i++) {
-		Builtin* blt = Builtin_new(strdup(_vector_names[i]), _vector_funcs[i], true);
-		Builtin_register(blt, ctx);
-	}
-}
-
+const unsigned g_vectorBuiltinCount = ARRSIZE(g_vectorBuiltins);
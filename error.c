@@ -57,17 +57,18 @@ Error* Error_vnew(ERRTYPE type, const char* fmt, va_list args) {
 	asprintf(&ret->msg, error_messages[type], tmp);
 	destroy(tmp);
 	
-	if(g_inputFileName != NULL) {
-		ret->filename = strdup(g_inputFileName);
+	InputState* in = Input_current();
+	if(in->fileName != NULL) {
+		ret->filename = strdup(in->fileName);
 	}
 	else {
 		ret->filename = NULL;
 	}
 	
-	ret->line = g_lineNumber;
+	ret->line = in->lineNumber;
 	
 	if(errpos != NULL) {
-		ret->column = (unsigned)(errpos - g_line) + 1;
+		ret->column = (unsigned)(errpos - in->line) + 1;
 	}
 	
 	return ret;
@@ -115,7 +116,7 @@ void Error_raise(const Error* err, bool forceDeath) {
 	
 	if(forceDeath || !Error_canRecover(err)) {
 		/* Useful to set a breakpoint on the next line for debugging */
-		fprintf(stderr, "Crashing line:\n%s", g_line);
+		fprintf(stderr, "Crashing line:\n%s", Input_current()->line);
 		abort();
 	}
 }
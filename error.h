@@ -53,6 +53,16 @@ typedef struct Error Error;
 #define kMissingPlaceholderStr  "Missing placeholder number %u."
 #define kBadImportDepthStr      "Exceeded max allowed import depth when trying to import file '%s'."
 #define kImportErrorStr         "Failed to import file '%s': %s."
+#define kSnapshotErrorStr       "Failed to %s snapshot '%s': %s."
+#define kUnterminatedStr        "Unterminated string."
+#define kBadModeStr             "Unknown numeric mode '%s'."
+#define kBadDecimalsStr         "Unknown decimals setting '%s'."
+#define kBadCommandStr          "Unknown command '%s'."
+#define kBadRequestStr          "Invalid request: %s."
+#define kServerErrorStr         "Failed to %s socket '%s': %s."
+#define kTooManySessionsStr     "Too many named sessions (at most %u)."
+#define kMissingColumnStr       "No column named '%s' for the parameter."
+#define kCsvFieldsStr           "Expected %u field%s, not %u."
 
 #define kAllocErrStr            "Unable to allocate memory."
 #define kBadValStr              "Unexpected value type: %d."
@@ -71,6 +81,16 @@ typedef struct Error Error;
 #define missingPlaceholder(n)       nameError(kMissingPlaceholderStr, (n))
 #define badImportDepth(filename)    runtimeError(kBadImportDepthStr, (filename))
 #define importError(filename, err)  runtimeError(kImportErrorStr, (filename), (err))
+#define snapshotError(action, filename, err) runtimeError(kSnapshotErrorStr, (action), (filename), (err))
+#define unterminated(s)             syntaxError((s), kUnterminatedStr)
+#define badMode(name)               nameError(kBadModeStr, (name))
+#define badDecimals(name)           nameError(kBadDecimalsStr, (name))
+#define badCommand(name)            nameError(kBadCommandStr, (name))
+#define badRequest(why)             runtimeError(kBadRequestStr, (why))
+#define serverError(action, path, err) runtimeError(kServerErrorStr, (action), (path), (err))
+#define tooManySessions(max)        runtimeError(kTooManySessionsStr, (max))
+#define missingColumn(name)         nameError(kMissingColumnStr, (name))
+#define csvFields(n1, n2)           runtimeError(kCsvFieldsStr, (n1), (n1) == 1 ? "" : "s", (n2))
 
 /* Death macros */
 #define DIE(...)                    die(__FILE__, __FUNCTION__, __LINE__, __VA_ARGS__)
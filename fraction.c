@@ -19,11 +19,15 @@
 #include "value.h"
 
 
+/* Results with both terms at most this large are left unreduced (see fracResult) */
+#define FRAC_LAZY_LIMIT (1ll << 31)
+
 typedef struct prime_list {
 	long long prime;
 	long long count;
 } prime_list;
 
+static Value* fracResult(long long n, long long d);
 static Value* fracAdd(const Fraction* a, const Fraction* b);
 static Value* fracSub(const Fraction* a, const Fraction* b);
 static Value* fracMul(const Fraction* a, const Fraction* b);
@@ -32,6 +36,7 @@ static Value* fracMod(const Fraction* a, const Fraction* b);
 static prime_list* factor_primes(long long n, unsigned* count);
 static Value* fracPow(const Fraction* base, const Fraction* exp);
 static int fracCmp(const Fraction* a, const Fraction* b);
+static int quotientCmp(long long a, long long b, long long c, long long d);
 
 
 Fraction* Fraction_new(long long numerator, long long denominator) {
@@ -50,7 +55,10 @@ void Fraction_free(Fraction* frac) {
 }
 
 Fraction* Fraction_copy(const Fraction* frac) {
-	return Fraction_new(frac->n, frac->d);
+	/* Copy as-is, so a lazy fraction stays lazy */
+	Fraction* ret = fmalloc(sizeof(*ret));
+	*ret = *frac;
+	return ret;
 }
 
 void Fraction_simplify(Fraction* frac) {
@@ -60,6 +68,33 @@ void Fraction_simplify(Fraction* frac) {
 	frac->d /= factor;
 }
 
+/*
+ Builds the result of an arithmetic operation without paying for a gcd. The
+ fraction is only simplified once its terms get large enough that the next
+ cross multiplication might overflow. Whole numbers still become integers,
+ which only costs a single division.
+*/
+static Value* fracResult(long long n, long long d) {
+	if(d < 0) {
+		n = -n;
+		d = -d;
+	}
+	
+	if(n % d == 0) {
+		return ValInt(n / d);
+	}
+	
+	Fraction* ret = fmalloc(sizeof(*ret));
+	ret->n = n;
+	ret->d = d;
+	
+	if(UNLIKELY(ABS(n) > FRAC_LAZY_LIMIT || d > FRAC_LAZY_LIMIT)) {
+		Fraction_simplify(ret);
+	}
+	
+	return ValFrac(ret);
+}
+
 void Fraction_reduce(Value* frac) {
 	Fraction* f = frac->frac;
 	Fraction_simplify(f);
@@ -75,10 +110,25 @@ void Fraction_reduce(Value* frac) {
 }
 
 static Value* fracAdd(const Fraction* a, const Fraction* b) {
-	long long n = a->n * b->d + a->d * b->n;
-	long long d = a->d * b->d;
+	long long n, d, an, bn;
+	
+	if(UNLIKELY(mul_overflow(a->n, b->d, &an)
+	|| mul_overflow(a->d, b->n, &bn)
+	|| add_overflow(an, bn, &n)
+	|| mul_overflow(a->d, b->d, &d))) {
+		/* Retry over the least common denominator before giving up on exactness */
+		long long g = gcd(a->d, b->d);
+		if(mul_overflow(a->n, b->d / g, &an)
+		|| mul_overflow(b->n, a->d / g, &bn)
+		|| add_overflow(an, bn, &n)
+		|| mul_overflow(a->d, b->d / g, &d)) {
+			return ValOverflow(Fraction_asReal(a) + Fraction_asReal(b));
+		}
+		
+		return ValFrac(Fraction_new(n, d));
+	}
 	
-	return ValFrac(Fraction_new(n, d));
+	return fracResult(n, d);
 }
 
 Value* Fraction_add(const Fraction* a, const Value* b) {
@@ -91,10 +141,13 @@ Value* Fraction_add(const Fraction* a, const Value* b) {
 			break;
 			
 		case VAL_INT:
-			n = a->n + b->ival * a->d;
+			if(UNLIKELY(mul_overflow(b->ival, a->d, &n) || add_overflow(a->n, n, &n))) {
+				ret = ValOverflow(Fraction_asReal(a) + (double)b->ival);
+				break;
+			}
 			d = a->d;
 			
-			ret = ValFrac(Fraction_new(n, d));
+			ret = fracResult(n, d);
 			break;
 			
 		case VAL_REAL:
@@ -109,10 +162,25 @@ Value* Fraction_add(const Fraction* a, const Value* b) {
 }
 
 static Value* fracSub(const Fraction* a, const Fraction* b) {
-	long long n = a->n * b->d - a->d * b->n;
-	long long d = a->d * b->d;
+	long long n, d, an, bn;
+	
+	if(UNLIKELY(mul_overflow(a->n, b->d, &an)
+	|| mul_overflow(a->d, b->n, &bn)
+	|| sub_overflow(an, bn, &n)
+	|| mul_overflow(a->d, b->d, &d))) {
+		/* Retry over the least common denominator before giving up on exactness */
+		long long g = gcd(a->d, b->d);
+		if(mul_overflow(a->n, b->d / g, &an)
+		|| mul_overflow(b->n, a->d / g, &bn)
+		|| sub_overflow(an, bn, &n)
+		|| mul_overflow(a->d, b->d / g, &d)) {
+			return ValOverflow(Fraction_asReal(a) - Fraction_asReal(b));
+		}
+		
+		return ValFrac(Fraction_new(n, d));
+	}
 	
-	return ValFrac(Fraction_new(n, d));
+	return fracResult(n, d);
 }
 
 Value* Fraction_sub(const Fraction* a, const Value* b) {
@@ -125,10 +193,13 @@ Value* Fraction_sub(const Fraction* a, const Value* b) {
 			break;
 			
 		case VAL_INT:
-			n = a->n - b->ival * a->d;
+			if(UNLIKELY(mul_overflow(b->ival, a->d, &n) || sub_overflow(a->n, n, &n))) {
+				ret = ValOverflow(Fraction_asReal(a) - (double)b->ival);
+				break;
+			}
 			d = a->d;
 			
-			ret = ValFrac(Fraction_new(n, d));
+			ret = fracResult(n, d);
 			break;
 			
 		case VAL_REAL:
@@ -143,10 +214,21 @@ Value* Fraction_sub(const Fraction* a, const Value* b) {
 }
 
 static Value* fracMul(const Fraction* a, const Fraction* b) {
-	long long n = a->n * b->n;
-	long long d = a->d * b->d;
+	long long n, d;
 	
-	return ValFrac(Fraction_new(n, d));
+	if(UNLIKELY(mul_overflow(a->n, b->n, &n) || mul_overflow(a->d, b->d, &d))) {
+		/* Cancel common factors across the two fractions first, then try again */
+		long long g1 = gcd(ABS(a->n), b->d);
+		long long g2 = gcd(ABS(b->n), a->d);
+		if(mul_overflow(a->n / g1, b->n / g2, &n)
+		|| mul_overflow(a->d / g2, b->d / g1, &d)) {
+			return ValOverflow(Fraction_asReal(a) * Fraction_asReal(b));
+		}
+		
+		return ValFrac(Fraction_new(n, d));
+	}
+	
+	return fracResult(n, d);
 }
 
 Value* Fraction_mul(const Fraction* a, const Value* b) {
@@ -159,10 +241,20 @@ Value* Fraction_mul(const Fraction* a, const Value* b) {
 			break;
 			
 		case VAL_INT:
-			n = a->n * b->ival;
-			d = a->d;
+			if(UNLIKELY(mul_overflow(a->n, b->ival, &n))) {
+				/* Only the part of the integer that doesn't cancel with the denominator remains */
+				long long g = gcd(ABS(b->ival), a->d);
+				if(mul_overflow(a->n, b->ival / g, &n)) {
+					ret = ValOverflow(Fraction_asReal(a) * (double)b->ival);
+					break;
+				}
+				d = a->d / g;
+			}
+			else {
+				d = a->d;
+			}
 			
-			ret = ValFrac(Fraction_new(n, d));
+			ret = fracResult(n, d);
 			break;
 			
 		case VAL_REAL:
@@ -177,14 +269,16 @@ Value* Fraction_mul(const Fraction* a, const Value* b) {
 }
 
 static Value* fracDiv(const Fraction* a, const Fraction* b) {
-	long long n = a->n * b->d;
-	long long d = a->d * b->n;
-	
 	if(b->n == 0) {
 		return ValErr(zeroDivError());
 	}
 	
-	return ValFrac(Fraction_new(n, d));
+	/* a / (n/d) is same as a * (d/n) */
+	Fraction recip = {
+		.n = b->n < 0 ? -b->d : b->d,
+		.d = ABS(b->n)
+	};
+	return fracMul(a, &recip);
 }
 
 Value* Fraction_div(const Fraction* a, const Value* b) {
@@ -201,10 +295,19 @@ Value* Fraction_div(const Fraction* a, const Value* b) {
 				return ValErr(zeroDivError());
 			}
 			
-			n = a->n;
-			d = a->d * b->ival;
+			if(UNLIKELY(mul_overflow(a->d, b->ival, &d))) {
+				long long g = gcd(ABS(a->n), ABS(b->ival));
+				if(mul_overflow(a->d, b->ival / g, &d)) {
+					ret = ValOverflow(Fraction_asReal(a) / (double)b->ival);
+					break;
+				}
+				n = a->n / g;
+			}
+			else {
+				n = a->n;
+			}
 			
-			ret = ValFrac(Fraction_new(n, d));
+			ret = fracResult(n, d);
 			break;
 			
 		case VAL_REAL:
@@ -358,16 +461,22 @@ static Value* fracPow(const Fraction* base, const Fraction* exp) {
 	
 	/* c/1 == c */
 	if(exp->d == 1) {
+		bool overflow;
 		if(exp->n < 0) {
-			n = ipow(base->d, -exp->n);
-			d = ipow(base->n, -exp->n);
+			overflow = ipow_overflow(base->d, -exp->n, &n);
+			overflow |= ipow_overflow(base->n, -exp->n, &d);
 		}
 		else {
-			n = ipow(base->n, exp->n);
-			d = ipow(base->d, exp->n);
+			overflow = ipow_overflow(base->n, exp->n, &n);
+			overflow |= ipow_overflow(base->d, exp->n, &d);
 		}
 		
-		ret = ValFrac(Fraction_new(n, d));
+		if(UNLIKELY(overflow)) {
+			ret = ValOverflow(pow(Fraction_asReal(base), (double)exp->n));
+		}
+		else {
+			ret = ValFrac(Fraction_new(n, d));
+		}
 	}
 	else {
 		/*
@@ -379,26 +488,27 @@ static Value* fracPow(const Fraction* base, const Fraction* exp) {
 		
 		/* Initialize coefficient fraction to 1 */
 		n = d = 1;
+		bool overflow = false;
 		
 		/* Simplify the base's numerator */
-		for(i = 0; i < n_count; i++) {
+		for(i = 0; i < n_count && !overflow; i++) {
 			/* Apply the exponent's numerator to each prime */
-			n_primes[i].count *= exp->n;
+			overflow = mul_overflow(n_primes[i].count, exp->n, &n_primes[i].count);
 			
-			/* TODO: Fix hang with "-(3+4!/7)^-(3+43+4!/7)^-(3+433" */
-			while(n_primes[i].count >= exp->d) {
-				n *= n_primes[i].prime;
+			/* Stopping at the first overflow also ends what used to hang on "-(3+4!/7)^-(3+43+4!/7)^-(3+433" */
+			while(!overflow && n_primes[i].count >= exp->d) {
+				overflow = mul_overflow(n, n_primes[i].prime, &n);
 				n_primes[i].count -= exp->d;
 			}
 		}
 		
 		/* Now simplify the base's denominator */
-		for(i = 0; i < d_count; i++) {
+		for(i = 0; i < d_count && !overflow; i++) {
 			/* Apply the exponent's numerator to each prime */
-			d_primes[i].count *= exp->n;
+			overflow = mul_overflow(d_primes[i].count, exp->n, &d_primes[i].count);
 			
-			while(d_primes[i].count >= exp->d) {
-				d *= d_primes[i].prime;
+			while(!overflow && d_primes[i].count >= exp->d) {
+				overflow = mul_overflow(d, d_primes[i].prime, &d);
 				d_primes[i].count -= exp->d;
 			}
 		}
@@ -410,24 +520,34 @@ static Value* fracPow(const Fraction* base, const Fraction* exp) {
 		 reduced completely.
 		*/
 		
-		Value* coef = ValFrac(Fraction_new(n, d));
-		
 		/* Completely reduced? */
 		bool complete = true;
 		long long base_n = 1, base_d = 1;
-		for(i = 0; i < n_count; i++) {
+		for(i = 0; i < n_count && !overflow; i++) {
 			if(n_primes[i].count > 0) {
 				complete = false;
-				base_n *= ipow(n_primes[i].prime, n_primes[i].count);
+				long long factor;
+				overflow = ipow_overflow(n_primes[i].prime, n_primes[i].count, &factor)
+				        || mul_overflow(base_n, factor, &base_n);
 			}
 		}
-		for(i = 0; i < d_count; i++) {
+		for(i = 0; i < d_count && !overflow; i++) {
 			if(d_primes[i].count > 0) {
 				complete = false;
-				base_d *= ipow(d_primes[i].prime, d_primes[i].count);
+				long long factor;
+				overflow = ipow_overflow(d_primes[i].prime, d_primes[i].count, &factor)
+				        || mul_overflow(base_d, factor, &base_d);
 			}
 		}
 		
+		if(UNLIKELY(overflow)) {
+			destroy(n_primes);
+			destroy(d_primes);
+			return ValOverflow(pow(Fraction_asReal(base), Fraction_asReal(exp)));
+		}
+		
+		Value* coef = ValFrac(Fraction_new(n, d));
+		
 		if(complete) {
 			/* Completely reduced, so no MUL or POW */
 			ret = coef;
@@ -473,24 +593,38 @@ static Value* fracPow(const Fraction* base, const Fraction* exp) {
 Value* Fraction_pow(const Fraction* base, const Value* exp) {
 	Value* ret;
 	long long n, d;
+	bool overflow;
+	Fraction reducedExp;
+	
+	/* Powers grow quickly, so start from the fully reduced base */
+	Fraction reduced = *base;
+	Fraction_simplify(&reduced);
+	base = &reduced;
 	
 	switch(exp->type) {
 		case VAL_FRAC:
-			ret = fracPow(base, exp->frac);
+			reducedExp = *exp->frac;
+			Fraction_simplify(&reducedExp);
+			ret = fracPow(base, &reducedExp);
 			break;
 			
 		case VAL_INT:
 			/* (a/b)^-c is same as (b/a)^c */
 			if(exp->ival < 0) {
-				n = ipow(base->d, -exp->ival);
-				d = ipow(base->n, -exp->ival);
+				overflow = ipow_overflow(base->d, -exp->ival, &n);
+				overflow |= ipow_overflow(base->n, -exp->ival, &d);
 			}
 			else {
-				n = ipow(base->n, exp->ival);
-				d = ipow(base->d, exp->ival);
+				overflow = ipow_overflow(base->n, exp->ival, &n);
+				overflow |= ipow_overflow(base->d, exp->ival, &d);
 			}
 			
-			ret = ValFrac(Fraction_new(n, d));
+			if(UNLIKELY(overflow)) {
+				ret = ValOverflow(pow(Fraction_asReal(base), (double)exp->ival));
+			}
+			else {
+				ret = ValFrac(Fraction_new(n, d));
+			}
 			break;
 			
 		case VAL_REAL:
@@ -507,11 +641,18 @@ Value* Fraction_pow(const Fraction* base, const Value* exp) {
 Value* Fraction_rpow(const Fraction* exp, const Value* base) {
 	Value* ret;
 	Fraction* fbase;
+	Fraction reducedBase;
+	
+	Fraction reduced = *exp;
+	Fraction_simplify(&reduced);
+	exp = &reduced;
 	
 	switch(base->type) {
 		case VAL_FRAC:
 			/* Shouldn't happen, but easy to add */
-			ret = fracPow(base->frac, exp);
+			reducedBase = *base->frac;
+			Fraction_simplify(&reducedBase);
+			ret = fracPow(&reducedBase, exp);
 			break;
 			
 		case VAL_INT:
@@ -533,9 +674,51 @@ Value* Fraction_rpow(const Fraction* exp, const Value* base) {
 }
 
 static int fracCmp(const Fraction* a, const Fraction* b) {
-	long long val = a->n * b->d - b->n * a->d;
+	/* Denominators are positive, so cross-multiplying keeps the order */
+	long long an, bn;
+	if(UNLIKELY(mul_overflow(a->n, b->d, &an) || mul_overflow(b->n, a->d, &bn))) {
+		return quotientCmp(a->n, a->d, b->n, b->d);
+	}
 	
-	return (int)CLAMP(val, -1, 1);
+	return (an > bn) - (an < bn);
+}
+
+/*
+ Compares a/b with c/d for positive b and d without overflowing, one term of
+ their continued fractions at a time. A long double can't tell apart every
+ pair of fractions with 64-bit terms.
+*/
+static int quotientCmp(long long a, long long b, long long c, long long d) {
+	while(1) {
+		/* Integer parts, rounded down so the remainders are never negative */
+		long long q1 = a / b;
+		long long r1 = a % b;
+		if(r1 < 0) {
+			r1 += b;
+			q1--;
+		}
+		
+		long long q2 = c / d;
+		long long r2 = c % d;
+		if(r2 < 0) {
+			r2 += d;
+			q2--;
+		}
+		
+		if(q1 != q2) {
+			return q1 > q2 ? 1 : -1;
+		}
+		
+		if(r1 == 0 || r2 == 0) {
+			return (r1 != 0) - (r2 != 0);
+		}
+		
+		/* r1/b > r2/d exactly when d/r2 > b/r1 */
+		a = d;
+		c = b;
+		b = r2;
+		d = r1;
+	}
 }
 
 int Fraction_cmp(const Fraction* a, const Value* b) {
@@ -545,8 +728,13 @@ int Fraction_cmp(const Fraction* a, const Value* b) {
 	
 	switch(b->type) {
 		case VAL_INT:
-			val = a->n - b->ival * a->d;
-			diff = (int)CLAMP(val, -1, 1);
+			if(UNLIKELY(mul_overflow(b->ival, a->d, &val))) {
+				/* |b * d| exceeds any numerator, so the sign of b decides */
+				diff = b->ival < 0 ? 1 : -1;
+			}
+			else {
+				diff = (a->n > val) - (a->n < val);
+			}
 			break;
 		
 		case VAL_FRAC:
@@ -569,9 +757,14 @@ double Fraction_asReal(const Fraction* frac) {
 	return (double)frac->n / (double)frac->d;
 }
 
-char* Fraction_repr(const Fraction* f, bool approx) {
+char* Fraction_repr(const Fraction* frac, bool approx) {
 	char* ret;
 	
+	/* Always print the canonical form, even if this fraction hasn't been reduced yet */
+	Fraction reduced = *frac;
+	Fraction_simplify(&reduced);
+	const Fraction* f = &reduced;
+	
 	if(approx) {
 		asprintf(&ret, "%lld/%lld (%.*g)", f->n, f->d, DBL_DIG, Fraction_asReal(f));
 	}
@@ -595,9 +788,11 @@ char* Fraction_xml(const Fraction* f) {
 	 -6/191
 	*/
 	char* ret;
+	Fraction reduced = *f;
+	Fraction_simplify(&reduced);
 	asprintf(&ret,
 			 "<frac numerator=\"%lld\" denominator=\"%lld\"/>",
-			 f->n, f->d);
+			 reduced.n, reduced.d);
 	return ret;
 }
 
@@ -16,6 +16,12 @@ typedef struct Fraction Fraction;
 
 ASSUME_NONNULL_BEGIN
 
+/*
+ Results of fraction arithmetic are not necessarily in lowest terms, since
+ paying for a gcd after every operation dominates long sums. Fractions are
+ brought to canonical form by Fraction_reduce (via Value_canonicalize) before
+ being stored or printed. A fraction is never a whole number, though.
+*/
 struct Fraction {
 	/* If the fraction's value is negative, the sign will be on the numerator */
 	long long n;
@@ -22,9 +22,10 @@
 #include "function.h"
 #include "builtin.h"
 #include "binop.h"
+#include "template.h"
 
 
-static Value* callVar(const Context* ctx, const char* name, const ArgList* args);
+static Value* callVar(const Context* ctx, const char* name, const ArgList* args, VarCache* _Nullable cache);
 static char* reprFunc(VALTYPE valtype, const char* name, const ArgList* arglist, bool pretty);
 static char* specialRepr(const char* name, const ArgList* arglist, bool pretty);
 static char* verboseFunc(const char* name, const ArgList* arglist, unsigned indent);
@@ -40,7 +41,7 @@ FuncCall* FuncCall_new(Value* func, ArgList* arglist) {
 	return ret;
 }
 
-FuncCall* FuncCall_create(char* name, ArgList* arglist) {
+FuncCall* FuncCall_create(const char* name, ArgList* arglist) {
 	Value* func = ValVar(name);
 	return FuncCall_new(func, arglist);
 }
@@ -59,7 +60,7 @@ FuncCall* FuncCall_copy(const FuncCall* call) {
 	return FuncCall_new(Value_copy(call->func), ArgList_copy(call->arglist));
 }
 
-static Value* callVar(const Context* ctx, const char* name, const ArgList* args) {
+static Value* callVar(const Context* ctx, const char* name, const ArgList* args, VarCache* cache) {
 	Value* ret;
 	
 	bool internal = false;
@@ -68,7 +69,7 @@ static Value* callVar(const Context* ctx, const char* name, const ArgList* args)
 		name++;
 	}
 	
-	Variable* var = Variable_get(ctx, name);
+	Variable* var = cache ? Context_getCached(ctx, name, cache) : Variable_get(ctx, name);
 	if(var == NULL) {
 		return ValErr(varNotFound(name));
 	}
@@ -108,22 +109,28 @@ static Value* callVar(const Context* ctx, const char* name, const ArgList* args)
 }
 
 Value* FuncCall_eval(const FuncCall* call, const Context* ctx) {
-	Value* func;
-	if(call->func->type == VAL_VAR) {
-		func = Value_copy(call->func);
+	/* A template's callable argument, like in map's "@@(@@)", is called by name when it's one */
+	const Value* callee = call->func;
+	if(callee->type == VAL_PLACE) {
+		callee = Template_argument(callee->ph) ?: callee;
 	}
-	else {
-		func = Value_eval(call->func, ctx);
+	
+	/* Functions stored in variables or passed to templates are called where they are */
+	Value* owned = NULL;
+	const Value* func = callee;
+	if(callee->type != VAL_VAR) {
+		func = Value_borrow(call->func, ctx) ?: (owned = Value_eval(call->func, ctx));
 	}
 	
 	if(func->type == VAL_ERR) {
-		return func;
+		return CAST_NONNULL(owned);
 	}
 	
 	Value* ret;
 	switch(func->type) {
 		case VAL_VAR:
-			ret = callVar(ctx, func->name, call->arglist);
+			/* A template's argument names something different each time, so don't cache it */
+			ret = callVar(ctx, func->name, call->arglist, call->func->type == VAL_VAR ? (VarCache*)&call->cache : NULL);
 			break;
 		
 		case VAL_FUNC:
@@ -137,6 +144,7 @@ Value* FuncCall_eval(const FuncCall* call, const Context* ctx) {
 		case VAL_INT:
 		case VAL_REAL:
 		case VAL_FRAC:
+		case VAL_XREAL:
 		case VAL_VEC: {
 			char* repr = Value_repr(call->func, false, false);
 			ret = ValErr(typeError("Value %s is not a callable.", repr));
@@ -148,7 +156,7 @@ Value* FuncCall_eval(const FuncCall* call, const Context* ctx) {
 			badValType(func->type);
 	}
 	
-	Value_free(func);
+	Value_free(owned);
 	return ret;
 }
 
@@ -171,12 +179,8 @@ static char* reprFunc(VALTYPE valtype, const char* callable, const ArgList* argl
 static char* specialRepr(const char* name, const ArgList* arglist, bool pretty) {
 	char* ret;
 	
-	if(strcmp(name, "elem") == 0) {
-		if(arglist->count != 2) {
-			/* Freak out */
-			RAISE(internalError("Invalid argument count passed to internal call of elem"), true);
-		}
-		
+	/* Anything else is printed like a normal call */
+	if(strcmp(name, "elem") == 0 && arglist->count == 2) {
 		char* vec = Value_repr(arglist->args[0], pretty, false);
 		char* index = Value_repr(arglist->args[1], pretty, false);
 		
@@ -237,12 +241,8 @@ static char* verboseFunc(const char* name, const ArgList* arglist, unsigned inde
 static char* specialVerbose(const char* name, const ArgList* arglist, unsigned indent) {
 	char* ret;
 	
-	if(strcmp(name, "elem") == 0) {
-		if(arglist->count != 2) {
-			/* Freak out */
-			RAISE(internalError("Invalid argument count passed to internal call of elem"), true);
-		}
-		
+	/* Anything else is printed like a normal call */
+	if(strcmp(name, "elem") == 0 && arglist->count == 2) {
 		char* vec = Value_verbose(arglist->args[0], indent);
 		char* index = Value_verbose(arglist->args[1], indent + 1);
 		
@@ -24,13 +24,16 @@ ASSUME_NONNULL_BEGIN
 struct FuncCall {
 	OWNED Value* func;
 	OWNED ArgList* arglist;
+	
+	/* Where func was last found when it's a name */
+	VarCache cache;
 };
 
 
 /* Constructor */
 RETURNS_OWNED FuncCall* FuncCall_new(CONSUMED Value* func, CONSUMED ArgList* arglist);
 /* Used to create specific calls like "sqrt" */
-RETURNS_OWNED FuncCall* FuncCall_create(CONSUMED char* name, CONSUMED ArgList* arglist);
+RETURNS_OWNED FuncCall* FuncCall_create(CONSUMED const char* name, CONSUMED ArgList* arglist);
 
 /* Destructor */
 void FuncCall_free(CONSUMED FuncCall* _Nullable call);
@@ -23,6 +23,8 @@
 #endif
 
 #include "supercalc.h"
+#include "symbol.h"
+#include "linereader.h"
 
 #define ICHAR   ' '
 #define IWIDTH  2
@@ -41,49 +43,91 @@ void free_owned(void* ptr) {
 	free(ptr);
 }
 
-char* g_line = NULL;
-unsigned g_lineNumber = 0;
-FILE* g_inputFile = NULL;
-const char* g_inputFileName = "<interactive>";
+/* Used by threads that aren't running any interpreter */
+static _Thread_local InputState _thread_input = {.fileName = "<interactive>"};
+static _Thread_local InputState* _Nullable _current_input = NULL;
+
+void InputState_init(InputState* state) {
+	memset(state, 0, sizeof(*state));
+	state->fileName = "<interactive>";
+}
+
+void InputState_destroy(InputState* state) {
+	LineReader_free(state->stream);
+	state->stream = NULL;
+	state->streamFile = NULL;
+}
+
+InputState* Input_current(void) {
+	return _current_input ?: &_thread_input;
+}
+
+InputState* Input_enter(InputState* state) {
+	InputState* ret = _current_input;
+	_current_input = state;
+	return ret;
+}
+
+/* Reader for the input's file or stdin, rebound whenever the stream changes */
+static LineReader* streamReader(InputState* in, FILE* fp) {
+	if(in->stream == NULL || in->streamFile != fp) {
+		LineReader_free(in->stream);
+		in->stream = LineReader_new(fp);
+		in->streamFile = fp;
+	}
+	
+	return CAST_NONNULL(in->stream);
+}
 
 char* nextLine(const char* prompt) {
+	InputState* in = Input_current();
+	
+	/* Imported files have their own reader */
+	if(in->reader != NULL) {
+		in->line = LineReader_next(in->reader);
+		if(in->line == NULL) {
+			return NULL;
+		}
+		
+		/* Strip trailing comments */
+		in->line = strsep(&in->line, "#\r");
+		++in->lineNumber;
+		return in->line;
+	}
+
 #ifdef WITH_LINENOISE
 	/* Only use linenoise for the interactive prompt, not for imported files */
-	if(g_inputFile == NULL) {
-		destroy(g_line);
-		g_line = linenoise(prompt);
-		if(g_line != NULL) {
-			linenoiseHistoryAdd(g_line);
+	if(in->file == NULL) {
+		destroy(in->line);
+		in->line = linenoise(prompt);
+		if(in->line != NULL) {
+			linenoiseHistoryAdd(in->line);
 		}
 		
 		/* Strip trailing newline and comments */
-		g_line = strsep(&g_line, "#\r\n");
-		++g_lineNumber;
-		return g_line;
+		in->line = strsep(&in->line, "#\r\n");
+		++in->lineNumber;
+		return in->line;
 	}
 #endif /* WITH_LINENOISE */
 	
-	/* Allocate a line buffer if it hasn't been yet */
-	if(g_line == NULL) {
-		g_line = fmalloc(SC_LINE_SIZE);
-	}
-	
 	/* If there is an explicit input file, don't print the prompt for every line */
-	FILE* fp = g_inputFile;
+	FILE* fp = in->file;
 	if(fp == NULL) {
 		printf("%s", prompt);
 		fp = stdin;
 	}
 	
-	/* Read one line from the input stream (file or stdin) */
-	if(fgets(g_line, SC_LINE_SIZE, fp) == NULL) {
+	/* Read one line of any length from the input stream (file or stdin) */
+	in->line = LineReader_next(streamReader(in, fp));
+	if(in->line == NULL) {
 		return NULL;
 	}
 	
-	/* Strip trailing newline and comments */
-	g_line = strsep(&g_line, "#\r\n");
-	++g_lineNumber;
-	return g_line;
+	/* Strip trailing comments */
+	in->line = strsep(&in->line, "#\r");
+	++in->lineNumber;
+	return in->line;
 }
 
 bool isInteractive(FILE* fp) {
@@ -220,40 +264,56 @@ const char* indentation(unsigned level) {
 #undef EIGHT_TIMES
 #undef FIVE_TIMES
 
-long long ipow(long long base, long long exp) {
-	long long result = 1;
+bool ipow_overflow(long long base, long long exp, long long* result) {
+	long long ret = 1;
+	bool overflow = false;
+	
 	while(exp) {
 		if(exp & 1) {
-			result *= base;
+			overflow |= mul_overflow(ret, base, &ret);
 		}
 		
 		exp >>= 1;
-		base *= base;
+		
+		/* Only square when another bit remains so the last square can't spuriously overflow */
+		if(exp) {
+			overflow |= mul_overflow(base, base, &base);
+		}
 	}
-	return result;
+	
+	*result = ret;
+	return overflow;
 }
 
 long long gcd(long long a, long long b) {
 	return b == 0 ? a : gcd(b, a % b);
 }
 
-char* nextSpecial(istring expr) {
+static const char* nextSpecialView(istring expr) {
+	/* Every pretty token is non-ASCII, so plain identifiers can skip the table */
+	if((unsigned char)**expr < 0x80) {
+		return NULL;
+	}
+	
 	unsigned i;
 	for(i = 0; i < ARRSIZE(_pretty_tok); i++) {
 		size_t len = strlen(_pretty_tok[i]);
 		
 		if(strncmp(_pretty_tok[i], *expr, len) == 0) {
 			*expr += len;
-			return strdup(_repr_tok[i]);
+			return _repr_tok[i];
 		}
 	}
 	
 	return NULL;
 }
 
-char* nextToken(istring expr) {
-	size_t len = 1;
-	
+char* nextSpecial(istring expr) {
+	const char* special = nextSpecialView(expr);
+	return special ? strdup(special) : NULL;
+}
+
+const char* nextTokenView(istring expr, size_t* len) {
 	trimSpaces(expr);
 	
 	if(**expr == '\0') {
@@ -267,8 +327,9 @@ char* nextToken(istring expr) {
 		}
 	}
 	
-	char* special = nextSpecial(expr);
+	const char* special = nextSpecialView(expr);
 	if(special) {
+		*len = strlen(special);
 		return special;
 	}
 	
@@ -280,14 +341,26 @@ char* nextToken(istring expr) {
 	}
 	
 	/* Count consecutive number of chars matching [a-zA-Z0-9_'] */
-	while(isalnum(p[len]) || p[len] == '_' || p[len] == '\'') {
-		len++;
+	size_t n = 1;
+	while(isalnum(p[n]) || p[n] == '_' || p[n] == '\'') {
+		n++;
 	}
 	
-	char* ret = strndup(*expr, len);
-	*expr += len;
-	
-	return ret;
+	*expr += n;
+	*len = n;
+	return p;
+}
+
+char* nextToken(istring expr) {
+	size_t len;
+	const char* token = nextTokenView(expr, &len);
+	return token ? strndup(token, len) : NULL;
+}
+
+const char* nextSymbol(istring expr) {
+	size_t len;
+	const char* token = nextTokenView(expr, &len);
+	return token ? Symbol_intern(token, len) : NULL;
 }
 
 int getSign(istring expr) {
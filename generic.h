@@ -54,6 +54,13 @@
 #define HAS_ANY(flags, flag) (((flags) & (flag)) != 0)
 #define ARRSIZE(arr) (sizeof(arr) / sizeof(arr[0]))
 
+/* Modification time of a struct stat as a struct timespec */
+#ifdef __APPLE__
+# define ST_MTIM(st) ((st).st_mtimespec)
+#else
+# define ST_MTIM(st) ((st).st_mtim)
+#endif
+
 
 #include "error.h"
 
@@ -101,12 +108,33 @@ typedef enum {
 
 #define SC_PROMPT_NORMAL   "sc> "
 #define SC_PROMPT_CONTINUE "... "
-#define SC_LINE_SIZE 1000
 
-extern char* _Nullable g_line;
-extern unsigned g_lineNumber;
-extern FILE* _Nullable g_inputFile;
-extern const char* _Nullable g_inputFileName;
+/*
+ Everything about the input an interpreter is reading. Each SuperCalc has its
+ own, which it makes current on whichever thread is running it, so separate
+ interpreters can run on separate threads at once. Parsing outside of any
+ SuperCalc uses a default state that each thread has for itself.
+*/
+typedef struct InputState {
+	/* Line being parsed, its number, and the file it came from */
+	char* _Nullable line;
+	unsigned lineNumber;
+	const char* _Nullable fileName;
+	
+	/* Imported files have their own reader, otherwise lines come from `file` (or stdin when NULL) */
+	struct LineReader* _Nullable reader;
+	FILE* _Nullable file;
+	
+	/* Reader for `file` or stdin, rebound whenever the stream changes */
+	OWNED struct LineReader* _Nullable stream;
+	FILE* _Nullable streamFile;
+	
+	/* When set, decimal literals like 0.1 are parsed exactly as fractions instead of reals */
+	bool exactDecimals;
+	
+	/* Where names are interned, which belongs to the interpreter (NULL to allocate each one) */
+	UNOWNED struct SymbolTable* _Nullable symbols;
+} InputState;
 
 
 ASSUME_NONNULL_BEGIN
@@ -115,9 +143,27 @@ ASSUME_NONNULL_BEGIN
 void trimSpaces(istring str);
 RETURNS_OWNED char* _Nullable nextSpecial(istring expr);
 RETURNS_OWNED char* _Nullable nextToken(istring expr);
+RETURNS_OWNED const char* _Nullable nextSymbol(istring expr);
+
+/*
+ Returns a pointer to the next identifier in the input and its length, without
+ copying it. The view is only valid until the next line of input is read.
+*/
+const char* _Nullable nextTokenView(istring expr, OUT size_t* len);
 int getSign(istring expr);
 
 /* Input */
+void InputState_init(OUT InputState* state);
+
+/* Frees what the state owns, but not the state itself */
+void InputState_destroy(InputState* state);
+
+/* State being read on this thread */
+RETURNS_UNOWNED InputState* Input_current(void);
+
+/* Makes `state` current on this thread (NULL for the thread's own), returning the one it replaced */
+RETURNS_UNOWNED InputState* _Nullable Input_enter(UNOWNED InputState* _Nullable state);
+
 RETURNS_UNOWNED char* _Nullable nextLine(const char* prompt);
 bool isInteractive(FILE* fp);
 VERBOSITY getVerbosity(INOUT UNOWNED istring str);
@@ -127,10 +173,54 @@ const char* _Nullable_unless(name != NULL) getPretty(const char* _Nullable name)
 const char* indentation(unsigned level);
 
 /* Math */
-long long ipow(long long base, long long exp);
+bool ipow_overflow(long long base, long long exp, OUT long long* result);
 long long gcd(long long a, long long b);
 double approx(double real);
 
 ASSUME_NONNULL_END
 
+
+/*
+ Overflow-checked integer arithmetic. Like the compiler builtins they wrap,
+ these store the (possibly wrapped) result and return true on overflow.
+ Callers should test the return value with UNLIKELY() so that the common
+ non-overflowing case compiles down to the plain instruction plus a jump
+ on the overflow flag.
+*/
+#if __has_builtin(__builtin_add_overflow) || (defined(__GNUC__) && __GNUC__ >= 5)
+
+# define add_overflow(a, b, res) __builtin_add_overflow((a), (b), (res))
+# define sub_overflow(a, b, res) __builtin_sub_overflow((a), (b), (res))
+# define mul_overflow(a, b, res) __builtin_mul_overflow((a), (b), (res))
+
+#else /* __builtin_add_overflow */
+
+#include <limits.h>
+
+static inline bool add_overflow(long long a, long long b, long long* _Nonnull res) {
+	*res = (long long)((unsigned long long)a + (unsigned long long)b);
+	return b > 0 ? a > LLONG_MAX - b : a < LLONG_MIN - b;
+}
+
+static inline bool sub_overflow(long long a, long long b, long long* _Nonnull res) {
+	*res = (long long)((unsigned long long)a - (unsigned long long)b);
+	return b < 0 ? a > LLONG_MAX + b : a < LLONG_MIN + b;
+}
+
+static inline bool mul_overflow(long long a, long long b, long long* _Nonnull res) {
+	*res = (long long)((unsigned long long)a * (unsigned long long)b);
+	if(a == 0 || b == 0) {
+		return false;
+	}
+	if(a == -1) {
+		return b == LLONG_MIN;
+	}
+	if(b == -1) {
+		return a == LLONG_MIN;
+	}
+	return *res / b != a;
+}
+
+#endif /* __builtin_add_overflow */
+
 #endif /* SC_GENERIC_H */
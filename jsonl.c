@@ -0,0 +1,517 @@
+/*
+  jsonl.c
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include "jsonl.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <float.h>
+#include <math.h>
+
+#include "generic.h"
+#include "fraction.h"
+#include "vector.h"
+#include "arglist.h"
+#include "ddreal.h"
+
+
+static void skipSpaces(const char** p);
+static bool hexDigits(const char* p, OUT unsigned* result);
+static void putUTF8(SerialWriter* w, unsigned cp);
+static const char* _Nullable parseString(const char** p, SerialWriter* _Nullable decoded);
+static const char* _Nullable parseScalar(const char** p);
+static const char* _Nullable skipValue(const char** p);
+static void putLiteral(SerialWriter* w, const char* str);
+static void putInt(SerialWriter* w, long long x);
+static void putReal(SerialWriter* w, double x, int digits);
+static void putEscaped(SerialWriter* w, const char* str, size_t len);
+static void putValue(SerialWriter* w, const Value* val);
+
+
+static void skipSpaces(const char** p) {
+	while(**p == ' ' || **p == '\t' || **p == '\r' || **p == '\n') {
+		(*p)++;
+	}
+}
+
+static bool hexDigits(const char* p, unsigned* result) {
+	unsigned ret = 0;
+	
+	int i;
+	for(i = 0; i < 4; i++) {
+		char c = p[i];
+		ret <<= 4;
+		if(c >= '0' && c <= '9') {
+			ret |= (unsigned)(c - '0');
+		}
+		else if(c >= 'a' && c <= 'f') {
+			ret |= (unsigned)(c - 'a' + 10);
+		}
+		else if(c >= 'A' && c <= 'F') {
+			ret |= (unsigned)(c - 'A' + 10);
+		}
+		else {
+			return false;
+		}
+	}
+	
+	*result = ret;
+	return true;
+}
+
+static void putUTF8(SerialWriter* w, unsigned cp) {
+	uint8_t buf[4];
+	size_t len;
+	
+	if(cp < 0x80) {
+		buf[0] = (uint8_t)cp;
+		len = 1;
+	}
+	else if(cp < 0x800) {
+		buf[0] = (uint8_t)(0xc0 | (cp >> 6));
+		buf[1] = (uint8_t)(0x80 | (cp & 0x3f));
+		len = 2;
+	}
+	else if(cp < 0x10000) {
+		buf[0] = (uint8_t)(0xe0 | (cp >> 12));
+		buf[1] = (uint8_t)(0x80 | ((cp >> 6) & 0x3f));
+		buf[2] = (uint8_t)(0x80 | (cp & 0x3f));
+		len = 3;
+	}
+	else {
+		buf[0] = (uint8_t)(0xf0 | (cp >> 18));
+		buf[1] = (uint8_t)(0x80 | ((cp >> 12) & 0x3f));
+		buf[2] = (uint8_t)(0x80 | ((cp >> 6) & 0x3f));
+		buf[3] = (uint8_t)(0x80 | (cp & 0x3f));
+		len = 4;
+	}
+	
+	Serial_putBytes(w, buf, len);
+}
+
+/* Scans a string starting at its opening quote, decoding it into `decoded` if given. Returns NULL on success */
+static const char* parseString(const char** p, SerialWriter* decoded) {
+	const char* cur = *p + 1;
+	
+	while(*cur != '"') {
+		const char* run = cur;
+		while(*cur != '"' && *cur != '\\' && (unsigned char)*cur >= 0x20) {
+			cur++;
+		}
+		
+		if(decoded != NULL) {
+			Serial_putBytes(decoded, run, (size_t)(cur - run));
+		}
+		
+		if(*cur == '"') {
+			break;
+		}
+		
+		if(*cur != '\\') {
+			return *cur == '\0' ? "unterminated string" : "control character in string";
+		}
+		
+		char c;
+		unsigned cp;
+		switch(cur[1]) {
+			case '"':  c = '"';  break;
+			case '\\': c = '\\'; break;
+			case '/':  c = '/';  break;
+			case 'b':  c = '\b'; break;
+			case 'f':  c = '\f'; break;
+			case 'n':  c = '\n'; break;
+			case 'r':  c = '\r'; break;
+			case 't':  c = '\t'; break;
+			
+			case 'u':
+				if(!hexDigits(cur + 2, &cp)) {
+					return "bad \\u escape";
+				}
+				cur += 6;
+				
+				/* Characters outside the BMP are sent as a surrogate pair */
+				if(cp >= 0xd800 && cp < 0xdc00) {
+					unsigned low;
+					if(cur[0] != '\\' || cur[1] != 'u' || !hexDigits(cur + 2, &low) || low < 0xdc00 || low >= 0xe000) {
+						return "unpaired surrogate";
+					}
+					
+					cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+					cur += 6;
+				}
+				else if(cp >= 0xdc00 && cp < 0xe000) {
+					return "unpaired surrogate";
+				}
+				
+				if(decoded != NULL) {
+					putUTF8(decoded, cp);
+				}
+				continue;
+			
+			default:
+				return "bad escape";
+		}
+		
+		if(decoded != NULL) {
+			Serial_putU8(decoded, (uint8_t)c);
+		}
+		cur += 2;
+	}
+	
+	*p = cur + 1;
+	return NULL;
+}
+
+/* Skips over a string, number, or literal. Returns NULL on success */
+static const char* parseScalar(const char** p) {
+	const char* cur = *p;
+	
+	if(*cur == '"') {
+		return parseString(p, NULL);
+	}
+	
+	if(*cur == '-' || (*cur >= '0' && *cur <= '9')) {
+		cur++;
+		while((*cur >= '0' && *cur <= '9') || *cur == '.' || *cur == 'e' || *cur == 'E' || *cur == '+' || *cur == '-') {
+			cur++;
+		}
+		
+		*p = cur;
+		return NULL;
+	}
+	
+	static const char* const literals[] = {"null", "true", "false"};
+	
+	unsigned i;
+	for(i = 0; i < ARRSIZE(literals); i++) {
+		size_t len = strlen(literals[i]);
+		if(strncmp(cur, literals[i], len) == 0) {
+			*p = cur + len;
+			return NULL;
+		}
+	}
+	
+	return *cur == '{' || *cur == '[' ? "id must be a scalar" : "expected a value";
+}
+
+static const char* skipValue(const char** p) {
+	if(**p != '{' && **p != '[') {
+		return parseScalar(p);
+	}
+	
+	/* Unknown members may hold anything, so skip over nested objects and arrays */
+	unsigned depth = 0;
+	const char* cur = *p;
+	do {
+		if(*cur == '"') {
+			const char* why = parseString(&cur, NULL);
+			if(why != NULL) {
+				return why;
+			}
+			continue;
+		}
+		
+		if(*cur == '{' || *cur == '[') {
+			depth++;
+		}
+		else if(*cur == '}' || *cur == ']') {
+			depth--;
+		}
+		else if(*cur == '\0') {
+			return "unterminated value";
+		}
+		
+		cur++;
+	} while(depth > 0);
+	
+	*p = cur;
+	return NULL;
+}
+
+Error* Jsonl_parseRequest(const char* line, JsonlRequest* req) {
+	memset(req, 0, sizeof(*req));
+	
+	const char* p = line;
+	const char* why = NULL;
+	SerialWriter key = {0};
+	SerialWriter expr = {0};
+	SerialWriter session = {0};
+	bool haveExpr = false;
+	bool haveSession = false;
+	
+	skipSpaces(&p);
+	if(*p != '{') {
+		return badRequest("expected an object");
+	}
+	p++;
+	skipSpaces(&p);
+	
+	while(why == NULL && *p != '}') {
+		if(*p != '"') {
+			why = "expected a member name";
+			break;
+		}
+		
+		key.len = 0;
+		why = parseString(&p, &key);
+		if(why != NULL) {
+			break;
+		}
+		
+		skipSpaces(&p);
+		if(*p != ':') {
+			why = "expected ':'";
+			break;
+		}
+		p++;
+		skipSpaces(&p);
+		
+		const char* value = p;
+		if(key.len == 2 && memcmp(key.data, "id", 2) == 0) {
+			why = parseScalar(&p);
+			if(why == NULL) {
+				req->id = value;
+				req->idLen = (size_t)(p - value);
+			}
+		}
+		else if(key.len == 4 && memcmp(key.data, "expr", 4) == 0) {
+			if(*p != '"') {
+				why = "expr must be a string";
+				break;
+			}
+			
+			expr.len = 0;
+			why = parseString(&p, &expr);
+			haveExpr = true;
+		}
+		else if(key.len == 7 && memcmp(key.data, "session", 7) == 0) {
+			if(*p != '"') {
+				why = "session must be a string";
+				break;
+			}
+			
+			session.len = 0;
+			why = parseString(&p, &session);
+			haveSession = true;
+		}
+		else {
+			why = skipValue(&p);
+		}
+		
+		skipSpaces(&p);
+		if(*p == ',') {
+			p++;
+			skipSpaces(&p);
+		}
+		else if(*p != '}' && why == NULL) {
+			why = "expected ',' or '}'";
+		}
+	}
+	
+	if(why == NULL) {
+		p++;
+		skipSpaces(&p);
+		if(*p != '\0') {
+			why = "trailing characters after the object";
+		}
+		else if(!haveExpr) {
+			why = "missing expr";
+		}
+		else if(expr.len > 0 && memchr(expr.data, '\0', expr.len) != NULL) {
+			why = "expr contains a NUL character";
+		}
+		else if(session.len > 0 && memchr(session.data, '\0', session.len) != NULL) {
+			why = "session contains a NUL character";
+		}
+	}
+	
+	Serial_freeWriter(&key);
+	
+	if(why != NULL) {
+		Serial_freeWriter(&expr);
+		Serial_freeWriter(&session);
+		return badRequest(why);
+	}
+	
+	Serial_putU8(&expr, '\0');
+	req->expr = (char*)expr.data;
+	
+	if(haveSession) {
+		Serial_putU8(&session, '\0');
+		req->session = (char*)session.data;
+	}
+	
+	return NULL;
+}
+
+void Jsonl_freeRequest(JsonlRequest* req) {
+	destroy(req->expr);
+	destroy(req->session);
+}
+
+static void putLiteral(SerialWriter* w, const char* str) {
+	Serial_putBytes(w, str, strlen(str));
+}
+
+static void putInt(SerialWriter* w, long long x) {
+	/* Formatted by hand, since printf costs more than evaluating a simple expression */
+	char buf[24];
+	char* p = buf + sizeof(buf);
+	unsigned long long u = x < 0 ? 0ull - (unsigned long long)x : (unsigned long long)x;
+	
+	do {
+		*--p = (char)('0' + u % 10);
+		u /= 10;
+	} while(u != 0);
+	
+	if(x < 0) {
+		*--p = '-';
+	}
+	
+	Serial_putBytes(w, p, (size_t)(buf + sizeof(buf) - p));
+}
+
+static void putReal(SerialWriter* w, double x, int digits) {
+	char buf[32];
+	int len = snprintf(buf, sizeof(buf), "%.*g", digits, x);
+	Serial_putBytes(w, buf, (size_t)len);
+}
+
+static void putEscaped(SerialWriter* w, const char* str, size_t len) {
+	static const char hex[] = "0123456789abcdef";
+	
+	size_t i;
+	size_t start = 0;
+	for(i = 0; i < len; i++) {
+		unsigned char c = (unsigned char)str[i];
+		if(c >= 0x20 && c != '"' && c != '\\') {
+			continue;
+		}
+		
+		Serial_putBytes(w, str + start, i - start);
+		start = i + 1;
+		
+		switch(c) {
+			case '"':  putLiteral(w, "\\\""); break;
+			case '\\': putLiteral(w, "\\\\"); break;
+			case '\n': putLiteral(w, "\\n");  break;
+			case '\t': putLiteral(w, "\\t");  break;
+			
+			default: {
+				char esc[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf]};
+				Serial_putBytes(w, esc, sizeof(esc));
+				break;
+			}
+		}
+	}
+	
+	Serial_putBytes(w, str + start, len - start);
+}
+
+/* Writes the same text as Value_repr(val, false, false), without building intermediate strings */
+static void putValue(SerialWriter* w, const Value* val) {
+	switch(val->type) {
+		case VAL_INT:
+			putInt(w, val->ival);
+			return;
+		
+		case VAL_REAL:
+			if(isfinite(val->rval)) {
+				putReal(w, approx(val->rval), DBL_DIG);
+				return;
+			}
+			break;
+		
+		case VAL_FRAC: {
+			Fraction reduced = *val->frac;
+			Fraction_simplify(&reduced);
+			putInt(w, reduced.n);
+			Serial_putU8(w, '/');
+			putInt(w, reduced.d);
+			return;
+		}
+		
+		case VAL_VEC: {
+			const ArgList* vals = val->vec->vals;
+			Serial_putU8(w, '<');
+			
+			unsigned i;
+			for(i = 0; i < vals->count; i++) {
+				if(i > 0) {
+					putLiteral(w, ", ");
+				}
+				putValue(w, vals->args[i]);
+			}
+			
+			Serial_putU8(w, '>');
+			return;
+		}
+		
+		default:
+			break;
+	}
+	
+	/* Everything else is rare enough to go through the usual printing code */
+	char* repr = Value_repr(val, false, false);
+	putEscaped(w, repr, strlen(repr));
+	destroy(repr);
+}
+
+void Jsonl_writeResponse(SerialWriter* w, const JsonlRequest* req, const Value* result) {
+	putLiteral(w, "{\"id\":");
+	if(req->id != NULL) {
+		Serial_putBytes(w, req->id, req->idLen);
+	}
+	else {
+		putLiteral(w, "null");
+	}
+	
+	if(result != NULL && result->type == VAL_ERR) {
+		/* Messages end with a newline, which doesn't belong in the response */
+		const char* msg = result->err->msg;
+		size_t len = strlen(msg);
+		while(len > 0 && msg[len - 1] == '\n') {
+			len--;
+		}
+		
+		putLiteral(w, ",\"value\":null,\"approx\":null,\"error\":\"");
+		putEscaped(w, msg, len);
+		putLiteral(w, "\"}\n");
+		return;
+	}
+	
+	if(result == NULL || result->type == VAL_VAR) {
+		putLiteral(w, ",\"value\":null,\"approx\":null,\"error\":null}\n");
+		return;
+	}
+	
+	putLiteral(w, ",\"value\":\"");
+	putValue(w, result);
+	putLiteral(w, "\",\"approx\":");
+	
+	/* JSON numbers can't be infinite or NaN */
+	double real = Value_asReal(result);
+	if(result->type == VAL_INT) {
+		putInt(w, result->ival);
+	}
+	else if(isfinite(real)) {
+		putReal(w, real, DBL_DECIMAL_DIG);
+	}
+	else {
+		putLiteral(w, "null");
+	}
+	
+	/* Shown as "(overflow)" everywhere else, so the approximate result can't pass for an exact one */
+	if((result->type == VAL_REAL || result->type == VAL_XREAL) && (result->flags & VF_OVERFLOW)) {
+		putLiteral(w, ",\"overflow\":true");
+	}
+	
+	putLiteral(w, ",\"error\":null}\n");
+}
@@ -0,0 +1,50 @@
+/*
+  jsonl.h
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#ifndef SC_JSONL_H
+#define SC_JSONL_H
+
+#include <stddef.h>
+
+#include "value.h"
+#include "error.h"
+#include "serial.h"
+#include "annotations.h"
+
+
+ASSUME_NONNULL_BEGIN
+
+/*
+ JSON lines protocol. Each request is one line holding an object like
+ {"id": 1, "expr": "2 + 2"}, and each response is one line like
+ {"id":1,"value":"4","approx":4,"error":null}. The id can be any JSON
+ scalar and is echoed back exactly as it was sent. A request may also name
+ the "session" it runs in, for servers that keep more than one. Other
+ members of the request are ignored.
+*/
+typedef struct JsonlRequest {
+	/* Raw JSON text of the id, pointing into the request line */
+	const char* _Nullable id;
+	size_t idLen;
+	
+	OWNED char* _Nullable expr;
+	OWNED char* _Nullable session;
+} JsonlRequest;
+
+/* Parsing */
+RETURNS_OWNED Error* _Nullable Jsonl_parseRequest(const char* line, OUT JsonlRequest* req);
+
+/* Frees the strings owned by `req`, but not `req` itself */
+void Jsonl_freeRequest(JsonlRequest* req);
+
+/* Responses are appended to `out`. No result (like after a command) gives a null value */
+void Jsonl_writeResponse(SerialWriter* out, const JsonlRequest* req, const Value* _Nullable result);
+
+ASSUME_NONNULL_END
+
+#endif /* SC_JSONL_H */
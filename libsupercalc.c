@@ -0,0 +1,218 @@
+/*
+  libsupercalc.c
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include "libsupercalc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "supercalc.h"
+#include "error.h"
+#include "generic.h"
+#include "value.h"
+#include "linereader.h"
+#include "prepared.h"
+
+
+struct sc_interp {
+	OWNED SuperCalc* sc;
+	
+	/* Lines are complete on their own, so continuation lines never come from stdin */
+	OWNED LineReader* noInput;
+};
+
+
+struct sc_prepared {
+	UNOWNED sc_interp* interp;
+	OWNED Prepared* prep;
+};
+
+
+static int interp_error(OWNED Error* err, char** error);
+static int interp_result(OWNED Value* _Nullable val, char** result);
+
+
+sc_interp* sc_new(void) {
+	sc_interp* ret = fmalloc(sizeof(*ret));
+	ret->sc = SuperCalc_new();
+	
+	ret->noInput = LineReader_empty();
+	ret->sc->input.reader = ret->noInput;
+	ret->sc->input.file = NULL;
+	ret->sc->input.fileName = NULL;
+	
+	return ret;
+}
+
+void sc_free(sc_interp* interp) {
+	if(!interp) {
+		return;
+	}
+	
+	SuperCalc_free(interp->sc);
+	LineReader_free(interp->noInput);
+	destroy(interp);
+}
+
+static int interp_error(Error* err, char** error) {
+	/* Same as what Error_raise prints, minus the trailing newline */
+	size_t len = strlen(err->msg);
+	if(len > 0 && err->msg[len - 1] == '\n') {
+		len--;
+	}
+	
+	if(err->filename != NULL && err->line > 0) {
+		asprintf(error, "%s:%u: %.*s", err->filename, err->line, (int)len, err->msg);
+	}
+	else {
+		*error = strndup(err->msg, len);
+	}
+	
+	Error_free(err);
+	return -1;
+}
+
+static int interp_result(Value* val, char** result) {
+	*result = NULL;
+	if(val == NULL) {
+		return 0;
+	}
+	
+	int ret = 0;
+	if(val->type == VAL_ERR) {
+		ret = interp_error(val->err, result);
+		val->err = CAST_NONNULL(NULL);
+	}
+	else if(val->type != VAL_VAR) {
+		/* Defining a function has no value to show */
+		*result = Value_repr(val, false, true);
+	}
+	
+	Value_free(val);
+	return ret;
+}
+
+int sc_eval(sc_interp* interp, const char* line, char** result) {
+	/* The line is split up in place while it's parsed */
+	char* code = strdup(line);
+	interp->sc->input.line = code;
+	interp->sc->input.lineNumber = 1;
+	
+	Value* val = SuperCalc_runLine(interp->sc, code, V_NONE);
+	interp->sc->input.line = NULL;
+	destroy(code);
+	
+	return interp_result(val, result);
+}
+
+int sc_import(sc_interp* interp, const char* path, char** error) {
+	*error = NULL;
+	
+	Error* err = SuperCalc_importFile(interp->sc, path);
+	return err != NULL ? interp_error(err, error) : 0;
+}
+
+int sc_set_mode(sc_interp* interp, const char* mode) {
+	return SuperCalc_setMode(interp->sc, mode) ? 0 : -1;
+}
+
+sc_prepared* sc_prepare(sc_interp* interp, const char* expr, char** error) {
+	*error = NULL;
+	
+	Error* err;
+	Prepared* prep = SuperCalc_prepare(interp->sc, expr, &err);
+	if(prep == NULL) {
+		interp_error(CAST_NONNULL(err), error);
+		return NULL;
+	}
+	
+	sc_prepared* ret = fmalloc(sizeof(*ret));
+	ret->interp = interp;
+	ret->prep = prep;
+	return ret;
+}
+
+void sc_prepared_free(sc_prepared* stmt) {
+	if(!stmt) {
+		return;
+	}
+	
+	Prepared_free(stmt->prep);
+	destroy(stmt);
+}
+
+int sc_param_count(const sc_prepared* stmt) {
+	return (int)Prepared_paramCount(stmt->prep);
+}
+
+const char* sc_param_name(const sc_prepared* stmt, int index) {
+	if(index < 0 || index >= sc_param_count(stmt)) {
+		return NULL;
+	}
+	
+	return Prepared_paramName(stmt->prep, (unsigned)index);
+}
+
+int sc_param_index(const sc_prepared* stmt, const char* name) {
+	return Prepared_paramIndex(stmt->prep, name);
+}
+
+int sc_bind_int(sc_prepared* stmt, int index, long long value) {
+	if(index < 0 || index >= sc_param_count(stmt)) {
+		return -1;
+	}
+	
+	Prepared_bind(stmt->prep, (unsigned)index, ValInt(value));
+	return 0;
+}
+
+int sc_bind_double(sc_prepared* stmt, int index, double value) {
+	if(index < 0 || index >= sc_param_count(stmt)) {
+		return -1;
+	}
+	
+	Prepared_bind(stmt->prep, (unsigned)index, ValReal(value));
+	return 0;
+}
+
+int sc_execute(sc_prepared* stmt, char** result) {
+	InputState* old = Input_enter(&stmt->interp->sc->input);
+	Value* val = Prepared_eval(stmt->prep);
+	Input_enter(old);
+	
+	return interp_result(val, result);
+}
+
+int sc_execute_double(sc_prepared* stmt, double* value, char** error) {
+	*value = 0;
+	*error = NULL;
+	
+	InputState* old = Input_enter(&stmt->interp->sc->input);
+	Value* val = Prepared_eval(stmt->prep);
+	Input_enter(old);
+	
+	if(val->type == VAL_ERR) {
+		int ret = interp_error(val->err, error);
+		val->err = CAST_NONNULL(NULL);
+		Value_free(val);
+		return ret;
+	}
+	
+	if(!Value_isNumber(val)) {
+		Value_free(val);
+		return interp_error(typeError("Result is not a number."), error);
+	}
+	
+	*value = Value_asReal(val);
+	Value_free(val);
+	return 0;
+}
+
+void sc_free_string(char* str) {
+	free(str);
+}
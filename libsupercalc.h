@@ -0,0 +1,83 @@
+/*
+  libsupercalc.h
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#ifndef LIBSUPERCALC_H
+#define LIBSUPERCALC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ Public interface of libsupercalc, for embedding the calculator in other
+ programs. This is the only header they need.
+
+ Each interpreter has its own variables, settings and input state. Any number
+ of interpreters can run at once on different threads, but each one must only
+ be used by one thread at a time. Nothing in the library writes to stdout or
+ stderr or exits the process because of a bad expression.
+*/
+typedef struct sc_interp sc_interp;
+
+/* Creates a new interpreter with nothing defined in it */
+sc_interp* sc_new(void);
+
+/* Frees the interpreter and everything defined in it */
+void sc_free(sc_interp* interp);
+
+/*
+ Evaluates one line, exactly like typing it at the prompt. Returns 0 and sets
+ *result to the value's text (or NULL when there is no value, like after a
+ deletion or a command), or returns -1 and sets *result to the error
+ message. A non-NULL *result must be released with sc_free_string.
+*/
+int sc_eval(sc_interp* interp, const char* line, char** result);
+
+/* Imports a file of definitions. On failure, returns -1 and sets *error like sc_eval */
+int sc_import(sc_interp* interp, const char* path, char** error);
+
+/* Sets the numeric mode ("exact", "float" or "extended"), returning -1 if the name is unknown */
+int sc_set_mode(sc_interp* interp, const char* mode);
+
+/*
+ A prepared expression is parsed once and then evaluated any number of times.
+ Every name in it that the interpreter doesn't define when it's prepared is a
+ parameter, numbered from 0 in order of first appearance, which must be bound
+ before evaluating. Bound values are kept until they are bound again. It
+ belongs to its interpreter, so only use it on the thread using that
+ interpreter and free it first.
+*/
+typedef struct sc_prepared sc_prepared;
+
+/* Returns NULL and sets *error (like sc_eval) if the expression doesn't parse */
+sc_prepared* sc_prepare(sc_interp* interp, const char* expr, char** error);
+void sc_prepared_free(sc_prepared* stmt);
+
+/* Parameters, where the name is NULL and the index is -1 for ones that don't exist */
+int sc_param_count(const sc_prepared* stmt);
+const char* sc_param_name(const sc_prepared* stmt, int index);
+int sc_param_index(const sc_prepared* stmt, const char* name);
+
+/* Sets a parameter's value, returning -1 if the index is out of range */
+int sc_bind_int(sc_prepared* stmt, int index, long long value);
+int sc_bind_double(sc_prepared* stmt, int index, double value);
+
+/* Evaluates with the bound values, returning the result like sc_eval */
+int sc_execute(sc_prepared* stmt, char** result);
+
+/* Like sc_execute, but for results that are numbers, which are stored in *value */
+int sc_execute_double(sc_prepared* stmt, double* value, char** error);
+
+/* Releases a string returned by the library */
+void sc_free_string(char* str);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LIBSUPERCALC_H */
@@ -0,0 +1,314 @@
+/*
+  linereader.c
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include "linereader.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifndef _MSC_VER
+# include <fcntl.h>
+# include <unistd.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+#endif
+
+#include "generic.h"
+
+
+/* Amount read from a descriptor at once */
+#define LINEREADER_BLOCK_SIZE (64 * 1024)
+
+struct LineReader {
+	/* Stream being read, or NULL when reading a mapped file */
+	FILE* _Nullable fp;
+	bool ownsFile;
+	
+	/* Mapped file (or memory buffer) contents and the offset of the next line */
+	char* _Nullable map;
+	size_t mapSize;
+	size_t pos;
+	bool ownsMap;
+	bool hitEnd;
+	
+	/* Line buffer for streams, and for a mapped file's last line if it has no newline */
+	char* _Nullable buf;
+	size_t cap;
+	
+	/* Descriptor read in large blocks, or -1. Lines are the bytes buf[start:end] */
+	int fd;
+	size_t start;
+	size_t end;
+};
+
+
+static char* nextMapped(LineReader* reader);
+static char* nextStreamed(LineReader* reader);
+static char* nextBlock(LineReader* reader);
+
+
+LineReader* LineReader_new(FILE* fp) {
+	LineReader* ret = fmalloc(sizeof(*ret));
+	ret->fp = fp;
+	ret->fd = -1;
+	return ret;
+}
+
+LineReader* LineReader_open(const char* filename) {
+#ifdef _MSC_VER
+	FILE* fp = fopen(filename, "r");
+	if(fp == NULL) {
+		return NULL;
+	}
+	
+	LineReader* ret = LineReader_new(fp);
+	ret->ownsFile = true;
+	return ret;
+#else /* _MSC_VER */
+	int fd = open(filename, O_RDONLY);
+	if(fd < 0) {
+		return NULL;
+	}
+	
+	struct stat st;
+	if(fstat(fd, &st) != 0) {
+		close(fd);
+		return NULL;
+	}
+	
+	if(S_ISDIR(st.st_mode)) {
+		close(fd);
+		errno = EISDIR;
+		return NULL;
+	}
+	
+	LineReader* ret = fmalloc(sizeof(*ret));
+	ret->fd = -1;
+	
+	if(!S_ISREG(st.st_mode)) {
+		/* Pipes and devices can't be mapped, so stream them instead */
+		ret->fp = fdopen(fd, "r");
+		ret->ownsFile = true;
+		return ret;
+	}
+	
+	if(st.st_size > 0) {
+		/* Private and writable so lines can be terminated in place without touching the file */
+		void* map = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		if(map == MAP_FAILED) {
+			int err = errno;
+			close(fd);
+			destroy(ret);
+			errno = err;
+			return NULL;
+		}
+		
+		madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+		ret->map = map;
+		ret->mapSize = (size_t)st.st_size;
+		ret->ownsMap = true;
+	}
+	
+	close(fd);
+	return ret;
+#endif /* _MSC_VER */
+}
+
+LineReader* LineReader_fromFd(int fd) {
+#ifdef _MSC_VER
+	return LineReader_new(_fdopen(fd, "r"));
+#else /* _MSC_VER */
+	LineReader* ret = fmalloc(sizeof(*ret));
+	ret->fd = -1;
+	
+	/* Map regular files, starting from wherever the descriptor currently is */
+	struct stat st;
+	off_t offset = lseek(fd, 0, SEEK_CUR);
+	if(fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && offset >= 0 && st.st_size > offset) {
+		void* map = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		if(map != MAP_FAILED) {
+			madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+			ret->map = map;
+			ret->mapSize = (size_t)st.st_size;
+			ret->pos = (size_t)offset;
+			ret->ownsMap = true;
+			return ret;
+		}
+	}
+	
+	ret->fd = fd;
+	return ret;
+#endif /* _MSC_VER */
+}
+
+LineReader* LineReader_fromMemory(char* data, size_t len) {
+	LineReader* ret = fmalloc(sizeof(*ret));
+	ret->fd = -1;
+	ret->map = data;
+	ret->mapSize = len;
+	return ret;
+}
+
+LineReader* LineReader_empty(void) {
+	static char empty[1];
+	return LineReader_fromMemory(empty, 0);
+}
+
+void LineReader_free(LineReader* reader) {
+	if(!reader) {
+		return;
+	}
+
+#ifndef _MSC_VER
+	if(reader->ownsMap && reader->map != NULL) {
+		munmap(reader->map, reader->mapSize);
+	}
+#endif
+	
+	if(reader->ownsFile && reader->fp != NULL) {
+		fclose(reader->fp);
+	}
+	
+	free(reader->buf);
+	destroy(reader);
+}
+
+static char* nextMapped(LineReader* reader) {
+	if(reader->pos >= reader->mapSize) {
+		return NULL;
+	}
+	
+	char* line = reader->map + reader->pos;
+	size_t left = reader->mapSize - reader->pos;
+	
+	char* newline = memchr(line, '\n', left);
+	if(newline != NULL) {
+		*newline = '\0';
+		reader->pos += (size_t)(newline - line) + 1;
+		return line;
+	}
+	
+	/* The last line has no newline, and the mapping may have no room for a terminator */
+	reader->pos = reader->mapSize;
+	if(left + 1 > reader->cap) {
+		reader->cap = left + 1;
+		reader->buf = frealloc(reader->buf, reader->cap);
+	}
+	
+	memcpy(reader->buf, line, left);
+	reader->buf[left] = '\0';
+	return reader->buf;
+}
+
+static char* nextStreamed(LineReader* reader) {
+	/* getline grows the buffer geometrically, so long lines cost amortized linear time */
+	ssize_t len = getline(&reader->buf, &reader->cap, reader->fp);
+	if(len < 0) {
+		return NULL;
+	}
+	
+	if(len > 0 && reader->buf[len - 1] == '\n') {
+		reader->buf[len - 1] = '\0';
+	}
+	
+	return reader->buf;
+}
+
+static char* nextBlock(LineReader* reader) {
+#ifdef _MSC_VER
+	UNREFERENCED_PARAMETER(reader);
+	return NULL;
+#else /* _MSC_VER */
+	size_t scanned = reader->start;
+	
+	while(true) {
+		char* line = reader->buf + reader->start;
+		char* newline = reader->end > scanned ? memchr(reader->buf + scanned, '\n', reader->end - scanned) : NULL;
+		if(newline != NULL) {
+			*newline = '\0';
+			reader->start = (size_t)(newline - reader->buf) + 1;
+			return line;
+		}
+		
+		/* Move the partial line to the front, then make room for at least another block */
+		size_t partial = reader->end - reader->start;
+		if(reader->start > 0) {
+			memmove(reader->buf, line, partial);
+			reader->start = 0;
+			reader->end = partial;
+		}
+		
+		size_t want = partial + LINEREADER_BLOCK_SIZE;
+		if(reader->cap < want) {
+			reader->cap = MAX(reader->cap * 2, want);
+			reader->buf = frealloc(reader->buf, reader->cap);
+		}
+		
+		scanned = reader->end;
+		
+		ssize_t len;
+		do {
+			/* Leave a byte for terminating a last line that has no newline */
+			len = read(reader->fd, reader->buf + reader->end, reader->cap - reader->end - 1);
+		} while(len < 0 && errno == EINTR);
+		
+		if(len <= 0) {
+			if(partial == 0) {
+				return NULL;
+			}
+			
+			reader->buf[reader->end] = '\0';
+			reader->start = reader->end;
+			return reader->buf;
+		}
+		
+		reader->end += (size_t)len;
+	}
+#endif /* _MSC_VER */
+}
+
+char* LineReader_next(LineReader* reader) {
+	char* ret;
+	if(reader->fp != NULL) {
+		ret = nextStreamed(reader);
+	}
+	else if(reader->fd >= 0) {
+		ret = nextBlock(reader);
+	}
+	else {
+		ret = nextMapped(reader);
+	}
+	
+	if(ret == NULL) {
+		reader->hitEnd = true;
+	}
+	
+	return ret;
+}
+
+bool LineReader_hasLine(const LineReader* reader) {
+	if(reader->fp != NULL) {
+		/* Can't see into the stream's buffer */
+		return false;
+	}
+	
+	if(reader->fd >= 0) {
+		return reader->end > reader->start && memchr(reader->buf + reader->start, '\n', reader->end - reader->start) != NULL;
+	}
+	
+	return true;
+}
+
+bool LineReader_hitEnd(const LineReader* reader) {
+	return reader->hitEnd;
+}
+
+size_t LineReader_offset(const LineReader* reader) {
+	return reader->pos;
+}
@@ -0,0 +1,56 @@
+/*
+  linereader.h
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#ifndef SC_LINEREADER_H
+#define SC_LINEREADER_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "annotations.h"
+
+
+ASSUME_NONNULL_BEGIN
+
+/*
+ Reads lines of any length. Streams are read into a buffer that grows as
+ needed, while regular files are mapped into memory and each line is
+ terminated in place, so importing a file doesn't copy it line by line.
+ A reader for a descriptor that can't be mapped, like a pipe, reads it in
+ large blocks and splits those into lines.
+*/
+typedef struct LineReader LineReader;
+
+/* Constructors */
+RETURNS_OWNED LineReader* LineReader_new(UNOWNED FILE* fp);
+RETURNS_OWNED LineReader* _Nullable LineReader_open(const char* filename);
+RETURNS_OWNED LineReader* LineReader_fromFd(int fd);
+RETURNS_OWNED LineReader* LineReader_fromMemory(UNOWNED char* data, size_t len);
+
+/* A reader without any lines, for input that must never read a continuation line */
+RETURNS_OWNED LineReader* LineReader_empty(void);
+
+/* Destructor */
+void LineReader_free(CONSUMED LineReader* _Nullable reader);
+
+/* Returns the next line without its newline, valid until the next call (or forever if mapped) */
+RETURNS_UNOWNED char* _Nullable LineReader_next(LineReader* reader);
+
+/* Whether LineReader_next can return a line without waiting for more input */
+bool LineReader_hasLine(const LineReader* reader);
+
+/* Whether LineReader_next has run out of input */
+bool LineReader_hitEnd(const LineReader* reader);
+
+/* Number of bytes of a memory buffer that have been consumed so far */
+size_t LineReader_offset(const LineReader* reader);
+
+ASSUME_NONNULL_END
+
+#endif /* SC_LINEREADER_H */
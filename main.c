@@ -8,30 +8,258 @@
 
 #include "supercalc.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
+#include <getopt.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <errno.h>
+
+#include "server.h"
 
 #define PROFILING 0
 
+static Server* _Nullable g_server = NULL;
+
+static void stopServer(int sig) {
+	UNREFERENCED_PARAMETER(sig);
+	if(g_server != NULL) {
+		Server_stop(g_server);
+	}
+}
+
+static int serve(SuperCalc* sc, const char* path) {
+	/* By default, one thread per processor */
+	unsigned threads = sc->jobs;
+	if(threads == 0) {
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = cpus > 0 ? (unsigned)cpus : 1;
+	}
+	
+	Error* err;
+	g_server = Server_new(sc, path, threads, &err);
+	if(g_server == NULL) {
+		Error_raise(CAST_NONNULL(err), false);
+		Error_free(err);
+		return 1;
+	}
+	
+	struct sigaction sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = &stopServer;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+	
+	Server_run(g_server);
+	
+	Server* server = g_server;
+	g_server = NULL;
+	Server_free(server);
+	return 0;
+}
+
+static int runPrepared(SuperCalc* sc, const char* expr, const char* _Nullable csvPath) {
+	int fd = STDIN_FILENO;
+	if(csvPath != NULL) {
+		fd = open(csvPath, O_RDONLY | O_CLOEXEC);
+		if(fd < 0) {
+			fprintf(stderr, "%s: %s\n", csvPath, strerror(errno));
+			return 1;
+		}
+	}
+	
+	/* Exit with failure if any row had an error */
+	int status = SuperCalc_runCsv(sc, expr, fd, stdout) == 0 ? 0 : 1;
+	
+	if(fd != STDIN_FILENO) {
+		close(fd);
+	}
+	return status;
+}
+
+static void usage(const char* prog) {
+	fprintf(stderr,
+		"Usage: %s [options] [file ...]\n"
+		"\n"
+		"Imports each file in order, then reads statements from stdin.\n"
+		"\n"
+		"Options:\n"
+		"  --float     Use floating point values instead of fractions\n"
+		"  --extended  Use double-double (~32 digit) values instead of doubles\n"
+		"  --exact-decimals\n"
+		"              Read decimal literals like 0.1 as exact fractions\n"
+		"  --no-compile\n"
+		"              Don't save or load compiled .scc copies of imported files\n"
+		"  --batch     Read statements from stdin as fast as possible, writing one\n"
+		"              line per result: LINE<tab>=<tab>VALUE or LINE<tab>!<tab>ERROR\n"
+		"  --jobs N    Like --batch, but evaluate lines that don't assign anything on\n"
+		"              N threads at once\n"
+		"  --jsonl     Read requests like {\"id\": 1, \"expr\": \"2 + 2\"} from stdin, one\n"
+		"              per line, and answer each with a line of JSON\n"
+		"  --serve PATH\n"
+		"              Answer --jsonl requests from any number of clients on the\n"
+		"              Unix socket PATH, sharing the imported files between their\n"
+		"              sessions and running up to --jobs sessions at once\n"
+		"  --prepare EXPR\n"
+		"              Evaluate EXPR once per row of CSV read from stdin (or the\n"
+		"              --bind-csv file), binding each name EXPR uses that isn't\n"
+		"              defined to the column with that name in the header row.\n"
+		"              Results are written like --batch\n"
+		"  --bind-csv FILE\n"
+		"              Read the --prepare rows from FILE\n"
+		"  --load-snapshot FILE\n"
+		"              Start from a session saved with `save \"FILE\"`\n"
+		"  --save-snapshot FILE\n"
+		"              After importing the files, save the session to FILE\n"
+		"  --help      Show this message\n",
+		prog);
+}
+
 int main(int argc, char** argv) {
 #if PROFILING
 	sleep(1);
 #endif /* PROFILING */
 	
+	static const struct option longopts[] = {
+		{"float",    no_argument, NULL, 'f'},
+		{"extended", no_argument, NULL, 'x'},
+		{"exact-decimals", no_argument, NULL, 'd'},
+		{"no-compile", no_argument, NULL, 'n'},
+		{"batch",    no_argument, NULL, 'b'},
+		{"jobs",     required_argument, NULL, 'j'},
+		{"jsonl",    no_argument, NULL, 'J'},
+		{"serve",    required_argument, NULL, 'S'},
+		{"prepare",  required_argument, NULL, 'p'},
+		{"bind-csv", required_argument, NULL, 'c'},
+		{"load-snapshot", required_argument, NULL, 'l'},
+		{"save-snapshot", required_argument, NULL, 's'},
+		{"help",     no_argument, NULL, 'h'},
+		{NULL, 0, NULL, 0}
+	};
+	
 	SuperCalc* sc = SuperCalc_new();
+	sc->compileImports = true;
 	
-	if(argc > 1) {
-		int i;
-		for(i = 1; i < argc; i++) {
-			Error* err = SuperCalc_importFile(sc, argv[i]);
-			if(err != NULL) {
-				Error_raise(err, true);
-				UNREACHABLE;
+	const char* saveSnapshot = NULL;
+	bool batch = false;
+	bool jsonl = false;
+	const char* servePath = NULL;
+	const char* prepared = NULL;
+	const char* csvPath = NULL;
+	Error* err;
+	int opt;
+	while((opt = getopt_long(argc, argv, "", longopts, NULL)) != -1) {
+		switch(opt) {
+			case 'f':
+				SuperCalc_setMode(sc, "float");
+				break;
+			
+			case 'x':
+				SuperCalc_setMode(sc, "extended");
+				break;
+			
+			case 'd':
+				SuperCalc_setDecimals(sc, "exact");
+				break;
+			
+			case 'n':
+				sc->compileImports = false;
+				break;
+			
+			case 'b':
+				batch = true;
+				break;
+			
+			case 'j': {
+				batch = true;
+				sc->jobs = (unsigned)strtoul(optarg, NULL, 10);
+				
+				/* More threads than processors just take turns, which is slower than one thread */
+				long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+				if(cpus > 0 && sc->jobs > (unsigned long)cpus) {
+					sc->jobs = (unsigned)cpus;
+				}
+				break;
 			}
+			
+			case 'J':
+				jsonl = true;
+				break;
+			
+			case 'S':
+				servePath = optarg;
+				break;
+			
+			case 'p':
+				prepared = optarg;
+				break;
+			
+			case 'c':
+				csvPath = optarg;
+				break;
+			
+			case 'l':
+				/* Loaded right away, so options after it can still change the mode */
+				err = SuperCalc_loadSnapshot(sc, optarg);
+				if(err != NULL) {
+					Error_raise(err, true);
+					UNREACHABLE;
+				}
+				break;
+			
+			case 's':
+				saveSnapshot = optarg;
+				break;
+			
+			case 'h':
+				usage(argv[0]);
+				SuperCalc_free(sc);
+				return 0;
+			
+			default:
+				usage(argv[0]);
+				SuperCalc_free(sc);
+				return 1;
+		}
+	}
+	
+	int i;
+	for(i = optind; i < argc; i++) {
+		err = SuperCalc_importFile(sc, argv[i]);
+		if(err != NULL) {
+			Error_raise(err, true);
+			UNREACHABLE;
+		}
+	}
+	
+	if(saveSnapshot != NULL) {
+		err = SuperCalc_saveSnapshot(sc, saveSnapshot);
+		if(err != NULL) {
+			Error_raise(err, true);
+			UNREACHABLE;
 		}
 	}
 	
+	int status = 0;
+	
 #if !PROFILING
-	SuperCalc_run(sc);
+	if(servePath != NULL) {
+		status = serve(sc, servePath);
+	}
+	else if(prepared != NULL) {
+		status = runPrepared(sc, prepared, csvPath);
+	}
+	else if(jsonl) {
+		SuperCalc_runJsonl(sc, STDIN_FILENO, stdout);
+	}
+	else if(batch) {
+		/* Exit with failure if any line had an error */
+		status = SuperCalc_runBatch(sc, STDIN_FILENO, stdout) == 0 ? 0 : 1;
+	}
+	else {
+		SuperCalc_run(sc);
+	}
 #endif /* PROFILING */
 	
 	SuperCalc_free(sc);
@@ -39,5 +267,5 @@ int main(int argc, char** argv) {
 #if PROFILING
 	sleep(10);
 #endif /* PROFILING */
-	return 0;
+	return status;
 }
@@ -0,0 +1,136 @@
+/*
+  modint.c
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include "modint.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "generic.h"
+
+
+typedef unsigned __int128 uint128_t;
+
+static uint64_t redc(const ModRing* ring, uint128_t t);
+static uint64_t toMont(const ModRing* ring, uint64_t a);
+static uint64_t montMul(const ModRing* ring, uint64_t a, uint64_t b);
+
+
+void ModRing_init(ModRing* ring, uint64_t m) {
+	assert(m >= 1 && m < (1ull << 63));
+	
+	ring->m = m;
+	ring->mont = (m & 1) != 0;
+	ring->ninv = 0;
+	ring->r2 = 0;
+	
+	if(ring->mont) {
+		/* Newton's iteration doubles the number of correct low bits each step, starting from 3 */
+		uint64_t inv = m;
+		int i;
+		for(i = 0; i < 5; i++) {
+			inv *= 2 - m * inv;
+		}
+		
+		ring->ninv = -inv;
+		
+		uint64_t r = (uint64_t)(((uint128_t)1 << 64) % m);
+		ring->r2 = (uint64_t)((uint128_t)r * r % m);
+	}
+}
+
+/* Montgomery reduction: t * 2^-64 mod m, for t < m * 2^64 */
+static uint64_t redc(const ModRing* ring, uint128_t t) {
+	uint64_t q = (uint64_t)t * ring->ninv;
+	
+	/* Since m < 2^63, the sum can't overflow 128 bits and the result is below 2m */
+	uint64_t ret = (uint64_t)((t + (uint128_t)q * ring->m) >> 64);
+	return ret >= ring->m ? ret - ring->m : ret;
+}
+
+static uint64_t toMont(const ModRing* ring, uint64_t a) {
+	return redc(ring, (uint128_t)a * ring->r2);
+}
+
+static uint64_t montMul(const ModRing* ring, uint64_t a, uint64_t b) {
+	return redc(ring, (uint128_t)a * b);
+}
+
+uint64_t ModRing_reduce(const ModRing* ring, long long a) {
+	if(a >= 0) {
+		return (uint64_t)a % ring->m;
+	}
+	
+	/* Negate as unsigned so LLONG_MIN is handled */
+	uint64_t r = (0ull - (uint64_t)a) % ring->m;
+	return r == 0 ? 0 : ring->m - r;
+}
+
+uint64_t ModRing_mul(const ModRing* ring, uint64_t a, uint64_t b) {
+	if(ring->mont) {
+		/* (a * b * R^-1) * R^2 * R^-1 = a * b */
+		return montMul(ring, montMul(ring, a, b), ring->r2);
+	}
+	
+	return (uint64_t)((uint128_t)a * b % ring->m);
+}
+
+uint64_t ModRing_pow(const ModRing* ring, uint64_t base, unsigned long long exp) {
+	if(!ring->mont) {
+		uint64_t ret = 1 % ring->m;
+		while(exp > 0) {
+			if(exp & 1) {
+				ret = ModRing_mul(ring, ret, base);
+			}
+			base = ModRing_mul(ring, base, base);
+			exp >>= 1;
+		}
+		return ret;
+	}
+	
+	/* Stay in Montgomery form for the whole square-and-multiply loop */
+	uint64_t x = toMont(ring, base);
+	uint64_t ret = toMont(ring, 1 % ring->m);
+	while(exp > 0) {
+		if(exp & 1) {
+			ret = montMul(ring, ret, x);
+		}
+		x = montMul(ring, x, x);
+		exp >>= 1;
+	}
+	
+	return redc(ring, ret);
+}
+
+bool ModRing_inv(const ModRing* ring, uint64_t a, uint64_t* result) {
+	/* Extended Euclidean algorithm, only tracking the coefficient of a */
+	long long r0 = (long long)ring->m;
+	long long r1 = (long long)a;
+	long long t0 = 0;
+	long long t1 = 1;
+	
+	while(r1 != 0) {
+		long long q = r0 / r1;
+		long long tmp;
+		
+		tmp = r0 - q * r1;
+		r0 = r1;
+		r1 = tmp;
+		
+		tmp = t0 - q * t1;
+		t0 = t1;
+		t1 = tmp;
+	}
+	
+	/* Only invertible when gcd(a, m) == 1 */
+	if(r0 != 1) {
+		return false;
+	}
+	
+	*result = ModRing_reduce(ring, t0);
+	return true;
+}
@@ -0,0 +1,46 @@
+/*
+  modint.h
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#ifndef SC_MODINT_H
+#define SC_MODINT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "annotations.h"
+
+
+ASSUME_NONNULL_BEGIN
+
+/*
+ The ring of integers modulo m, for 1 <= m < 2^63. Residues passed in and out
+ are always canonical (0 <= r < m). Odd moduli use Montgomery multiplication,
+ so a modular product is a few 64-bit multiplies and no division. Even moduli
+ fall back to taking a 128-bit remainder.
+*/
+typedef struct ModRing {
+	uint64_t m;
+	uint64_t ninv; /* -m^-1 mod 2^64 */
+	uint64_t r2;   /* 2^128 mod m */
+	bool mont;
+} ModRing;
+
+/* Setup */
+void ModRing_init(OUT ModRing* ring, INVARIANT(m >= 1) uint64_t m);
+
+/* Conversion */
+uint64_t ModRing_reduce(const ModRing* ring, long long a);
+
+/* Arithmetic */
+uint64_t ModRing_mul(const ModRing* ring, uint64_t a, uint64_t b);
+uint64_t ModRing_pow(const ModRing* ring, uint64_t base, unsigned long long exp);
+bool ModRing_inv(const ModRing* ring, uint64_t a, OUT uint64_t* result);
+
+ASSUME_NONNULL_END
+
+#endif /* SC_MODINT_H */
@@ -0,0 +1,367 @@
+/*
+  parser.c
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include "parser.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <ctype.h>
+
+#include "error.h"
+#include "generic.h"
+#include "statement.h"
+#include "stmtcache.h"
+#include "linereader.h"
+#include "variable.h"
+#include "value.h"
+
+
+struct Parser {
+	/* Input that hasn't been parsed yet is buf[start:len] */
+	char* _Nullable buf;
+	size_t start;
+	size_t len;
+	size_t cap;
+	
+	/* Copy of the lines being parsed, since they are terminated in place */
+	char* _Nullable scratch;
+	size_t scratchCap;
+	
+	/*
+	 When the pending line continued past all complete lines, this is how many
+	 were offered and their size. It isn't parsed again until another line
+	 arrives.
+	*/
+	unsigned waitLines;
+	size_t waitSize;
+	
+	/* Set when more than one line is offered, since the first one is known to continue */
+	bool continued;
+	
+	OWNED char* _Nullable name;
+	unsigned lineNumber;
+	bool finished;
+	bool verbosity;
+	UNOWNED StmtCache* _Nullable cache;
+};
+
+
+static size_t endOfLines(const Parser* parser, unsigned count);
+static bool parseRegion(Parser* parser, size_t size, OUT ParsedLine* line, OUT bool* ranOut, OUT size_t* used, OUT unsigned* lineNumber);
+static void parseStatement(Parser* parser, const char* p, OUT ParsedLine* line);
+static bool parseCommand(const char* p, OUT ParsedLine* line);
+
+
+Parser* Parser_new(const char* name) {
+	Parser* ret = fmalloc(sizeof(*ret));
+	ret->name = name ? strdup(name) : NULL;
+	return ret;
+}
+
+void Parser_free(Parser* parser) {
+	if(!parser) {
+		return;
+	}
+	
+	destroy(parser->buf);
+	destroy(parser->scratch);
+	destroy(parser->name);
+	destroy(parser);
+}
+
+void Parser_allowVerbosity(Parser* parser) {
+	parser->verbosity = true;
+}
+
+void Parser_useCache(Parser* parser, StmtCache* cache) {
+	parser->cache = cache;
+}
+
+void Parser_feed(Parser* parser, const char* data, size_t len) {
+	/* Reclaim the space used by already parsed input before growing */
+	if(parser->start > 0) {
+		memmove(parser->buf, parser->buf + parser->start, parser->len - parser->start);
+		parser->len -= parser->start;
+		parser->start = 0;
+	}
+	
+	if(parser->len + len > parser->cap) {
+		parser->cap = MAX(parser->cap * 2, parser->len + len);
+		parser->buf = frealloc(parser->buf, parser->cap);
+	}
+	
+	memcpy(parser->buf + parser->len, data, len);
+	parser->len += len;
+}
+
+void Parser_finish(Parser* parser) {
+	parser->finished = true;
+}
+
+bool Parser_hasPending(const Parser* parser) {
+	return parser->len > parser->start;
+}
+
+/* Size of the first `count` complete lines of pending input (plus a trailing partial line once finished) */
+static size_t endOfLines(const Parser* parser, unsigned count) {
+	const char* begin = parser->buf + parser->start;
+	const char* end = parser->buf + parser->len;
+	const char* cur = begin;
+	
+	while(count-- > 0 && cur < end) {
+		const char* newline = memchr(cur, '\n', (size_t)(end - cur));
+		if(newline == NULL) {
+			/* A partial line is only complete once no more input is coming */
+			if(parser->finished) {
+				cur = end;
+			}
+			break;
+		}
+		
+		cur = newline + 1;
+	}
+	
+	return (size_t)(cur - begin);
+}
+
+static bool parseRegion(Parser* parser, size_t size, ParsedLine* line, bool* ranOut, size_t* used, unsigned* lineNumber) {
+	if(size + 1 > parser->scratchCap) {
+		parser->scratchCap = size + 1;
+		parser->scratch = frealloc(parser->scratch, parser->scratchCap);
+	}
+	
+	memcpy(parser->scratch, parser->buf + parser->start, size);
+	parser->scratch[size] = '\0';
+	LineReader* reader = LineReader_fromMemory(parser->scratch, size);
+	
+	/* Read from this parser's buffer, keeping the current settings */
+	InputState input;
+	InputState_init(&input);
+	input.lineNumber = parser->lineNumber;
+	input.reader = reader;
+	input.fileName = parser->name;
+	input.exactDecimals = Input_current()->exactDecimals;
+	input.symbols = Input_current()->symbols;
+	InputState* old = Input_enter(&input);
+	
+	bool ret = false;
+	char* text = nextLine("");
+	if(text != NULL) {
+		const char* p = text;
+		VERBOSITY v = parser->verbosity ? getVerbosity(&p) : V_NONE;
+		trimSpaces(&p);
+		
+		/* Blank and comment-only lines don't hold anything, and a bad verbosity was already reported */
+		if(*p != '\0' && !(v & V_ERR)) {
+			if(!ParsedLine_parseDirective(p, line)) {
+				parseStatement(parser, p, line);
+			}
+			
+			line->verbosity = v;
+			ret = true;
+		}
+	}
+	
+	*ranOut = LineReader_hitEnd(reader);
+	*used = LineReader_offset(reader);
+	*lineNumber = input.lineNumber;
+	
+	Input_enter(old);
+	InputState_destroy(&input);
+	
+	LineReader_free(reader);
+	return ret;
+}
+
+static void parseStatement(Parser* parser, const char* p, ParsedLine* line) {
+	line->type = LINE_STATEMENT;
+	line->text = strdup(p);
+	line->lineNumber = Input_current()->lineNumber;
+	
+	/* Trailing whitespace doesn't change the statement, so leave it out of the cache key */
+	size_t len = strlen(p);
+	while(len > 0 && (p[len - 1] == ' ' || p[len - 1] == '\t')) {
+		len--;
+	}
+	
+	/* Only statements that fit on one line are cached */
+	if(parser->cache != NULL && !parser->continued) {
+		line->stmt = StmtCache_get(CAST_NONNULL(parser->cache), p, len);
+		if(line->stmt != NULL) {
+			return;
+		}
+	}
+	
+	const char* text = p;
+	Statement* parsed = Statement_parse(&p);
+	if(Statement_didError(parsed)) {
+		Value* err = parsed->var->val;
+		line->type = LINE_ERROR;
+		line->err = err->err;
+		err->err = CAST_NONNULL(NULL);
+		Statement_free(parsed);
+		return;
+	}
+	
+	/* A statement that continued onto more lines isn't described by its first line alone */
+	if(parser->cache != NULL && Input_current()->lineNumber == line->lineNumber) {
+		line->stmt = StmtCache_put(CAST_NONNULL(parser->cache), text, len, parsed);
+		return;
+	}
+	
+	line->stmt = line->owned = parsed;
+}
+
+static bool parseCommand(const char* p, ParsedLine* line) {
+	/* A string literal can't appear in an expression, so a word followed by a quote is a command */
+	const char* keyword = p;
+	if(!isalpha((unsigned char)*p)) {
+		return false;
+	}
+	
+	while(isalnum((unsigned char)*p) || *p == '_') {
+		p++;
+	}
+	
+	const char* q = p;
+	trimSpaces(&q);
+	if(q == p || *q != '"') {
+		return false;
+	}
+	
+	line->type = LINE_COMMAND;
+	line->name = strndup(keyword, (size_t)(p - keyword));
+	
+	const char* end = strchr(q + 1, '"');
+	if(end == NULL) {
+		line->type = LINE_ERROR;
+		line->err = unterminated(q);
+		return true;
+	}
+	
+	const char* rest = end + 1;
+	trimSpaces(&rest);
+	if(*rest != '\0') {
+		line->type = LINE_ERROR;
+		line->err = badChar(rest);
+		return true;
+	}
+	
+	line->arg = strndup(q + 1, (size_t)(end - q - 1));
+	return true;
+}
+
+bool ParsedLine_parseDirective(const char* p, ParsedLine* line) {
+	if(*p != '~' && *p != '@' && !isalpha((unsigned char)*p)) {
+		return false;
+	}
+	
+	ParsedLine ret;
+	memset(&ret, 0, sizeof(ret));
+	ret.lineNumber = Input_current()->lineNumber;
+	const char* text = p;
+	
+	if(*p == '~') {
+		/* Variable deletion, where '~~~' means reset interpreter */
+		p++;
+		ret.name = nextToken(&p);
+		if(ret.name != NULL) {
+			ret.type = LINE_DELETE;
+		}
+		else if(p[0] == '~' && p[1] == '~') {
+			ret.type = LINE_CLEAR;
+		}
+		else {
+			ret.type = LINE_ERROR;
+			ret.err = badChar(p);
+		}
+	}
+	else if(*p == '@') {
+		/* File import, where "@!" imports it again even if it was already imported */
+		p++;
+		if(*p == '!') {
+			ret.force = true;
+			p++;
+		}
+		
+		ret.type = LINE_IMPORT;
+		ret.name = strdup(p);
+	}
+	else if(!parseCommand(p, &ret)) {
+		return false;
+	}
+	
+	ret.text = strdup(text);
+	*line = ret;
+	return true;
+}
+
+void ParsedLine_destroy(ParsedLine* line) {
+	destroy(line->text);
+	Statement_free(line->owned);
+	destroy(line->name);
+	destroy(line->arg);
+	Error_free(line->err);
+	memset(line, 0, sizeof(*line));
+}
+
+PARSESTATUS Parser_next(Parser* parser, ParsedLine* line) {
+	memset(line, 0, sizeof(*line));
+	
+	/*
+	 Start with one line and double the number of lines offered whenever the
+	 statement continues past them, so a long run of statements is parsed in
+	 linear time. A statement that was already waiting picks up where it left
+	 off, but only once something new arrived.
+	 */
+	unsigned lines = parser->waitLines + 1;
+	if(parser->waitLines > 0 && !parser->finished && endOfLines(parser, lines) == parser->waitSize) {
+		return PARSE_NEED_MORE;
+	}
+	
+	while(1) {
+		size_t size = endOfLines(parser, lines);
+		if(size == 0) {
+			return parser->finished ? PARSE_END : PARSE_NEED_MORE;
+		}
+		
+		bool ranOut;
+		size_t used;
+		unsigned lineNumber;
+		parser->continued = lines > 1;
+		bool parsed = parseRegion(parser, size, line, &ranOut, &used, &lineNumber);
+		
+		if(ranOut) {
+			/* The statement continues onto lines that weren't offered yet */
+			size_t more = endOfLines(parser, lines * 2);
+			if(more > size) {
+				ParsedLine_destroy(line);
+				lines *= 2;
+				continue;
+			}
+			
+			/* All pending input was offered, so wait for more unless there won't be any */
+			if(!parser->finished) {
+				ParsedLine_destroy(line);
+				parser->waitLines = lines;
+				parser->waitSize = size;
+				return PARSE_NEED_MORE;
+			}
+		}
+		
+		parser->start += used;
+		parser->lineNumber = lineNumber;
+		parser->waitLines = 0;
+		parser->waitSize = 0;
+		lines = 1;
+		
+		if(parsed) {
+			return PARSE_LINE;
+		}
+	}
+}
@@ -0,0 +1,97 @@
+/*
+  parser.h
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#ifndef SC_PARSER_H
+#define SC_PARSER_H
+
+#include <stddef.h>
+
+typedef struct Parser Parser;
+#include "statement.h"
+#include "stmtcache.h"
+#include "generic.h"
+#include "error.h"
+
+
+ASSUME_NONNULL_BEGIN
+
+/*
+ Push-based parser. Input is fed in chunks of any size (they don't need to end
+ on line boundaries), and each line is pulled out once all of it has arrived,
+ along with any lines its statement continues onto. The caller decides when
+ and where input is read from, so nothing blocks and each stream gets its own
+ Parser.
+*/
+typedef enum {
+	PARSE_NEED_MORE = 0, /* No complete line yet, so feed more input */
+	PARSE_LINE,          /* A line was parsed (it may hold a syntax error) */
+	PARSE_END            /* Parser_finish was called and all input is consumed */
+} PARSESTATUS;
+
+typedef enum {
+	LINE_STATEMENT = 0, /* An expression or assignment in `stmt` */
+	LINE_DELETE,        /* ~name */
+	LINE_CLEAR,         /* ~~~ */
+	LINE_IMPORT,        /* @file, or @!file to import it again */
+	LINE_COMMAND,       /* A keyword followed by a quoted argument, like: mode "float" */
+	LINE_ERROR          /* Any of these that failed to parse, with the reason in `err` */
+} LINETYPE;
+
+/* Everything needed to run one line, which may have continued onto more lines */
+typedef struct ParsedLine {
+	LINETYPE type;
+	VERBOSITY verbosity;
+	
+	/* First line, without comments or leading whitespace */
+	OWNED char* _Nullable text;
+	unsigned lineNumber;
+	
+	/* Either `owned` or a statement kept in the cache */
+	UNOWNED const Statement* _Nullable stmt;
+	OWNED Statement* _Nullable owned;
+	
+	/* Variable, file or command keyword, and the command's argument */
+	OWNED char* _Nullable name;
+	OWNED char* _Nullable arg;
+	bool force;
+	
+	OWNED Error* _Nullable err;
+} ParsedLine;
+
+/* Constructor */
+RETURNS_OWNED Parser* Parser_new(const char* _Nullable name);
+
+/* Destructor */
+void Parser_free(CONSUMED Parser* _Nullable parser);
+
+/* Lets lines start with a verbosity prefix like "?t", as at the prompt */
+void Parser_allowVerbosity(Parser* parser);
+
+/* Reuses and adds to the statements in `cache`, which must outlive the parser */
+void Parser_useCache(Parser* parser, UNOWNED StmtCache* cache);
+
+/* Input */
+void Parser_feed(Parser* parser, const char* data, size_t len);
+void Parser_finish(Parser* parser);
+
+/* Whether some input is still waiting for the rest of its line or statement */
+bool Parser_hasPending(const Parser* parser);
+
+/* Parsing, where `line` must be destroyed after PARSE_LINE */
+PARSESTATUS Parser_next(Parser* parser, OUT ParsedLine* line);
+
+/*
+ Parses `p` if it's a line that isn't a statement: a deletion, an import or a
+ command. Returns false for anything else, leaving `line` alone.
+*/
+bool ParsedLine_parseDirective(const char* p, OUT ParsedLine* line);
+void ParsedLine_destroy(ParsedLine* line);
+
+ASSUME_NONNULL_END
+
+#endif /* SC_PARSER_H */
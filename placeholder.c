@@ -64,8 +64,9 @@ Placeholder* Placeholder_copy(const Placeholder* ph) {
 
 /* Parse a placeholder from a format string */
 Placeholder* Placeholder_parse(const char** expr) {
+	/* Malformed placeholders are only in templates, which report PH_ERR as an error */
 	if(**expr != '@') {
-		RAISE(badChar(*expr), true);
+		return Placeholder_new(PH_ERR, 0);
 	}
 	
 	/* Move past '@' */
@@ -81,7 +82,7 @@ Placeholder* Placeholder_parse(const char** expr) {
 		index = (unsigned)strtoul(*expr, &end, 10);
 		if(errno != 0 || index == 0 || *expr == end) {
 			/* An error occurred (EINVAL, ERANGE) */
-			RAISE(syntaxError(*expr, "Invalid number in placeholder"), true);
+			return Placeholder_new(PH_ERR, 0);
 		}
 		
 		/* Advance past the number */
@@ -90,7 +91,7 @@ Placeholder* Placeholder_parse(const char** expr) {
 	
 	PLACETYPE type = getPlaceholderType(**expr);
 	if(type == PH_ERR) {
-		RAISE(badChar(*expr), true);
+		return Placeholder_new(PH_ERR, 0);
 	}
 	
 	(*expr)++;
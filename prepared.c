@@ -0,0 +1,185 @@
+/*
+  prepared.c
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include "prepared.h"
+#include <stdlib.h>
+#include <string.h>
+
+#include "generic.h"
+#include "variable.h"
+#include "binop.h"
+#include "unop.h"
+#include "funccall.h"
+#include "vector.h"
+#include "arglist.h"
+
+
+struct Prepared {
+	OWNED Value* tree;
+	UNOWNED const Context* ctx;
+	
+	/* Holds a local for each parameter, whose value is replaced by binding it */
+	OWNED Context* frame;
+	
+	unsigned count;
+	unsigned capacity;
+	UNOWNED Variable* _Nonnull * _Nullable_unless(count > 0) params;
+	
+	/* Parameters that have never been bound */
+	unsigned unbound;
+	OWNED bool* _Nullable_unless(count > 0) bound;
+};
+
+
+static void collectParams(Prepared* prep, const Value* val);
+static void addParam(Prepared* prep, const char* name);
+
+
+Prepared* Prepared_new(const Context* ctx, const char* expr, Error** err) {
+	*err = NULL;
+	
+	Value* tree = Value_parseTop(&expr);
+	if(tree->type == VAL_ERR) {
+		*err = tree->err;
+		tree->err = CAST_NONNULL(NULL);
+		Value_free(tree);
+		return NULL;
+	}
+	
+	Prepared* ret = fmalloc(sizeof(*ret));
+	ret->tree = tree;
+	ret->ctx = ctx;
+	ret->frame = Context_pushFrame(ctx);
+	
+	collectParams(ret, tree);
+	ret->unbound = ret->count;
+	ret->bound = fcalloc(ret->count, sizeof(*ret->bound));
+	
+	return ret;
+}
+
+void Prepared_free(Prepared* prep) {
+	if(!prep) {
+		return;
+	}
+	
+	Value_free(prep->tree);
+	
+	/* Frees the parameters too */
+	Context_popFrame(prep->frame);
+	
+	destroy(prep->params);
+	destroy(prep->bound);
+	destroy(prep);
+}
+
+static void collectParams(Prepared* prep, const Value* val) {
+	unsigned i;
+	switch(val->type) {
+		case VAL_VAR:
+			if(Context_get(prep->ctx, val->name) == NULL && Prepared_paramIndex(prep, val->name) < 0) {
+				addParam(prep, val->name);
+			}
+			break;
+		
+		case VAL_EXPR:
+			collectParams(prep, val->expr->a);
+			if(val->expr->b != NULL) {
+				collectParams(prep, CAST_NONNULL(val->expr->b));
+			}
+			break;
+		
+		case VAL_UNARY:
+			collectParams(prep, val->term->a);
+			break;
+		
+		case VAL_CALL:
+			/* Only arguments can be parameters, the function itself must already exist */
+			if(val->call->func->type != VAL_VAR) {
+				collectParams(prep, val->call->func);
+			}
+			for(i = 0; i < val->call->arglist->count; i++) {
+				collectParams(prep, val->call->arglist->args[i]);
+			}
+			break;
+		
+		case VAL_INDEX:
+			collectParams(prep, val->sub->base);
+			for(i = 0; i < val->sub->indices->count; i++) {
+				collectParams(prep, val->sub->indices->args[i]);
+			}
+			break;
+		
+		case VAL_VEC:
+			for(i = 0; i < val->vec->vals->count; i++) {
+				collectParams(prep, val->vec->vals->args[i]);
+			}
+			break;
+		
+		default:
+			/* Function bodies only see their own arguments, so there's nothing to find in them */
+			break;
+	}
+}
+
+static void addParam(Prepared* prep, const char* name) {
+	if(prep->count == prep->capacity) {
+		prep->capacity = prep->capacity ? 2 * prep->capacity : 4;
+		prep->params = frealloc(prep->params, prep->capacity * sizeof(*prep->params));
+	}
+	
+	/* Placeholder value until it's bound */
+	Variable* var = Variable_new(strdup(name), ValInt(0));
+	Context_addLocal(prep->frame, var);
+	prep->params[prep->count++] = var;
+}
+
+unsigned Prepared_paramCount(const Prepared* prep) {
+	return prep->count;
+}
+
+const char* Prepared_paramName(const Prepared* prep, unsigned index) {
+	return CAST_NONNULL(prep->params[index]->name);
+}
+
+int Prepared_paramIndex(const Prepared* prep, const char* name) {
+	unsigned i;
+	for(i = 0; i < prep->count; i++) {
+		if(strcmp(CAST_NONNULL(prep->params[i]->name), name) == 0) {
+			return (int)i;
+		}
+	}
+	
+	return -1;
+}
+
+void Prepared_bind(Prepared* prep, unsigned index, Value* val) {
+	Variable_update(prep->params[index], val);
+	
+	if(!prep->bound[index]) {
+		prep->bound[index] = true;
+		prep->unbound--;
+	}
+}
+
+Value* Prepared_eval(Prepared* prep) {
+	if(prep->unbound > 0) {
+		/* Report the first one that's missing */
+		unsigned i = 0;
+		while(prep->bound[i]) {
+			i++;
+		}
+		
+		return ValErr(nameError("Parameter '%s' has no value.", Prepared_paramName(prep, i)));
+	}
+	
+	/* The mode may have changed since this was prepared */
+	Context_setMode(prep->frame, Context_getMode(prep->ctx));
+	
+	return Value_eval(prep->tree, prep->frame);
+}
@@ -0,0 +1,48 @@
+/*
+  prepared.h
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#ifndef SC_PREPARED_H
+#define SC_PREPARED_H
+
+typedef struct Prepared Prepared;
+#include "value.h"
+#include "context.h"
+#include "error.h"
+#include "annotations.h"
+
+
+ASSUME_NONNULL_BEGIN
+
+/*
+ An expression that is parsed once and then evaluated any number of times
+ with different values for its parameters. Every name in it that the context
+ doesn't define when it's prepared is a parameter, numbered from 0 in order
+ of first appearance. Parameters are locals in a stack frame on top of the
+ context, so evaluating reads them in place instead of copying the tree.
+*/
+
+/* Constructor, which returns NULL and sets `err` if the expression doesn't parse */
+RETURNS_OWNED Prepared* _Nullable Prepared_new(UNOWNED const Context* ctx, const char* expr, OUT Error* _Nullable* _Nonnull err);
+
+/* Destructor, which must be called before `ctx` is freed */
+void Prepared_free(CONSUMED Prepared* _Nullable prep);
+
+/* Parameters */
+unsigned Prepared_paramCount(const Prepared* prep);
+const char* Prepared_paramName(const Prepared* prep, unsigned index);
+int Prepared_paramIndex(const Prepared* prep, const char* name);
+
+/* Sets a parameter's value until it is bound again */
+void Prepared_bind(Prepared* prep, unsigned index, CONSUMED Value* val);
+
+/* Evaluates the expression, which is an error until every parameter has been bound */
+RETURNS_OWNED Value* Prepared_eval(Prepared* prep);
+
+ASSUME_NONNULL_END
+
+#endif /* SC_PREPARED_H */
@@ -0,0 +1,252 @@
+/*
+  scc.c
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include "scc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "generic.h"
+#include "value.h"
+#include "serial.h"
+
+
+/* Bump whenever the encoding of anything below or in serial.c changes */
+#define SCC_VERSION 3
+#define SCC_MAGIC "SCC\x1a"
+#define SCC_BYTE_ORDER 0x01020304u
+
+/* Entry kinds as stored in the file */
+#define SCC_KIND_END  0
+#define SCC_KIND_STMT 'S'
+#define SCC_KIND_LINE 'L'
+
+/* Flags in the header */
+#define SCC_FLAG_EXACT_DECIMALS 1u
+
+struct SccHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t byteOrder;
+	uint32_t flags;
+	uint64_t size;
+	int64_t mtimeSec;
+	int64_t mtimeNsec;
+	uint64_t hash;
+	uint64_t bodyHash;
+	uint64_t bodySize;
+};
+
+struct SccWriter {
+	SerialWriter out;
+};
+
+struct SccReader {
+	void* map;
+	size_t mapSize;
+	SerialReader in;
+};
+
+
+bool Scc_sourceInfo(const char* path, SccSource* src) {
+	int fd = open(path, O_RDONLY);
+	if(fd < 0) {
+		return false;
+	}
+	
+	struct stat st;
+	if(fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+		close(fd);
+		return false;
+	}
+	
+	src->size = (uint64_t)st.st_size;
+	src->mtimeSec = (int64_t)ST_MTIM(st).tv_sec;
+	src->mtimeNsec = (int64_t)ST_MTIM(st).tv_nsec;
+	src->exactDecimals = Input_current()->exactDecimals;
+	src->hash = Serial_hash(NULL, 0);
+	
+	if(st.st_size > 0) {
+		void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(map == MAP_FAILED) {
+			close(fd);
+			return false;
+		}
+		
+		src->hash = Serial_hash(map, (size_t)st.st_size);
+		munmap(map, (size_t)st.st_size);
+	}
+	
+	close(fd);
+	return true;
+}
+
+char* Scc_path(const char* path) {
+	size_t len = strlen(path);
+	char* ret;
+	
+	if(len > 4 && strcmp(path + len - 4, ".scs") == 0) {
+		ret = strdup(path);
+		ret[len - 1] = 'c';
+	}
+	else {
+		asprintf(&ret, "%s.scc", path);
+	}
+	
+	return ret;
+}
+
+
+SccWriter* SccWriter_new(void) {
+	return fmalloc(sizeof(SccWriter));
+}
+
+void SccWriter_free(SccWriter* writer) {
+	if(!writer) {
+		return;
+	}
+	
+	Serial_freeWriter(&writer->out);
+	destroy(writer);
+}
+
+void SccWriter_addStatement(SccWriter* writer, const Statement* stmt, unsigned lineNumber) {
+	Serial_putU8(&writer->out, SCC_KIND_STMT);
+	Serial_putU32(&writer->out, lineNumber);
+	Serial_putString(&writer->out, stmt->var->name);
+	Serial_putValue(&writer->out, stmt->var->val);
+}
+
+void SccWriter_addLine(SccWriter* writer, const char* line, unsigned lineNumber) {
+	Serial_putU8(&writer->out, SCC_KIND_LINE);
+	Serial_putU32(&writer->out, lineNumber);
+	Serial_putString(&writer->out, line);
+}
+
+bool SccWriter_save(SccWriter* writer, const char* path, const SccSource* src) {
+	if(writer->out.failed) {
+		return false;
+	}
+	
+	Serial_putU8(&writer->out, SCC_KIND_END);
+	
+	struct SccHeader hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, SCC_MAGIC, sizeof(hdr.magic));
+	hdr.version = SCC_VERSION;
+	hdr.byteOrder = SCC_BYTE_ORDER;
+	hdr.flags = src->exactDecimals ? SCC_FLAG_EXACT_DECIMALS : 0;
+	hdr.size = src->size;
+	hdr.mtimeSec = src->mtimeSec;
+	hdr.mtimeNsec = src->mtimeNsec;
+	hdr.hash = src->hash;
+	hdr.bodyHash = Serial_hash(writer->out.data, writer->out.len);
+	hdr.bodySize = writer->out.len;
+	
+	return Serial_writeFile(path, &hdr, sizeof(hdr), &writer->out);
+}
+
+
+SccReader* SccReader_open(const char* path, const SccSource* src) {
+	size_t size;
+	void* map = Serial_mapFile(path, sizeof(struct SccHeader), &size);
+	if(map == NULL) {
+		return NULL;
+	}
+	
+	struct SccHeader hdr;
+	memcpy(&hdr, map, sizeof(hdr));
+	
+	const uint8_t* body = (const uint8_t*)map + sizeof(hdr);
+	size_t bodySize = size - sizeof(hdr);
+	
+	bool valid = memcmp(hdr.magic, SCC_MAGIC, sizeof(hdr.magic)) == 0
+		&& hdr.version == SCC_VERSION
+		&& hdr.byteOrder == SCC_BYTE_ORDER
+		&& hdr.flags == (src->exactDecimals ? SCC_FLAG_EXACT_DECIMALS : 0)
+		&& hdr.size == src->size
+		&& hdr.mtimeSec == src->mtimeSec
+		&& hdr.mtimeNsec == src->mtimeNsec
+		&& hdr.hash == src->hash
+		&& hdr.bodySize == bodySize
+		&& hdr.bodyHash == Serial_hash(body, bodySize);
+	
+	if(!valid) {
+		munmap(map, size);
+		return NULL;
+	}
+	
+	SccReader* ret = fmalloc(sizeof(*ret));
+	ret->map = map;
+	ret->mapSize = size;
+	ret->in.cur = body;
+	ret->in.end = body + bodySize;
+	
+	return ret;
+}
+
+void SccReader_free(SccReader* reader) {
+	if(!reader) {
+		return;
+	}
+	
+	munmap(reader->map, reader->mapSize);
+	destroy(reader);
+}
+
+SCCENTRY SccReader_next(SccReader* reader, Statement** stmt, char** line, unsigned* lineNumber) {
+	SerialReader* in = &reader->in;
+	uint8_t kind;
+	uint32_t lineNo;
+	const char* str;
+	uint32_t len;
+	
+	*stmt = NULL;
+	*line = NULL;
+	
+	if(!Serial_getU8(in, &kind)) {
+		return SCC_CORRUPT;
+	}
+	
+	if(kind == SCC_KIND_END) {
+		return in->cur == in->end ? SCC_END : SCC_CORRUPT;
+	}
+	
+	if(!Serial_getU32(in, &lineNo) || !Serial_getString(in, &str, &len)) {
+		return SCC_CORRUPT;
+	}
+	
+	*lineNumber = lineNo;
+	
+	if(kind == SCC_KIND_LINE) {
+		if(str == NULL) {
+			return SCC_CORRUPT;
+		}
+		
+		*line = strndup(str, len);
+		return SCC_LINE;
+	}
+	
+	if(kind != SCC_KIND_STMT) {
+		return SCC_CORRUPT;
+	}
+	
+	Value* val = Serial_getValue(in);
+	if(val == NULL) {
+		return SCC_CORRUPT;
+	}
+	
+	char* name = str != NULL ? strndup(str, len) : NULL;
+	*stmt = Statement_new(Variable_new(name, val));
+	return SCC_STATEMENT;
+}
@@ -0,0 +1,78 @@
+/*
+  scc.h
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#ifndef SC_SCC_H
+#define SC_SCC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct SccWriter SccWriter;
+typedef struct SccReader SccReader;
+#include "statement.h"
+#include "annotations.h"
+
+
+ASSUME_NONNULL_BEGIN
+
+/*
+ Compiled imports. While a file is imported, each parsed statement is
+ serialized in order, along with the raw text of lines that aren't
+ statements (commands, deletions and nested imports). The result is saved
+ next to the source as a .scc file. Later imports of an unchanged source
+ map that file and rebuild the statements directly instead of parsing.
+*/
+
+/* Identifies a version of a source file */
+typedef struct SccSource {
+	uint64_t size;
+	int64_t mtimeSec;
+	int64_t mtimeNsec;
+	uint64_t hash;
+	bool exactDecimals;
+} SccSource;
+
+typedef enum {
+	SCC_CORRUPT = -1,
+	SCC_END = 0,
+	SCC_STATEMENT,
+	SCC_LINE
+} SCCENTRY;
+
+/* Fills in `src` for the file at `path`, returning false if it can't be read */
+bool Scc_sourceInfo(const char* path, OUT SccSource* src);
+
+/* Path of the compiled file for `path`: "lib.scs" becomes "lib.scc" */
+RETURNS_OWNED char* Scc_path(const char* path);
+
+/* Writer */
+RETURNS_OWNED SccWriter* SccWriter_new(void);
+void SccWriter_free(CONSUMED SccWriter* _Nullable writer);
+void SccWriter_addStatement(SccWriter* writer, const Statement* stmt, unsigned lineNumber);
+void SccWriter_addLine(SccWriter* writer, const char* line, unsigned lineNumber);
+bool SccWriter_save(SccWriter* writer, const char* path, const SccSource* src);
+
+/* Reader, which returns NULL if the file is missing, stale or from another version */
+RETURNS_OWNED SccReader* _Nullable SccReader_open(const char* path, const SccSource* src);
+void SccReader_free(CONSUMED SccReader* _Nullable reader);
+
+/*
+ Reads the next entry. For SCC_STATEMENT, `stmt` is set to a new statement
+ owned by the caller. For SCC_LINE, `line` is set to a copy of the line's
+ text, also owned by the caller.
+*/
+SCCENTRY SccReader_next(
+	SccReader* reader,
+	OUT Statement* _Nullable* _Nonnull stmt,
+	OUT char* _Nullable* _Nonnull line,
+	OUT unsigned* lineNumber
+);
+
+ASSUME_NONNULL_END
+
+#endif /* SC_SCC_H */
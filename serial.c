@@ -0,0 +1,541 @@
+/*
+  serial.c
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include "serial.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "generic.h"
+#include "value.h"
+#include "symbol.h"
+#include "builtin.h"
+
+
+#define SERIAL_NULL_STRING UINT32_MAX
+
+/*
+ Deepest nesting of values that will be read. Reading recurses, so a crafted
+ file could otherwise overflow the stack, and trees this deep are already too
+ deep to evaluate.
+*/
+#define SERIAL_MAX_DEPTH 10000
+
+
+static void putArgList(SerialWriter* w, const ArgList* arglist);
+static bool getBytes(SerialReader* r, void* out, size_t len);
+static ArgList* _Nullable getArgList(SerialReader* r);
+static bool writeAll(int fd, const void* data, size_t len);
+
+
+uint64_t Serial_hash(const void* data, size_t len) {
+	const uint8_t* bytes = data;
+	uint64_t hash = 14695981039346656037ull;
+	
+	size_t i;
+	for(i = 0; i < len; i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	
+	return hash;
+}
+
+void Serial_putBytes(SerialWriter* w, const void* data, size_t len) {
+	if(len == 0) {
+		return;
+	}
+	
+	if(w->len + len > w->cap) {
+		size_t cap = w->cap ? w->cap : 4096;
+		while(cap < w->len + len) {
+			cap *= 2;
+		}
+		
+		w->data = frealloc(w->data, cap);
+		w->cap = cap;
+	}
+	
+	memcpy(CAST_NONNULL(w->data) + w->len, data, len);
+	w->len += len;
+}
+
+void Serial_putU8(SerialWriter* w, uint8_t x) {
+	Serial_putBytes(w, &x, sizeof(x));
+}
+
+void Serial_putU32(SerialWriter* w, uint32_t x) {
+	Serial_putBytes(w, &x, sizeof(x));
+}
+
+void Serial_putU64(SerialWriter* w, uint64_t x) {
+	Serial_putBytes(w, &x, sizeof(x));
+}
+
+void Serial_putString(SerialWriter* w, const char* str) {
+	if(str == NULL) {
+		Serial_putU32(w, SERIAL_NULL_STRING);
+		return;
+	}
+	
+	size_t len = strlen(str);
+	Serial_putU32(w, (uint32_t)len);
+	Serial_putBytes(w, str, len);
+}
+
+static void putArgList(SerialWriter* w, const ArgList* arglist) {
+	Serial_putU32(w, arglist->count);
+	
+	unsigned i;
+	for(i = 0; i < arglist->count; i++) {
+		Serial_putValue(w, arglist->args[i]);
+	}
+}
+
+void Serial_putValue(SerialWriter* w, const Value* val) {
+	uint64_t bits;
+	
+	Serial_putU8(w, (uint8_t)(int8_t)val->type);
+	Serial_putU8(w, (uint8_t)val->flags);
+	
+	switch(val->type) {
+		case VAL_INT:
+			Serial_putU64(w, (uint64_t)val->ival);
+			break;
+		
+		case VAL_REAL:
+			memcpy(&bits, &val->rval, sizeof(bits));
+			Serial_putU64(w, bits);
+			break;
+		
+		case VAL_FRAC:
+			Serial_putU64(w, (uint64_t)val->frac->n);
+			Serial_putU64(w, (uint64_t)val->frac->d);
+			break;
+		
+		case VAL_XREAL:
+			memcpy(&bits, &val->xreal->hi, sizeof(bits));
+			Serial_putU64(w, bits);
+			memcpy(&bits, &val->xreal->lo, sizeof(bits));
+			Serial_putU64(w, bits);
+			break;
+		
+		case VAL_EXPR:
+			Serial_putU8(w, (uint8_t)val->expr->type);
+			Serial_putValue(w, val->expr->a);
+			Serial_putU8(w, val->expr->b != NULL);
+			if(val->expr->b != NULL) {
+				Serial_putValue(w, val->expr->b);
+			}
+			break;
+		
+		case VAL_UNARY:
+			Serial_putU8(w, (uint8_t)val->term->type);
+			Serial_putValue(w, val->term->a);
+			break;
+		
+		case VAL_CALL:
+			Serial_putValue(w, val->call->func);
+			putArgList(w, val->call->arglist);
+			break;
+		
+		case VAL_INDEX:
+			Serial_putValue(w, val->sub->base);
+			putArgList(w, val->sub->indices);
+			break;
+		
+		case VAL_VAR:
+			Serial_putString(w, val->name);
+			break;
+		
+		case VAL_VEC:
+			putArgList(w, val->vec->vals);
+			break;
+		
+		case VAL_FUNC: {
+			const Function* func = val->func;
+			Serial_putU32(w, func->argcount);
+			
+			unsigned i;
+			for(i = 0; i < func->argcount; i++) {
+				Serial_putString(w, func->argnames[i]);
+			}
+			
+			Serial_putU8(w, func->body != NULL);
+			if(func->body != NULL) {
+				Serial_putValue(w, func->body);
+			}
+			break;
+		}
+		
+		case VAL_BUILTIN:
+			/* Builtins are static, so they're stored by name */
+			Serial_putString(w, val->blt->name);
+			break;
+		
+		case VAL_PLACE:
+			Serial_putU8(w, (uint8_t)(int8_t)val->ph->type);
+			Serial_putU32(w, val->ph->index);
+			break;
+		
+		case VAL_NEG:
+			break;
+		
+		default:
+			w->failed = true;
+			break;
+	}
+}
+
+void Serial_freeWriter(SerialWriter* w) {
+	destroy(w->data);
+	w->data = NULL;
+	w->len = w->cap = 0;
+}
+
+static bool getBytes(SerialReader* r, void* out, size_t len) {
+	if((size_t)(r->end - r->cur) < len) {
+		return false;
+	}
+	
+	memcpy(out, r->cur, len);
+	r->cur += len;
+	return true;
+}
+
+bool Serial_getU8(SerialReader* r, uint8_t* x) {
+	return getBytes(r, x, sizeof(*x));
+}
+
+bool Serial_getU32(SerialReader* r, uint32_t* x) {
+	return getBytes(r, x, sizeof(*x));
+}
+
+bool Serial_getU64(SerialReader* r, uint64_t* x) {
+	return getBytes(r, x, sizeof(*x));
+}
+
+/* Sets `str` to point into the buffer, or to NULL for a NULL string */
+bool Serial_getString(SerialReader* r, const char** str, uint32_t* len) {
+	if(!Serial_getU32(r, len)) {
+		return false;
+	}
+	
+	if(*len == SERIAL_NULL_STRING) {
+		*str = NULL;
+		return true;
+	}
+	
+	if((size_t)(r->end - r->cur) < *len) {
+		return false;
+	}
+	
+	*str = (const char*)r->cur;
+	r->cur += *len;
+	return true;
+}
+
+static ArgList* getArgList(SerialReader* r) {
+	uint32_t count;
+	
+	/* Every value takes at least two bytes, which bounds the count by what's left */
+	if(!Serial_getU32(r, &count) || count > (size_t)(r->end - r->cur) / 2) {
+		return NULL;
+	}
+	
+	ArgList* ret = ArgList_new(count);
+	
+	unsigned i;
+	for(i = 0; i < count; i++) {
+		Value* arg = Serial_getValue(r);
+		if(arg == NULL) {
+			/* Shrink to what was filled in so the partial list can be freed */
+			ret->count = i;
+			ArgList_free(ret);
+			return NULL;
+		}
+		
+		ret->args[i] = arg;
+	}
+	
+	return ret;
+}
+
+Value* Serial_getValue(SerialReader* r) {
+	uint8_t type;
+	uint8_t flags;
+	uint8_t byte;
+	uint32_t u32;
+	uint64_t a;
+	uint64_t b;
+	const char* str;
+	Value* ret = NULL;
+	
+	if(r->depth >= SERIAL_MAX_DEPTH || !Serial_getU8(r, &type) || !Serial_getU8(r, &flags)) {
+		return NULL;
+	}
+	
+	r->depth++;
+	switch((VALTYPE)(int8_t)type) {
+		case VAL_INT:
+			if(Serial_getU64(r, &a)) {
+				ret = ValInt((long long)a);
+			}
+			break;
+		
+		case VAL_REAL:
+			if(Serial_getU64(r, &a)) {
+				double rval;
+				memcpy(&rval, &a, sizeof(rval));
+				ret = ValReal(rval);
+			}
+			break;
+		
+		case VAL_FRAC:
+			if(Serial_getU64(r, &a) && Serial_getU64(r, &b) && (long long)b > 0) {
+				ret = ValFrac(Fraction_new((long long)a, (long long)b));
+			}
+			break;
+		
+		case VAL_XREAL:
+			if(Serial_getU64(r, &a) && Serial_getU64(r, &b)) {
+				DDReal x;
+				memcpy(&x.hi, &a, sizeof(x.hi));
+				memcpy(&x.lo, &b, sizeof(x.lo));
+				ret = ValXReal(x);
+			}
+			break;
+		
+		case VAL_EXPR: {
+			if(!Serial_getU8(r, &byte) || byte >= BIN_COUNT) {
+				break;
+			}
+			
+			BINTYPE bin = (BINTYPE)byte;
+			Value* lhs = Serial_getValue(r);
+			if(lhs == NULL) {
+				break;
+			}
+			
+			Value* rhs = NULL;
+			uint8_t hasB;
+			if(!Serial_getU8(r, &hasB) || (hasB && (rhs = Serial_getValue(r)) == NULL)) {
+				Value_free(lhs);
+				break;
+			}
+			
+			ret = ValExpr(BinOp_new(bin, lhs, rhs));
+			break;
+		}
+		
+		case VAL_UNARY: {
+			if(!Serial_getU8(r, &byte) || byte != UN_FACT) {
+				break;
+			}
+			
+			Value* operand = Serial_getValue(r);
+			if(operand != NULL) {
+				ret = ValUnary(UnOp_new(UN_FACT, operand));
+			}
+			break;
+		}
+		
+		case VAL_CALL: {
+			Value* func = Serial_getValue(r);
+			if(func == NULL) {
+				break;
+			}
+			
+			ArgList* arglist = getArgList(r);
+			if(arglist == NULL) {
+				Value_free(func);
+				break;
+			}
+			
+			ret = ValCall(FuncCall_new(func, arglist));
+			break;
+		}
+		
+		case VAL_INDEX: {
+			Value* base = Serial_getValue(r);
+			if(base == NULL) {
+				break;
+			}
+			
+			ArgList* indices = getArgList(r);
+			if(indices == NULL || indices->count == 0) {
+				ArgList_free(indices);
+				Value_free(base);
+				break;
+			}
+			
+			Subscript* sub = fmalloc(sizeof(*sub));
+			sub->base = base;
+			sub->indices = indices;
+			ret = ValIndex(sub);
+			break;
+		}
+		
+		case VAL_VAR:
+			if(Serial_getString(r, &str, &u32) && str != NULL) {
+				ret = ValVar(Symbol_intern(str, u32));
+			}
+			break;
+		
+		case VAL_VEC: {
+			ArgList* vals = getArgList(r);
+			if(vals != NULL) {
+				ret = ValVec(Vector_new(vals));
+			}
+			break;
+		}
+		
+		case VAL_FUNC: {
+			uint32_t argcount;
+			if(!Serial_getU32(r, &argcount) || argcount > (size_t)(r->end - r->cur) / 4) {
+				break;
+			}
+			
+			char** argnames = argcount ? fcalloc(argcount, sizeof(*argnames)) : NULL;
+			bool ok = true;
+			
+			unsigned i;
+			for(i = 0; ok && i < argcount; i++) {
+				ok = Serial_getString(r, &str, &u32) && str != NULL;
+				if(ok) {
+					argnames[i] = strndup(str, u32);
+				}
+			}
+			
+			Value* body = NULL;
+			uint8_t hasBody = 0;
+			ok = ok && Serial_getU8(r, &hasBody);
+			if(ok && hasBody) {
+				body = Serial_getValue(r);
+				ok = body != NULL;
+			}
+			
+			if(!ok) {
+				for(i = 0; i < argcount; i++) {
+					destroy(argnames[i]);
+				}
+				destroy(argnames);
+				break;
+			}
+			
+			ret = ValFunc(Function_new(argcount, argnames, body));
+			break;
+		}
+		
+		case VAL_BUILTIN: {
+			if(!Serial_getString(r, &str, &u32) || str == NULL) {
+				break;
+			}
+			
+			char* name = strndup(str, u32);
+			Variable* var = Builtin_lookup(name);
+			destroy(name);
+			
+			if(var != NULL) {
+				ret = ValBuiltin(var->val->blt);
+			}
+			break;
+		}
+		
+		case VAL_PLACE:
+			if(Serial_getU8(r, &byte) && byte <= PH_VAL && Serial_getU32(r, &u32)) {
+				ret = ValPlace(Placeholder_new((PLACETYPE)byte, u32));
+			}
+			break;
+		
+		case VAL_NEG:
+			ret = ValNeg();
+			break;
+		
+		default:
+			break;
+	}
+	r->depth--;
+	
+	if(ret != NULL) {
+		ret->flags = (VALFLAGS)flags;
+	}
+	
+	return ret;
+}
+
+static bool writeAll(int fd, const void* data, size_t len) {
+	const uint8_t* p = data;
+	
+	while(len > 0) {
+		ssize_t n = write(fd, p, len);
+		if(n < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		
+		p += n;
+		len -= (size_t)n;
+	}
+	
+	return true;
+}
+
+bool Serial_writeFile(const char* path, const void* header, size_t headerLen, const SerialWriter* body) {
+	char* tmpPath;
+	asprintf(&tmpPath, "%s.XXXXXX", path);
+	int fd = mkstemp(tmpPath);
+	if(fd < 0) {
+		destroy(tmpPath);
+		return false;
+	}
+	
+	bool ok = fchmod(fd, 0644) == 0
+		&& writeAll(fd, header, headerLen)
+		&& writeAll(fd, body->data, body->len);
+	ok = close(fd) == 0 && ok;
+	ok = ok && rename(tmpPath, path) == 0;
+	
+	if(!ok) {
+		unlink(tmpPath);
+	}
+	
+	destroy(tmpPath);
+	return ok;
+}
+
+void* Serial_mapFile(const char* path, size_t minSize, size_t* size) {
+	int fd = open(path, O_RDONLY);
+	if(fd < 0) {
+		return NULL;
+	}
+	
+	struct stat st;
+	if(fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || (size_t)st.st_size < minSize || st.st_size == 0) {
+		close(fd);
+		errno = EINVAL;
+		return NULL;
+	}
+	
+	void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(map == MAP_FAILED) {
+		return NULL;
+	}
+	
+	*size = (size_t)st.st_size;
+	return map;
+}
@@ -0,0 +1,74 @@
+/*
+  serial.h
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#ifndef SC_SERIAL_H
+#define SC_SERIAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "value.h"
+#include "annotations.h"
+
+
+ASSUME_NONNULL_BEGIN
+
+/*
+ Binary encoding of values, shared by compiled imports and snapshots.
+ Everything is stored in host byte order, since these files are only ever
+ read back on the machine that wrote them.
+*/
+
+/* Appends to a growing buffer */
+typedef struct SerialWriter {
+	OWNED uint8_t* _Nullable data;
+	size_t len;
+	size_t cap;
+	
+	/* Set when a value contains something that can't be serialized */
+	bool failed;
+} SerialWriter;
+
+/* Reads from a buffer, failing instead of reading past its end */
+typedef struct SerialReader {
+	const uint8_t* cur;
+	const uint8_t* end;
+	
+	/* How many values are being read inside each other */
+	unsigned depth;
+} SerialReader;
+
+/* Writing */
+void Serial_putBytes(SerialWriter* w, const void* data, size_t len);
+void Serial_putU8(SerialWriter* w, uint8_t x);
+void Serial_putU32(SerialWriter* w, uint32_t x);
+void Serial_putU64(SerialWriter* w, uint64_t x);
+void Serial_putString(SerialWriter* w, const char* _Nullable str);
+void Serial_putValue(SerialWriter* w, const Value* val);
+void Serial_freeWriter(SerialWriter* w);
+
+/* Reading */
+bool Serial_getU8(SerialReader* r, OUT uint8_t* x);
+bool Serial_getU32(SerialReader* r, OUT uint32_t* x);
+bool Serial_getU64(SerialReader* r, OUT uint64_t* x);
+bool Serial_getString(SerialReader* r, OUT const char* _Nullable* _Nonnull str, OUT uint32_t* len);
+RETURNS_OWNED Value* _Nullable Serial_getValue(SerialReader* r);
+
+/* FNV-1a, used to detect stale or corrupt files */
+uint64_t Serial_hash(const void* data, size_t len);
+
+/* Writes the header and then the body to `path` through a temporary file, so readers never see a partial file */
+bool Serial_writeFile(const char* path, const void* header, size_t headerLen, const SerialWriter* body);
+
+/* Maps a whole file read-only, returning NULL if it can't or is smaller than `minSize` */
+RETURNS_OWNED void* _Nullable Serial_mapFile(const char* path, size_t minSize, OUT size_t* size);
+
+ASSUME_NONNULL_END
+
+#endif /* SC_SERIAL_H */
@@ -0,0 +1,605 @@
+/*
+  server.c
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include "server.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "generic.h"
+#include "value.h"
+#include "jsonl.h"
+#include "serial.h"
+#include "linereader.h"
+
+
+/* Bytes read from a connection at a time */
+#define SERVER_READ_SIZE (64 * 1024)
+
+/*
+ Most unprocessed input kept for a connection, which is also the longest
+ request it can send. Nothing more is read until some of it has been run.
+*/
+#define SERVER_MAX_INPUT (1024 * 1024)
+
+/* A connection's requests wait while this much of its output hasn't been sent yet */
+#define SERVER_MAX_BACKLOG (1024 * 1024)
+
+/* Initial number of hash buckets for named sessions, always a power of two */
+#define SERVER_MIN_BUCKETS 64
+
+/*
+ Named sessions last until the server exits, so clients can only create this
+ many. Requests that would create another one get an error instead.
+*/
+#define SERVER_MAX_SESSIONS 1024u
+
+struct Session {
+	OWNED SuperCalc* sc;
+	
+	/* Requests are complete on their own, so parsing one never reads continuation lines */
+	OWNED LineReader* noInput;
+	
+	/* Held while running one of this session's requests */
+	pthread_mutex_t lock;
+	
+	/* Sessions without a name belong to a single connection */
+	OWNED char* _Nullable name;
+	uint64_t hash;
+	struct Session* _Nullable next;
+};
+
+struct Connection {
+	int fd;
+	
+	/*
+	 Connections are watched for one event at a time, so only one thread ever
+	 works on each. This lock is never contended, but makes the handoff
+	 between threads visible to tools like ThreadSanitizer.
+	*/
+	pthread_mutex_t lock;
+	
+	/* Input that hasn't been run yet */
+	OWNED char* _Nullable in;
+	size_t inLen;
+	size_t inCap;
+	bool eof;
+	
+	/* Responses, of which the first `sent` bytes have been written */
+	SerialWriter out;
+	size_t sent;
+	
+	/* Created by the first request that doesn't name a session */
+	OWNED struct Session* _Nullable own;
+	
+	/* Every open connection, so they can all be closed when the server is freed */
+	struct Connection* _Nullable prev;
+	struct Connection* _Nullable next;
+};
+
+struct Server {
+	UNOWNED const SuperCalc* lib;
+	OWNED char* path;
+	unsigned threads;
+	
+	int listenFd;
+	int stopFd;
+	int epollFd;
+	
+	/* Protects everything below */
+	pthread_mutex_t lock;
+	OWNED struct Session* _Nullable* buckets;
+	size_t bucketCount;
+	size_t sessionCount;
+	struct Connection* _Nullable conns;
+};
+
+
+static Error* _Nullable Server_listen(Server* server);
+static struct Session* Session_new(const SuperCalc* lib, char* _Nullable name, uint64_t hash);
+static void Session_free(struct Session* _Nullable session);
+static struct Session* _Nullable Server_namedSession(Server* server, const char* name);
+static void* _Nullable Server_thread(void* _Nullable data);
+static void Server_accept(Server* server);
+static void Server_service(Server* server, struct Connection* conn, uint32_t events);
+static bool Server_readInput(struct Connection* conn);
+static bool Server_runRequests(Server* server, struct Connection* conn);
+static void Server_runRequest(Server* server, struct Connection* conn, char* line);
+static bool Server_writeOutput(struct Connection* conn);
+static bool Server_watch(Server* server, int op, int fd, void* ptr, uint32_t events);
+static void Server_close(Server* server, struct Connection* conn);
+static void Connection_free(struct Connection* conn);
+
+
+Server* Server_new(const SuperCalc* lib, const char* path, unsigned threads, Error** err) {
+	Server* ret = fmalloc(sizeof(*ret));
+	ret->lib = lib;
+	ret->path = strdup(path);
+	ret->threads = MAX(threads, 1u);
+	ret->listenFd = ret->stopFd = ret->epollFd = -1;
+	pthread_mutex_init(&ret->lock, NULL);
+	ret->bucketCount = SERVER_MIN_BUCKETS;
+	ret->buckets = fcalloc(ret->bucketCount, sizeof(*ret->buckets));
+	
+	*err = Server_listen(ret);
+	if(*err != NULL) {
+		Server_free(ret);
+		return NULL;
+	}
+	
+	return ret;
+}
+
+static Error* Server_listen(Server* server) {
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if(strlen(server->path) >= sizeof(addr.sun_path)) {
+		return serverError("create", server->path, "path is too long");
+	}
+	strcpy(addr.sun_path, server->path);
+	
+	server->listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if(server->listenFd < 0) {
+		return serverError("create", server->path, strerror(errno));
+	}
+	
+	/* Only the user running the server may connect, since requests can read and write files */
+	mode_t oldMask = umask(0077);
+	int rc = bind(server->listenFd, (struct sockaddr*)&addr, sizeof(addr));
+	if(rc < 0 && errno == EADDRINUSE) {
+		/* Replace a socket left behind by a server that exited, but not one that's still running */
+		int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if(probe >= 0 && connect(probe, (struct sockaddr*)&addr, sizeof(addr)) < 0 && errno == ECONNREFUSED) {
+			unlink(server->path);
+			rc = bind(server->listenFd, (struct sockaddr*)&addr, sizeof(addr));
+		}
+		else {
+			errno = EADDRINUSE;
+		}
+		
+		if(probe >= 0) {
+			close(probe);
+		}
+	}
+	umask(oldMask);
+	
+	if(rc < 0) {
+		Error* ret = serverError("bind", server->path, strerror(errno));
+		close(server->listenFd);
+		server->listenFd = -1;
+		return ret;
+	}
+	
+	if(listen(server->listenFd, SOMAXCONN) < 0) {
+		return serverError("listen on", server->path, strerror(errno));
+	}
+	
+	server->stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	server->epollFd = epoll_create1(EPOLL_CLOEXEC);
+	if(server->stopFd < 0 || server->epollFd < 0) {
+		return serverError("listen on", server->path, strerror(errno));
+	}
+	
+	/*
+	 Connections and the listening socket are watched one event at a time, so
+	 only one thread ever works on each. The stop event is never consumed, so
+	 it wakes up every thread.
+	*/
+	if(!Server_watch(server, EPOLL_CTL_ADD, server->listenFd, &server->listenFd, EPOLLIN | EPOLLONESHOT)
+		|| !Server_watch(server, EPOLL_CTL_ADD, server->stopFd, &server->stopFd, EPOLLIN))
+	{
+		return serverError("listen on", server->path, strerror(errno));
+	}
+	
+	return NULL;
+}
+
+void Server_free(Server* server) {
+	if(!server) {
+		return;
+	}
+	
+	while(server->conns != NULL) {
+		struct Connection* conn = server->conns;
+		server->conns = conn->next;
+		Connection_free(conn);
+	}
+	
+	size_t i;
+	for(i = 0; i < server->bucketCount; i++) {
+		struct Session* cur = server->buckets[i];
+		while(cur != NULL) {
+			struct Session* next = cur->next;
+			Session_free(cur);
+			cur = next;
+		}
+	}
+	destroy(server->buckets);
+	
+	if(server->listenFd >= 0) {
+		close(server->listenFd);
+		unlink(server->path);
+	}
+	
+	if(server->stopFd >= 0) {
+		close(server->stopFd);
+	}
+	
+	if(server->epollFd >= 0) {
+		close(server->epollFd);
+	}
+	
+	pthread_mutex_destroy(&server->lock);
+	destroy(server->path);
+	destroy(server);
+}
+
+void Server_run(Server* server) {
+	/* The calling thread serves requests too */
+	pthread_t* threads = fcalloc(server->threads, sizeof(*threads));
+	unsigned i;
+	for(i = 1; i < server->threads; i++) {
+		if(pthread_create(&threads[i], NULL, &Server_thread, server) != 0) {
+			DIE("Failed to start server thread.");
+		}
+	}
+	
+	Server_thread(server);
+	
+	for(i = 1; i < server->threads; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	destroy(threads);
+}
+
+void Server_stop(Server* server) {
+	uint64_t one = 1;
+	if(write(server->stopFd, &one, sizeof(one)) < 0) {
+		/* The counter is full, so it's already stopping */
+	}
+}
+
+static struct Session* Session_new(const SuperCalc* lib, char* name, uint64_t hash) {
+	struct Session* ret = fmalloc(sizeof(*ret));
+	ret->sc = SuperCalc_newSession(lib);
+	
+	ret->noInput = LineReader_empty();
+	ret->sc->input.reader = ret->noInput;
+	
+	pthread_mutex_init(&ret->lock, NULL);
+	ret->name = name;
+	ret->hash = hash;
+	return ret;
+}
+
+static void Session_free(struct Session* session) {
+	if(!session) {
+		return;
+	}
+	
+	SuperCalc_free(session->sc);
+	LineReader_free(session->noInput);
+	pthread_mutex_destroy(&session->lock);
+	destroy(session->name);
+	destroy(session);
+}
+
+static struct Session* Server_namedSession(Server* server, const char* name) {
+	uint64_t hash = Serial_hash(name, strlen(name));
+	
+	pthread_mutex_lock(&server->lock);
+	
+	struct Session* ret;
+	for(ret = server->buckets[hash & (server->bucketCount - 1)]; ret != NULL; ret = ret->next) {
+		if(ret->hash == hash && strcmp(CAST_NONNULL(ret->name), name) == 0) {
+			break;
+		}
+	}
+	
+	if(ret == NULL && server->sessionCount < SERVER_MAX_SESSIONS) {
+		if(server->sessionCount >= server->bucketCount) {
+			/* Double the buckets, keeping each chain at about one session */
+			size_t count = server->bucketCount * 2;
+			struct Session** buckets = fcalloc(count, sizeof(*buckets));
+			size_t i;
+			for(i = 0; i < server->bucketCount; i++) {
+				struct Session* cur = server->buckets[i];
+				while(cur != NULL) {
+					struct Session* next = cur->next;
+					cur->next = buckets[cur->hash & (count - 1)];
+					buckets[cur->hash & (count - 1)] = cur;
+					cur = next;
+				}
+			}
+			
+			destroy(server->buckets);
+			server->buckets = buckets;
+			server->bucketCount = count;
+		}
+		
+		ret = Session_new(server->lib, strdup(name), hash);
+		ret->next = server->buckets[hash & (server->bucketCount - 1)];
+		server->buckets[hash & (server->bucketCount - 1)] = ret;
+		server->sessionCount++;
+	}
+	
+	pthread_mutex_unlock(&server->lock);
+	return ret;
+}
+
+static void* Server_thread(void* data) {
+	Server* server = data;
+	
+	while(true) {
+		struct epoll_event ev;
+		int count = epoll_wait(server->epollFd, &ev, 1, -1);
+		if(count < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+			
+			DIE("epoll_wait failed: %s", strerror(errno));
+		}
+		
+		if(ev.data.ptr == &server->stopFd) {
+			break;
+		}
+		
+		if(ev.data.ptr == &server->listenFd) {
+			Server_accept(server);
+			continue;
+		}
+		
+		Server_service(server, ev.data.ptr, ev.events);
+	}
+	
+	return NULL;
+}
+
+static void Server_accept(Server* server) {
+	while(true) {
+		int fd = accept4(server->listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if(fd < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+			
+			/* Usually there's nobody else waiting, otherwise this is retried on the next event */
+			break;
+		}
+		
+		struct Connection* conn = fmalloc(sizeof(*conn));
+		pthread_mutex_init(&conn->lock, NULL);
+		pthread_mutex_lock(&conn->lock);
+		conn->fd = fd;
+		
+		pthread_mutex_lock(&server->lock);
+		conn->next = server->conns;
+		if(conn->next != NULL) {
+			conn->next->prev = conn;
+		}
+		server->conns = conn;
+		pthread_mutex_unlock(&server->lock);
+		pthread_mutex_unlock(&conn->lock);
+		
+		if(!Server_watch(server, EPOLL_CTL_ADD, fd, conn, EPOLLIN | EPOLLONESHOT)) {
+			Server_close(server, conn);
+		}
+	}
+	
+	Server_watch(server, EPOLL_CTL_MOD, server->listenFd, &server->listenFd, EPOLLIN | EPOLLONESHOT);
+}
+
+static void Server_service(Server* server, struct Connection* conn, uint32_t events) {
+	pthread_mutex_lock(&conn->lock);
+	
+	bool ok = (events & EPOLLERR) == 0;
+	if(ok && (events & (EPOLLIN | EPOLLHUP)) != 0) {
+		ok = Server_readInput(conn);
+	}
+	
+	bool backlogged = false;
+	while(ok) {
+		backlogged = Server_runRequests(server, conn);
+		ok = Server_writeOutput(conn);
+		
+		/* Keep going only if the client has already read everything sent so far */
+		if(!backlogged || conn->sent < conn->out.len) {
+			break;
+		}
+	}
+	
+	bool waiting = conn->sent < conn->out.len;
+	if(ok && !backlogged && conn->inLen >= SERVER_MAX_INPUT) {
+		/* The whole buffer is one incomplete request */
+		ok = false;
+	}
+	
+	if(!ok || (conn->eof && conn->inLen == 0 && !waiting)) {
+		pthread_mutex_unlock(&conn->lock);
+		Server_close(server, conn);
+		return;
+	}
+	
+	/* Stop reading requests from clients that aren't reading their responses */
+	uint32_t want = EPOLLONESHOT;
+	if(waiting) {
+		want |= EPOLLOUT;
+	}
+	if(!conn->eof && !backlogged) {
+		want |= EPOLLIN;
+	}
+	
+	/* Once it's watched again, another thread may take over as soon as this one lets go */
+	bool watched = Server_watch(server, EPOLL_CTL_MOD, conn->fd, conn, want);
+	pthread_mutex_unlock(&conn->lock);
+	
+	if(!watched) {
+		Server_close(server, conn);
+	}
+}
+
+static bool Server_readInput(struct Connection* conn) {
+	while(!conn->eof && conn->inLen < SERVER_MAX_INPUT) {
+		if(conn->inCap - conn->inLen < SERVER_READ_SIZE) {
+			/* Room for one more byte to terminate a last request that has no newline */
+			conn->inCap = MAX(conn->inCap * 2, conn->inLen + SERVER_READ_SIZE);
+			conn->in = frealloc(conn->in, conn->inCap + 1);
+		}
+		
+		ssize_t n = recv(conn->fd, CAST_NONNULL(conn->in) + conn->inLen, conn->inCap - conn->inLen, 0);
+		if(n > 0) {
+			conn->inLen += (size_t)n;
+		}
+		else if(n == 0) {
+			conn->eof = true;
+		}
+		else if(errno != EINTR) {
+			return errno == EAGAIN || errno == EWOULDBLOCK;
+		}
+	}
+	
+	return true;
+}
+
+/* Returns whether there are requests left that have to wait for the client to read its responses */
+static bool Server_runRequests(Server* server, struct Connection* conn) {
+	if(conn->in == NULL) {
+		return false;
+	}
+	
+	char* start = conn->in;
+	char* end = start + conn->inLen;
+	bool backlogged = false;
+	
+	while(start < end) {
+		if(conn->out.len - conn->sent >= SERVER_MAX_BACKLOG) {
+			backlogged = true;
+			break;
+		}
+		
+		char* newline = memchr(start, '\n', (size_t)(end - start));
+		if(newline == NULL) {
+			if(!conn->eof) {
+				break;
+			}
+			
+			/* There's always room to terminate the last line */
+			newline = end;
+		}
+		
+		*newline = '\0';
+		Server_runRequest(server, conn, start);
+		start = newline < end ? newline + 1 : end;
+	}
+	
+	conn->inLen = (size_t)(end - start);
+	memmove(conn->in, start, conn->inLen);
+	return backlogged;
+}
+
+static void Server_runRequest(Server* server, struct Connection* conn, char* line) {
+	const char* p = line;
+	trimSpaces(&p);
+	if(*p == '\0') {
+		return;
+	}
+	
+	JsonlRequest req;
+	Error* err = Jsonl_parseRequest(line, &req);
+	Value* result;
+	struct Session* session = NULL;
+	if(err != NULL) {
+		result = ValErr(err);
+	}
+	else if(req.session != NULL && (session = Server_namedSession(server, req.session)) == NULL) {
+		result = ValErr(tooManySessions(SERVER_MAX_SESSIONS));
+	}
+	else {
+		if(session == NULL) {
+			if(conn->own == NULL) {
+				conn->own = Session_new(server->lib, NULL, 0);
+			}
+			session = conn->own;
+		}
+		
+		/*
+		 Errors that would normally end the program are only reported to the
+		 client, since every other session is still fine.
+		*/
+		pthread_mutex_lock(&session->lock);
+		result = SuperCalc_runLines(session->sc, CAST_NONNULL(req.expr));
+		pthread_mutex_unlock(&session->lock);
+	}
+	
+	Jsonl_writeResponse(&conn->out, &req, result);
+	Value_free(result);
+	Jsonl_freeRequest(&req);
+}
+
+static bool Server_writeOutput(struct Connection* conn) {
+	while(conn->sent < conn->out.len) {
+		ssize_t n = send(conn->fd, CAST_NONNULL(conn->out.data) + conn->sent, conn->out.len - conn->sent, MSG_NOSIGNAL);
+		if(n >= 0) {
+			conn->sent += (size_t)n;
+		}
+		else if(errno != EINTR) {
+			return errno == EAGAIN || errno == EWOULDBLOCK;
+		}
+	}
+	
+	/* Everything was sent, so start over at the beginning of the buffer */
+	conn->out.len = 0;
+	conn->sent = 0;
+	return true;
+}
+
+static bool Server_watch(Server* server, int op, int fd, void* ptr, uint32_t events) {
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = events;
+	ev.data.ptr = ptr;
+	return epoll_ctl(server->epollFd, op, fd, &ev) == 0;
+}
+
+static void Server_close(Server* server, struct Connection* conn) {
+	pthread_mutex_lock(&server->lock);
+	if(conn->prev != NULL) {
+		conn->prev->next = conn->next;
+	}
+	else {
+		server->conns = conn->next;
+	}
+	
+	if(conn->next != NULL) {
+		conn->next->prev = conn->prev;
+	}
+	pthread_mutex_unlock(&server->lock);
+	
+	/* Closing the socket also stops watching it */
+	Connection_free(conn);
+}
+
+static void Connection_free(struct Connection* conn) {
+	close(conn->fd);
+	pthread_mutex_destroy(&conn->lock);
+	destroy(conn->in);
+	Serial_freeWriter(&conn->out);
+	Session_free(conn->own);
+	destroy(conn);
+}
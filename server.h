@@ -0,0 +1,44 @@
+/*
+  server.h
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#ifndef SC_SERVER_H
+#define SC_SERVER_H
+
+#include "supercalc.h"
+#include "error.h"
+#include "annotations.h"
+
+
+ASSUME_NONNULL_BEGIN
+
+/*
+ Daemon answering JSON lines requests (see jsonl.h) on a Unix domain socket.
+ Each connection has a session of its own, unless a request names a
+ "session", which is then shared with every other connection using that
+ name until the server stops. Every session is built on the same library, so
+ whatever it imported is only loaded once. Requests in one session run one
+ at a time in the order they arrived, while different sessions run in
+ parallel on a fixed set of threads.
+*/
+typedef struct Server Server;
+
+/* Constructor, which starts listening on the socket at `path` */
+RETURNS_OWNED Server* _Nullable Server_new(UNOWNED const SuperCalc* lib, const char* path, unsigned threads, OUT Error* _Nullable* _Nonnull err);
+
+/* Destructor, which closes every connection, frees every session and removes the socket */
+void Server_free(CONSUMED Server* _Nullable server);
+
+/* Serves requests until Server_stop is called */
+void Server_run(Server* server);
+
+/* Makes Server_run return. This is safe to call from a signal handler or another thread */
+void Server_stop(Server* server);
+
+ASSUME_NONNULL_END
+
+#endif /* SC_SERVER_H */
@@ -0,0 +1,173 @@
+/*
+  snapshot.c
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include "snapshot.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <sys/mman.h>
+
+#include "generic.h"
+#include "value.h"
+#include "variable.h"
+#include "serial.h"
+
+
+/* Bump whenever the encoding of anything below or in serial.c changes */
+#define SNAPSHOT_VERSION 2
+#define SNAPSHOT_MAGIC "SCI\x1a"
+#define SNAPSHOT_BYTE_ORDER 0x01020304u
+
+struct SnapshotHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t byteOrder;
+	uint32_t mode;
+	uint32_t count;
+	uint32_t reserved;
+	uint64_t bodyHash;
+	uint64_t bodySize;
+};
+
+struct SnapshotBuilder {
+	SerialWriter out;
+	uint32_t count;
+};
+
+
+static void saveVar(const Variable* var, void* data);
+
+
+static void saveVar(const Variable* var, void* data) {
+	struct SnapshotBuilder* builder = data;
+	
+	Serial_putString(&builder->out, var->name);
+	Serial_putValue(&builder->out, var->val);
+	builder->count++;
+}
+
+Error* Snapshot_save(const Context* ctx, const char* path) {
+	struct SnapshotBuilder builder;
+	memset(&builder, 0, sizeof(builder));
+	
+	Context_forEachGlobal(ctx, &saveVar, &builder);
+	
+	if(builder.out.failed) {
+		Serial_freeWriter(&builder.out);
+		return snapshotError("save", path, "A variable can't be saved");
+	}
+	
+	struct SnapshotHeader hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, SNAPSHOT_MAGIC, sizeof(hdr.magic));
+	hdr.version = SNAPSHOT_VERSION;
+	hdr.byteOrder = SNAPSHOT_BYTE_ORDER;
+	hdr.mode = (uint32_t)Context_getMode(ctx);
+	hdr.count = builder.count;
+	hdr.bodyHash = Serial_hash(builder.out.data, builder.out.len);
+	hdr.bodySize = builder.out.len;
+	
+	errno = 0;
+	bool ok = Serial_writeFile(path, &hdr, sizeof(hdr), &builder.out);
+	Serial_freeWriter(&builder.out);
+	
+	if(!ok) {
+		return snapshotError("save", path, strerror(errno ?: EIO));
+	}
+	
+	return NULL;
+}
+
+Error* Snapshot_load(Context* ctx, const char* path) {
+	size_t size;
+	errno = 0;
+	void* map = Serial_mapFile(path, sizeof(struct SnapshotHeader), &size);
+	if(map == NULL) {
+		return snapshotError("load", path, strerror(errno ?: EIO));
+	}
+	
+	struct SnapshotHeader hdr;
+	memcpy(&hdr, map, sizeof(hdr));
+	
+	const uint8_t* body = (const uint8_t*)map + sizeof(hdr);
+	size_t bodySize = size - sizeof(hdr);
+	
+	if(memcmp(hdr.magic, SNAPSHOT_MAGIC, sizeof(hdr.magic)) != 0
+		|| hdr.version != SNAPSHOT_VERSION
+		|| hdr.byteOrder != SNAPSHOT_BYTE_ORDER
+		|| hdr.mode > MODE_EXTENDED)
+	{
+		munmap(map, size);
+		return snapshotError("load", path, "Not a snapshot from this version of SuperCalc");
+	}
+	
+	if(hdr.bodySize != bodySize || hdr.bodyHash != Serial_hash(body, bodySize)) {
+		munmap(map, size);
+		return snapshotError("load", path, "Snapshot is corrupt");
+	}
+	
+	/* Decode everything before touching the context, so a bad file leaves it alone */
+	SerialReader in = {body, body + bodySize};
+	uint32_t count = hdr.count;
+	if(count == 0 || count > bodySize) {
+		munmap(map, size);
+		return snapshotError("load", path, "Snapshot is corrupt");
+	}
+	
+	char** names = fcalloc(count, sizeof(*names));
+	Value** vals = fcalloc(count, sizeof(*vals));
+	
+	uint32_t i;
+	for(i = 0; i < count; i++) {
+		const char* name;
+		uint32_t len;
+		if(!Serial_getString(&in, &name, &len) || name == NULL) {
+			break;
+		}
+		
+		vals[i] = Serial_getValue(&in);
+		if(vals[i] == NULL) {
+			break;
+		}
+		
+		names[i] = strndup(name, len);
+	}
+	
+	munmap(map, size);
+	
+	Error* ret = NULL;
+	if(i < count || in.cur != in.end) {
+		ret = snapshotError("load", path, "Snapshot is corrupt");
+		
+		for(i = 0; i < count; i++) {
+			destroy(names[i]);
+			Value_free(vals[i]);
+		}
+	}
+	else {
+		/* Adopt the decoded globals in their original order */
+		Context_clear(ctx);
+		Context_setMode(ctx, (NUMMODE)hdr.mode);
+		
+		for(i = 0; i < count; i++) {
+			if(strcmp(names[i], "ans") == 0) {
+				Context_setGlobal(ctx, names[i], vals[i]);
+				destroy(names[i]);
+			}
+			else {
+				/* Names in a snapshot are unique, so skip searching for an existing variable */
+				Context_addGlobal(ctx, Variable_new(names[i], vals[i]));
+			}
+		}
+	}
+	
+	destroy(names);
+	destroy(vals);
+	return ret;
+}
@@ -0,0 +1,29 @@
+/*
+  snapshot.h
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#ifndef SC_SNAPSHOT_H
+#define SC_SNAPSHOT_H
+
+#include "context.h"
+#include "error.h"
+#include "annotations.h"
+
+
+ASSUME_NONNULL_BEGIN
+
+/*
+ Session snapshots: every global variable of a context, including functions
+ with their parsed bodies, plus the numeric mode. Loading one replaces the
+ context's globals, so a long setup script only has to run once.
+*/
+RETURNS_OWNED Error* _Nullable Snapshot_save(const Context* ctx, const char* path);
+RETURNS_OWNED Error* _Nullable Snapshot_load(Context* ctx, const char* path);
+
+ASSUME_NONNULL_END
+
+#endif /* SC_SNAPSHOT_H */
@@ -18,6 +18,7 @@
 #include "context.h"
 #include "binop.h"
 #include "function.h"
+#include "symbol.h"
 #include "binop.h"
 
 
@@ -137,7 +138,7 @@ Statement* Statement_parse(const char** expr) {
 		
 		/* Is this an in-place binop like "+="? */
 		if(bin != BIN_UNK) {
-			val = ValExpr(BinOp_new(bin, ValVar(strdup(name)), val));
+			val = ValExpr(BinOp_new(bin, ValVar(Symbol_internStr(name)), val));
 		}
 		
 		ret = Statement_new(Variable_new(name, val));
@@ -147,9 +148,10 @@ Statement* Statement_parse(const char** expr) {
 	return ret;
 }
 
-Value* Statement_eval(const Statement* stmt, Context* ctx, VERBOSITY v) {
+Value* Statement_evalResult(const Statement* stmt, const Context* ctx, VERBOSITY v, bool* updatesAns) {
 	Value* ret;
 	Variable* var = stmt->var;
+	*updatesAns = false;
 	
 	/* Evaluate right side */
 	ret = Value_eval(var->val, ctx);
@@ -159,6 +161,9 @@ Value* Statement_eval(const Statement* stmt, Context* ctx, VERBOSITY v) {
 		return ret;
 	}
 	
+	/* Results are always handed back in lowest terms */
+	Value_canonicalize(ret);
+	
 	/* Statement result is a variable? */
 	if(ret->type == VAL_VAR) {
 		Variable* func = Variable_get(ctx, ret->name);
@@ -168,10 +173,7 @@ Value* Statement_eval(const Statement* stmt, Context* ctx, VERBOSITY v) {
 			return ValErr(err);
 		}
 		
-		if(var->name != NULL) {
-			Context_setGlobal(ctx, CAST_NONNULL(var->name), Value_copy(func->val));
-		}
-		else if((v & (V_REPR|V_TREE|V_XML)) == 0) {
+		if(var->name == NULL && (v & (V_REPR|V_TREE|V_XML)) == 0) {
 			/* Coerce the variable to a Value */
 			Value* val = Variable_eval(func, ctx);
 			Value_free(ret);
@@ -186,6 +188,22 @@ Value* Statement_eval(const Statement* stmt, Context* ctx, VERBOSITY v) {
 			ret = tmp;
 		}
 		
+		*updatesAns = true;
+	}
+	
+	return ret;
+}
+
+Value* Statement_eval(const Statement* stmt, Context* ctx, VERBOSITY v) {
+	Variable* var = stmt->var;
+	
+	bool updatesAns;
+	Value* ret = Statement_evalResult(stmt, ctx, v, &updatesAns);
+	if(ret->type == VAL_ERR) {
+		return ret;
+	}
+	
+	if(updatesAns) {
 		/* Update ans */
 		Context_setGlobal(ctx, "ans", Value_copy(ret));
 		
@@ -194,6 +212,11 @@ Value* Statement_eval(const Statement* stmt, Context* ctx, VERBOSITY v) {
 			Context_setGlobal(ctx, CAST_NONNULL(var->name), Value_copy(ret));
 		}
 	}
+	else if(var->name != NULL && ret->type == VAL_VAR) {
+		/* Assigning one function to another name */
+		Variable* func = CAST_NONNULL(Variable_get(ctx, ret->name));
+		Context_setGlobal(ctx, CAST_NONNULL(var->name), Value_copy(func->val));
+	}
 	
 	return ret;
 }
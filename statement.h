@@ -47,6 +47,9 @@ bool Statement_didError(const Statement* stmt);
 /* Evaluation */
 RETURNS_OWNED Value* Statement_eval(const Statement* stmt, INOUT UNOWNED Context* ctx, VERBOSITY v);
 
+/* Computes the result without storing anything in ctx, and whether Statement_eval would save it to ans */
+RETURNS_OWNED Value* Statement_evalResult(const Statement* stmt, const Context* ctx, VERBOSITY v, OUT bool* updatesAns);
+
 /* Printing */
 RETURNS_OWNED char* Statement_repr(const Statement* stmt, const Context* ctx, bool pretty);
 RETURNS_OWNED char* Statement_wrap(const Statement* stmt, const Context* ctx);
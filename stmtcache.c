@@ -0,0 +1,227 @@
+/*
+  stmtcache.c
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include "stmtcache.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "generic.h"
+
+
+struct CacheEntry {
+	char* text;
+	size_t len;
+	uint32_t hash;
+	OWNED Statement* stmt;
+	
+	/* Next entry in the same bucket */
+	struct CacheEntry* _Nullable chain;
+	
+	/* Recency list, newest first */
+	struct CacheEntry* _Nullable newer;
+	struct CacheEntry* _Nullable older;
+};
+
+struct StmtCache {
+	struct CacheEntry* _Nullable* buckets;
+	size_t mask;
+	struct CacheEntry* _Nullable newest;
+	struct CacheEntry* _Nullable oldest;
+	unsigned count;
+	unsigned capacity;
+	unsigned long long hits;
+	unsigned long long misses;
+};
+
+
+static uint32_t hashText(const char* text, size_t len);
+static struct CacheEntry* _Nullable* findLink(StmtCache* cache, const char* text, size_t len, uint32_t hash);
+static void unlinkRecent(StmtCache* cache, struct CacheEntry* entry);
+static void pushRecent(StmtCache* cache, struct CacheEntry* entry);
+static void freeEntry(struct CacheEntry* entry);
+static void evictOldest(StmtCache* cache);
+
+
+StmtCache* StmtCache_new(unsigned capacity) {
+	StmtCache* ret = fmalloc(sizeof(*ret));
+	
+	/* Keep chains short by having at least twice as many buckets as entries */
+	size_t size = 16;
+	while(size < 2 * (size_t)capacity) {
+		size *= 2;
+	}
+	
+	ret->buckets = fcalloc(size, sizeof(*ret->buckets));
+	ret->mask = size - 1;
+	ret->capacity = capacity ? capacity : 1;
+	
+	return ret;
+}
+
+void StmtCache_free(StmtCache* cache) {
+	if(!cache) {
+		return;
+	}
+	
+	StmtCache_clear(cache);
+	destroy(cache->buckets);
+	destroy(cache);
+}
+
+/* FNV-1a */
+static uint32_t hashText(const char* text, size_t len) {
+	uint32_t hash = 2166136261u;
+	
+	size_t i;
+	for(i = 0; i < len; i++) {
+		hash ^= (unsigned char)text[i];
+		hash *= 16777619u;
+	}
+	
+	return hash;
+}
+
+/* Returns the link that points at the matching entry, or at the NULL ending its bucket */
+static struct CacheEntry** findLink(StmtCache* cache, const char* text, size_t len, uint32_t hash) {
+	struct CacheEntry** link = &cache->buckets[hash & cache->mask];
+	
+	while(*link != NULL) {
+		struct CacheEntry* entry = *link;
+		if(entry->hash == hash && entry->len == len && memcmp(entry->text, text, len) == 0) {
+			break;
+		}
+		
+		link = &entry->chain;
+	}
+	
+	return link;
+}
+
+static void unlinkRecent(StmtCache* cache, struct CacheEntry* entry) {
+	if(entry->newer != NULL) {
+		entry->newer->older = entry->older;
+	}
+	else {
+		cache->newest = entry->older;
+	}
+	
+	if(entry->older != NULL) {
+		entry->older->newer = entry->newer;
+	}
+	else {
+		cache->oldest = entry->newer;
+	}
+	
+	entry->newer = entry->older = NULL;
+}
+
+static void pushRecent(StmtCache* cache, struct CacheEntry* entry) {
+	entry->newer = NULL;
+	entry->older = cache->newest;
+	
+	if(cache->newest != NULL) {
+		cache->newest->newer = entry;
+	}
+	else {
+		cache->oldest = entry;
+	}
+	
+	cache->newest = entry;
+}
+
+static void freeEntry(struct CacheEntry* entry) {
+	Statement_free(entry->stmt);
+	destroy(entry->text);
+	destroy(entry);
+}
+
+static void evictOldest(StmtCache* cache) {
+	struct CacheEntry* victim = CAST_NONNULL(cache->oldest);
+	
+	struct CacheEntry** link = findLink(cache, victim->text, victim->len, victim->hash);
+	*link = victim->chain;
+	unlinkRecent(cache, victim);
+	
+	freeEntry(victim);
+	--cache->count;
+}
+
+const Statement* StmtCache_get(StmtCache* cache, const char* text, size_t len) {
+	struct CacheEntry* entry = *findLink(cache, text, len, hashText(text, len));
+	if(entry == NULL) {
+		++cache->misses;
+		return NULL;
+	}
+	
+	++cache->hits;
+	
+	if(entry != cache->newest) {
+		unlinkRecent(cache, entry);
+		pushRecent(cache, entry);
+	}
+	
+	return entry->stmt;
+}
+
+const Statement* StmtCache_put(StmtCache* cache, const char* text, size_t len, Statement* stmt) {
+	uint32_t hash = hashText(text, len);
+	struct CacheEntry** link = findLink(cache, text, len, hash);
+	
+	if(*link != NULL) {
+		/* Already cached, so just replace the statement */
+		struct CacheEntry* entry = *link;
+		Statement_free(entry->stmt);
+		entry->stmt = stmt;
+		
+		unlinkRecent(cache, entry);
+		pushRecent(cache, entry);
+		return stmt;
+	}
+	
+	if(cache->count == cache->capacity) {
+		evictOldest(cache);
+		
+		/* Eviction may have changed the bucket chain */
+		link = findLink(cache, text, len, hash);
+	}
+	
+	struct CacheEntry* entry = fmalloc(sizeof(*entry));
+	entry->text = strndup(text, len);
+	entry->len = len;
+	entry->hash = hash;
+	entry->stmt = stmt;
+	entry->chain = NULL;
+	
+	*link = entry;
+	pushRecent(cache, entry);
+	++cache->count;
+	
+	return stmt;
+}
+
+void StmtCache_clear(StmtCache* cache) {
+	struct CacheEntry* entry = cache->newest;
+	while(entry != NULL) {
+		struct CacheEntry* next = entry->older;
+		freeEntry(entry);
+		entry = next;
+	}
+	
+	memset(cache->buckets, 0, (cache->mask + 1) * sizeof(*cache->buckets));
+	cache->newest = cache->oldest = NULL;
+	cache->count = 0;
+}
+
+unsigned long long StmtCache_hits(const StmtCache* cache) {
+	return cache->hits;
+}
+
+unsigned long long StmtCache_misses(const StmtCache* cache) {
+	return cache->misses;
+}
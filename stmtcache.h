@@ -0,0 +1,50 @@
+/*
+  stmtcache.h
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#ifndef SC_STMTCACHE_H
+#define SC_STMTCACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct StmtCache StmtCache;
+#include "statement.h"
+#include "annotations.h"
+
+
+ASSUME_NONNULL_BEGIN
+
+/*
+ Bounded map from a line's source text to its parsed statement. Parsing
+ doesn't depend on the context, so a repeated line can reuse the tree and
+ only pay for evaluation. Once full, the least recently used entry is
+ evicted.
+*/
+
+/* Constructor */
+RETURNS_OWNED StmtCache* StmtCache_new(unsigned capacity);
+
+/* Destructor */
+void StmtCache_free(CONSUMED StmtCache* _Nullable cache);
+
+/* Returns the cached statement for this text, or NULL after counting a miss */
+RETURNS_UNOWNED const Statement* _Nullable StmtCache_get(StmtCache* cache, const char* text, size_t len);
+
+/* Takes ownership of `stmt`, which stays valid until it is evicted or the cache is cleared */
+RETURNS_UNOWNED const Statement* StmtCache_put(StmtCache* cache, const char* text, size_t len, CONSUMED Statement* stmt);
+
+/* Drops every entry, for when the same text would now parse differently */
+void StmtCache_clear(StmtCache* cache);
+
+/* Counters */
+unsigned long long StmtCache_hits(const StmtCache* cache);
+unsigned long long StmtCache_misses(const StmtCache* cache);
+
+ASSUME_NONNULL_END
+
+#endif /* SC_STMTCACHE_H */
@@ -0,0 +1,222 @@
+/*
+  subscript.c
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include "subscript.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "support.h"
+#include "error.h"
+#include "generic.h"
+#include "value.h"
+#include "context.h"
+#include "variable.h"
+#include "arglist.h"
+#include "vector.h"
+
+
+static char* wrapBase(const Value* base, char* str);
+
+
+Subscript* Subscript_new(Value* base, Value* index) {
+	Subscript* ret = fmalloc(sizeof(*ret));
+	
+	ret->base = base;
+	ret->indices = ArgList_new(1);
+	ret->indices->args[0] = index;
+	
+	return ret;
+}
+
+void Subscript_free(Subscript* sub) {
+	if(!sub) {
+		return;
+	}
+	
+	Value_free(sub->base);
+	ArgList_free(sub->indices);
+	destroy(sub);
+}
+
+Subscript* Subscript_copy(const Subscript* sub) {
+	Subscript* ret = fmalloc(sizeof(*ret));
+	
+	ret->base = Value_copy(sub->base);
+	ret->indices = ArgList_copy(sub->indices);
+	
+	return ret;
+}
+
+void Subscript_append(Subscript* sub, Value* index) {
+	ArgList* indices = sub->indices;
+	indices->args = frealloc(indices->args, (indices->count + 1) * sizeof(*indices->args));
+	indices->args[indices->count++] = index;
+}
+
+Value* Subscript_eval(const Subscript* sub, const Context* ctx) {
+	/* The vector being indexed, which `owned` holds onto when it isn't borrowed */
+	const Value* vec = NULL;
+	Value* owned = NULL;
+	
+	/* Index straight into a variable's vector instead of evaluating a copy of all of it */
+	if(sub->base->type == VAL_VAR) {
+		Variable* var = Value_lookup(sub->base, ctx);
+		if(var != NULL && var->val->type == VAL_VEC) {
+			vec = var->val;
+		}
+	}
+	
+	if(vec == NULL) {
+		vec = owned = Value_coerce(sub->base, ctx);
+	}
+	
+	unsigned i;
+	for(i = 0; i < sub->indices->count; i++) {
+		if(vec->type == VAL_ERR) {
+			return CAST_NONNULL(owned);
+		}
+		
+		if(vec->type != VAL_VEC) {
+			Value_free(owned);
+			return ValErr(typeError("Only vectors are subscriptable."));
+		}
+		
+		Value* index = Value_coerce(sub->indices->args[i], ctx);
+		if(index->type == VAL_ERR) {
+			Value_free(owned);
+			return index;
+		}
+		
+		Error* err = NULL;
+		const Value* elem = Vector_at(vec->vec, index, &err);
+		Value_free(index);
+		
+		if(elem == NULL) {
+			Value_free(owned);
+			return ValErr(CAST_NONNULL(err));
+		}
+		
+		/* Nested vectors are still part of the one being borrowed or owned, so keep going */
+		if(elem->type == VAL_VEC || i + 1 == sub->indices->count) {
+			vec = elem;
+		}
+		else {
+			Value* next = Value_coerce(elem, ctx);
+			Value_free(owned);
+			vec = owned = next;
+		}
+	}
+	
+	Value* ret = Value_eval(vec, ctx);
+	Value_free(owned);
+	return ret;
+}
+
+static char* wrapBase(const Value* base, char* str) {
+	/* Operators bind less tightly than brackets */
+	if(base->type != VAL_EXPR && base->type != VAL_UNARY) {
+		return str;
+	}
+	
+	char* ret;
+	asprintf(&ret, "(%s)", str);
+	destroy(str);
+	return ret;
+}
+
+char* Subscript_repr(const Subscript* sub, bool pretty) {
+	char* ret = wrapBase(sub->base, Value_repr(sub->base, pretty, false));
+	
+	unsigned i;
+	for(i = 0; i < sub->indices->count; i++) {
+		char* index = Value_repr(sub->indices->args[i], pretty, false);
+		char* tmp;
+		asprintf(&tmp, "%s[%s]", ret, index);
+		destroy(index);
+		destroy(ret);
+		ret = tmp;
+	}
+	
+	return ret;
+}
+
+char* Subscript_wrap(const Subscript* sub) {
+	char* ret = wrapBase(sub->base, Value_wrap(sub->base, false));
+	
+	unsigned i;
+	for(i = 0; i < sub->indices->count; i++) {
+		char* index = Value_wrap(sub->indices->args[i], false);
+		char* tmp;
+		asprintf(&tmp, "%s[%s]", ret, index);
+		destroy(index);
+		destroy(ret);
+		ret = tmp;
+	}
+	
+	return ret;
+}
+
+char* Subscript_verbose(const Subscript* sub, unsigned indent) {
+	char* ret = Value_verbose(sub->base, indent);
+	
+	unsigned i;
+	for(i = 0; i < sub->indices->count; i++) {
+		char* index = Value_verbose(sub->indices->args[i], indent + 1);
+		char* tmp;
+		asprintf(&tmp,
+				 "%3$s[\n"
+					 "%2$s%4$s\n" /* index */
+				 "%1$s]",
+				 indentation(indent), indentation(indent + 1),
+				 ret, index);
+		destroy(index);
+		destroy(ret);
+		ret = tmp;
+	}
+	
+	return ret;
+}
+
+char* Subscript_xml(const Subscript* sub, unsigned indent) {
+	/*
+	 sc> ?x v[2][i]
+	
+	 <subscript>
+	   <vector>
+	     <var name="v"/>
+	   </vector>
+	   <indices>
+	     <int>2</int>
+	     <var name="i"/>
+	   </indices>
+	 </subscript>
+	
+	 7
+	*/
+	char* ret;
+	char* base = Value_xml(sub->base, indent + 2);
+	char* indices = ArgList_xml(sub->indices, indent + 2);
+	
+	asprintf(&ret,
+			 "<subscript>\n"
+				 "%2$s<vector>\n"
+					 "%3$s%4$s\n" /* base */
+				 "%2$s</vector>\n"
+				 "%2$s<indices>\n"
+					 "%5$s\n" /* indices */
+				 "%2$s</indices>\n"
+			 "%1$s</subscript>",
+			 indentation(indent), indentation(indent + 1), indentation(indent + 2),
+			 base,
+			 indices);
+	
+	destroy(indices);
+	destroy(base);
+	return ret;
+}
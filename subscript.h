@@ -0,0 +1,56 @@
+/*
+  subscript.h
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#ifndef SC_SUBSCRIPT_H
+#define SC_SUBSCRIPT_H
+
+#include <stdbool.h>
+
+typedef struct Subscript Subscript;
+
+#include "context.h"
+#include "value.h"
+#include "arglist.h"
+#include "generic.h"
+
+
+ASSUME_NONNULL_BEGIN
+
+/* Indexing into a vector, like "v[i]". Chained indices like "v[i][j]" are one node */
+struct Subscript {
+	OWNED Value* base;
+	
+	/* One for each pair of brackets, applied from left to right */
+	OWNED ArgList* indices;
+};
+
+
+/* Constructor */
+RETURNS_OWNED Subscript* Subscript_new(CONSUMED Value* base, CONSUMED Value* index);
+
+/* Destructor */
+void Subscript_free(CONSUMED Subscript* _Nullable sub);
+
+/* Copying */
+RETURNS_OWNED Subscript* Subscript_copy(const Subscript* sub);
+
+/* Adds another pair of brackets to the end */
+void Subscript_append(Subscript* sub, CONSUMED Value* index);
+
+/* Evaluation */
+RETURNS_OWNED Value* Subscript_eval(const Subscript* sub, const Context* ctx);
+
+/* Printing */
+RETURNS_OWNED char* Subscript_repr(const Subscript* sub, bool pretty);
+RETURNS_OWNED char* Subscript_wrap(const Subscript* sub);
+RETURNS_OWNED char* Subscript_verbose(const Subscript* sub, unsigned indent);
+RETURNS_OWNED char* Subscript_xml(const Subscript* sub, unsigned indent);
+
+ASSUME_NONNULL_END
+
+#endif /* SC_SUBSCRIPT_H */
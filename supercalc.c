@@ -12,28 +12,148 @@
 #include <string.h>
 #include <stdbool.h>
 #include <errno.h>
+#include <limits.h>
+#include <sys/stat.h>
 
 #include "error.h"
 #include "generic.h"
 #include "value.h"
 #include "context.h"
 #include "statement.h"
-#include "defaults.h"
+#include "linereader.h"
+#include "stmtcache.h"
+#include "scc.h"
+#include "snapshot.h"
+#include "workpool.h"
+#include "jsonl.h"
+#include "parser.h"
 
 
-static void SC_registerModules(SuperCalc* sc) {
-	/* Register modules */
-	register_math(sc->ctx);
-	register_vector(sc->ctx);
-}
+/* Number of distinct lines whose parsed statements are kept around */
+#define SC_STMTCACHE_SIZE 256
+
+/* Imported files are fed to the parser in chunks of about this size */
+#define SC_IMPORT_CHUNK (64 * 1024)
+
+/* Batch output is flushed in chunks of this size */
+#define SC_BATCH_BUFSIZE (256 * 1024)
+
+/* Results are collected here and written out in large chunks */
+struct BatchOutput {
+	UNOWNED FILE* fp;
+	OWNED char* buf;
+	size_t len;
+};
+
+/*
+ Most lines that are evaluated in parallel before writing their results. Any
+ more than the statement cache holds, and parsing the last ones could evict
+ statements that are still waiting to run.
+*/
+#define SC_JOBS_CHUNK SC_STMTCACHE_SIZE
+
+/* Fewest lines in a row that are worth evaluating in parallel */
+#define SC_JOBS_MIN 16
+
+/* A line waiting to be evaluated in parallel with its neighbors */
+struct PendingLine {
+	unsigned lineNumber;
+	UNOWNED const Statement* _Nullable stmt;
+	OWNED Statement* _Nullable owned;
+	OWNED Value* _Nullable result;
+	bool updatesAns;
+	bool ansRead;
+};
+
+struct ParallelRun {
+	UNOWNED const Context* ctx;
+	OWNED WorkPool* pool;
+	OWNED struct PendingLine* lines;
+	size_t count;
+};
+
+/* An entry of a compiled import, which is either a statement or a line to parse */
+struct CompiledEntry {
+	OWNED Statement* _Nullable stmt;
+	OWNED char* _Nullable line;
+	unsigned lineNumber;
+};
+
+
+/*
+ Commands are a keyword followed by a quoted argument, like: mode "float"
+ A string literal can't appear in an expression, so this doesn't take any
+ names away from variables.
+*/
+typedef Value* _Nullable (*sc_command_t)(SuperCalc* sc, const char* arg);
+
+static Value* _Nullable SC_cmdMode(SuperCalc* sc, const char* arg);
+static Value* _Nullable SC_cmdDecimals(SuperCalc* sc, const char* arg);
+static Value* _Nullable SC_cmdSave(SuperCalc* sc, const char* arg);
+static Value* _Nullable SC_cmdLoad(SuperCalc* sc, const char* arg);
+static Value* _Nullable SC_runCommand(SuperCalc* sc, const ParsedLine* line);
+static Value* _Nullable SC_runLine(SuperCalc* sc, char* code, VERBOSITY v);
+static Value* _Nullable SC_runParsed(SuperCalc* sc, ParsedLine* line);
+static Value* _Nullable SC_runParser(SuperCalc* sc, Parser* parser);
+static void SC_runInteractive(SuperCalc* sc, Parser* parser);
+static Error* _Nullable SC_takeError(CONSUMED Value* _Nullable val);
+static Value* _Nullable SC_parseLine(SuperCalc* sc, const char* p, OUT const Statement* _Nullable* _Nonnull stmt, OUT Statement* _Nullable* _Nonnull owned);
+static Value* SC_runStatement(SuperCalc* sc, const Statement* stmt, VERBOSITY v);
+static void SC_recordLine(SuperCalc* sc, const char* line);
+static void SC_flushJsonl(SerialWriter* buf, FILE* out);
+static Prepared* _Nullable SC_prepare(SuperCalc* sc, const char* expr, OUT Error* _Nullable* _Nonnull err);
+static int* _Nullable SC_csvColumns(const Prepared* prep, char* header, OUT unsigned* count, OUT Error* _Nullable* _Nonnull err);
+static char* _Nullable SC_nextCsvField(INOUT char* _Nullable* _Nonnull cursor);
+static Value* SC_parseCell(SuperCalc* sc, char* cell);
+static void SC_evalPending(void* _Nullable data, size_t index);
+static unsigned SC_flushPending(SuperCalc* sc, struct BatchOutput* output, struct ParallelRun* run);
+static unsigned SC_runParallel(SuperCalc* sc, struct BatchOutput* output);
+static void SC_flushOutput(struct BatchOutput* output);
+static void SC_writeOutput(struct BatchOutput* output, const char* str, size_t len);
+static void SC_writePrefix(struct BatchOutput* output, unsigned lineNumber, char kind);
+static bool SC_writeResult(struct BatchOutput* output, unsigned lineNumber, const Value* val);
+static struct CompiledEntry* _Nullable SC_decodeCompiled(SccReader* compiled, OUT size_t* count);
+static Error* _Nullable SC_runCompiled(SuperCalc* sc, CONSUMED struct CompiledEntry* entries, size_t count, const char* filename);
+static Error* _Nullable SC_loadFile(SuperCalc* sc, const char* filename);
+static Error* _Nullable SC_import(SuperCalc* sc, const char* filename, bool force);
+static void SC_forgetImports(SuperCalc* sc);
+
+static const struct {
+	const char* name;
+	sc_command_t func;
+} _sc_commands[] = {
+	{"mode", &SC_cmdMode},
+	{"decimals", &SC_cmdDecimals},
+	{"save", &SC_cmdSave},
+	{"load", &SC_cmdLoad}
+};
+
+/* Identifies one version of an imported file */
+struct ImportedFile {
+	OWNED char* path; /* Canonical path */
+	dev_t dev;
+	ino_t ino;
+	struct timespec mtime;
+	struct ImportedFile* _Nullable next;
+};
+
+static const char* _sc_mode_names[] = {
+	"exact", "float", "extended"
+};
+
 
 SuperCalc* SuperCalc_new(void) {
 	SuperCalc* ret = fmalloc(sizeof(*ret));
 	
 	/* Create context */
 	ret->ctx = Context_new();
+	ret->cache = StmtCache_new(SC_STMTCACHE_SIZE);
+	ret->symbols = SymbolTable_new();
 	
-	SC_registerModules(ret);
+	/* Continuation lines come from wherever the creating thread reads them */
+	InputState_init(&ret->input);
+	ret->input.file = Input_current()->file;
+	ret->input.symbols = ret->symbols;
 	
 	return ret;
 }
@@ -44,9 +164,34 @@ void SuperCalc_free(SuperCalc* sc) {
 	}
 	
 	Context_free(sc->ctx);
+	StmtCache_free(sc->cache);
+	SymbolTable_free(sc->symbols);
+	SC_forgetImports(sc);
+	InputState_destroy(&sc->input);
 	destroy(sc);
 }
 
+SuperCalc* SuperCalc_newSession(const SuperCalc* lib) {
+	SuperCalc* ret = SuperCalc_new();
+	Context_free(ret->ctx);
+	ret->ctx = Context_newShared(lib->ctx);
+	ret->compileImports = lib->compileImports;
+	
+	/* Files imported by the library are already visible, so importing them again does nothing */
+	struct ImportedFile* mod;
+	struct ImportedFile** next = &ret->imported;
+	for(mod = lib->imported; mod != NULL; mod = mod->next) {
+		struct ImportedFile* copy = fmalloc(sizeof(*copy));
+		*copy = *mod;
+		copy->path = strdup(mod->path);
+		copy->next = NULL;
+		*next = copy;
+		next = &copy->next;
+	}
+	
+	return ret;
+}
+
 void SuperCalc_run(SuperCalc* sc) {
 	const char* prompt = "";
 	
@@ -59,148 +204,1079 @@ void SuperCalc_run(SuperCalc* sc) {
 #endif
 	}
 	
-	while((g_line = nextLine(prompt))) {
-		char* p = g_line;
+	InputState* old = Input_enter(&sc->input);
+	
+	/* Lines are read here and handed to the parser, which waits for the rest of a statement */
+	Parser* parser = Parser_new(sc->input.fileName);
+	Parser_allowVerbosity(parser);
+	Parser_useCache(parser, sc->cache);
+	
+	char* line;
+	while((line = nextLine(Parser_hasPending(parser) ? SC_PROMPT_CONTINUE : prompt))) {
+		Parser_feed(parser, line, strlen(line));
+		Parser_feed(parser, "\n", 1);
+		SC_runInteractive(sc, parser);
+	}
+	
+	Parser_finish(parser);
+	SC_runInteractive(sc, parser);
+	Parser_free(parser);
+	
+	Input_enter(old);
+	putchar('\n');
+}
+
+static void SC_runInteractive(SuperCalc* sc, Parser* parser) {
+	ParsedLine line;
+	while(Parser_next(parser, &line) == PARSE_LINE) {
+		Value* ret = SC_runParsed(sc, &line);
+		if(ret != NULL) {
+			if(ret->type != VAL_VAR) {
+				Value_print(ret, line.verbosity);
+			}
+			Value_free(ret);
+		}
+		
+		ParsedLine_destroy(&line);
+	}
+}
+
+unsigned SuperCalc_runBatch(SuperCalc* sc, int in, FILE* out) {
+	struct BatchOutput output = {out, fmalloc(SC_BATCH_BUFSIZE), 0};
+	
+	/* Statements that continue onto more lines read them through this reader too */
+	LineReader* reader = LineReader_fromFd(in);
+	InputState* old = Input_enter(&sc->input);
+	LineReader* oldReader = sc->input.reader;
+	sc->input.reader = reader;
+	sc->input.lineNumber = 0;
+	
+	unsigned errors;
+	if(sc->jobs > 1) {
+		errors = SC_runParallel(sc, &output);
+	}
+	else {
+		errors = 0;
 		
-		/* I solemnly swear not to modify the string's contents. Pinky promise :) */
-		VERBOSITY v = getVerbosity((istring)&p);
-		if(v & V_ERR) {
+		char* line;
+		while((line = nextLine("")) != NULL) {
+			/* Verbosity prefixes print parse trees, which don't fit the output format */
+			unsigned lineNumber = sc->input.lineNumber;
+			Value* ret = SC_runLine(sc, line, V_NONE);
+			if(ret != NULL) {
+				if(!SC_writeResult(&output, lineNumber, ret)) {
+					errors++;
+				}
+				Value_free(ret);
+			}
+		}
+	}
+	
+	sc->input.reader = oldReader;
+	sc->input.line = NULL;
+	Input_enter(old);
+	LineReader_free(reader);
+	
+	SC_flushOutput(&output);
+	fflush(out);
+	destroy(output.buf);
+	return errors;
+}
+
+unsigned SuperCalc_runJsonl(SuperCalc* sc, int in, FILE* out) {
+	LineReader* reader = LineReader_fromFd(in);
+	
+	/* Continuation lines come from the expression itself, never from the rest of the requests */
+	LineReader* empty = LineReader_empty();
+	InputState* old = Input_enter(&sc->input);
+	LineReader* oldReader = sc->input.reader;
+	sc->input.reader = empty;
+	sc->input.lineNumber = 0;
+	
+	SerialWriter buf;
+	memset(&buf, 0, sizeof(buf));
+	
+	unsigned errors = 0;
+	char* line;
+	while((line = LineReader_next(reader)) != NULL) {
+		sc->input.line = line;
+		sc->input.lineNumber++;
+		
+		const char* p = line;
+		trimSpaces(&p);
+		if(*p != '\0') {
+			JsonlRequest req;
+			Error* err = Jsonl_parseRequest(line, &req);
+			Value* result;
+			if(err != NULL) {
+				result = ValErr(err);
+			}
+			else {
+				/* An expression may hold several lines, and errors are positioned within them */
+				result = SuperCalc_runLines(sc, CAST_NONNULL(req.expr));
+			}
+			
+			if(result != NULL && result->type == VAL_ERR) {
+				errors++;
+				if(!Error_canRecover(result->err)) {
+					SC_flushJsonl(&buf, out);
+					Error_raise(result->err, true);
+					UNREACHABLE;
+				}
+			}
+			
+			Jsonl_writeResponse(&buf, &req, result);
+			Value_free(result);
+			Jsonl_freeRequest(&req);
+		}
+		
+		/* Requests can be pipelined, but the client may also be waiting on these responses */
+		if(buf.len >= SC_BATCH_BUFSIZE || !LineReader_hasLine(reader)) {
+			SC_flushJsonl(&buf, out);
+		}
+	}
+	
+	sc->input.reader = oldReader;
+	sc->input.line = NULL;
+	Input_enter(old);
+	LineReader_free(empty);
+	LineReader_free(reader);
+	
+	SC_flushJsonl(&buf, out);
+	Serial_freeWriter(&buf);
+	return errors;
+}
+
+static void SC_flushJsonl(SerialWriter* buf, FILE* out) {
+	if(buf->len > 0) {
+		fwrite(buf->data, 1, buf->len, out);
+		buf->len = 0;
+	}
+	
+	fflush(out);
+}
+
+Prepared* SuperCalc_prepare(SuperCalc* sc, const char* expr, Error** err) {
+	/* The expression is complete on its own, so there's nowhere to read continuation lines from */
+	LineReader* empty = LineReader_empty();
+	InputState* old = Input_enter(&sc->input);
+	LineReader* oldReader = sc->input.reader;
+	sc->input.reader = empty;
+	
+	Prepared* ret = SC_prepare(sc, expr, err);
+	
+	sc->input.reader = oldReader;
+	Input_enter(old);
+	LineReader_free(empty);
+	return ret;
+}
+
+static Prepared* SC_prepare(SuperCalc* sc, const char* expr, Error** err) {
+	/* I pinky promise not to modify expr's contents */
+	sc->input.line = (char*)expr;
+	Prepared* ret = Prepared_new(sc->ctx, expr, err);
+	sc->input.line = NULL;
+	return ret;
+}
+
+unsigned SuperCalc_runCsv(SuperCalc* sc, const char* expr, int in, FILE* out) {
+	struct BatchOutput output = {out, fmalloc(SC_BATCH_BUFSIZE), 0};
+	LineReader* reader = LineReader_fromFd(in);
+	
+	/* Neither the expression nor a field can continue onto the next line */
+	LineReader* empty = LineReader_empty();
+	InputState* old = Input_enter(&sc->input);
+	LineReader* oldReader = sc->input.reader;
+	const char* oldFileName = sc->input.fileName;
+	sc->input.reader = empty;
+	sc->input.fileName = NULL;
+	sc->input.lineNumber = 0;
+	
+	unsigned errors = 0;
+	unsigned columnCount = 0;
+	int* columns = NULL;
+	Error* err = NULL;
+	
+	/* The header row says which parameter each column is for */
+	Prepared* prep = SC_prepare(sc, expr, &err);
+	if(prep != NULL) {
+		char noHeader[1] = "";
+		char* header = LineReader_next(reader);
+		sc->input.lineNumber = 1;
+		columns = SC_csvColumns(CAST_NONNULL(prep), header ?: noHeader, &columnCount, &err);
+	}
+	
+	char** cells = columns != NULL ? fcalloc(columnCount, sizeof(*cells)) : NULL;
+	
+	if(err != NULL) {
+		Error_raise(err, false);
+		Error_free(err);
+		errors++;
+	}
+	
+	char* line;
+	while(columns != NULL && (line = LineReader_next(reader)) != NULL) {
+		sc->input.lineNumber++;
+		line = strsep(&line, "\r");
+		
+		const char* p = line;
+		trimSpaces(&p);
+		if(*p == '\0') {
 			continue;
 		}
 		
-		Value* ret = SuperCalc_runLine(sc, p, v);
+		/* Split the whole row first, so a row with the wrong number of fields isn't evaluated at all */
+		unsigned fields = 0;
+		char* cursor = line;
+		char* cell;
+		while((cell = SC_nextCsvField(&cursor)) != NULL) {
+			if(fields < columnCount) {
+				cells[fields] = cell;
+			}
+			fields++;
+		}
+		
+		Value* result = NULL;
+		if(fields != columnCount) {
+			result = ValErr(csvFields(columnCount, fields));
+		}
+		
+		/* Bind each field to its column's parameter */
+		unsigned i;
+		for(i = 0; result == NULL && i < columnCount; i++) {
+			if(columns[i] >= 0) {
+				Value* val = SC_parseCell(sc, cells[i]);
+				if(val->type == VAL_ERR) {
+					result = val;
+					break;
+				}
+				
+				Prepared_bind(CAST_NONNULL(prep), (unsigned)columns[i], val);
+			}
+		}
+		
+		if(result == NULL) {
+			result = Prepared_eval(CAST_NONNULL(prep));
+		}
+		
+		if(!SC_writeResult(&output, sc->input.lineNumber, result)) {
+			errors++;
+		}
+		Value_free(result);
+	}
+	
+	sc->input.reader = oldReader;
+	sc->input.line = NULL;
+	sc->input.fileName = oldFileName;
+	Input_enter(old);
+	destroy(cells);
+	destroy(columns);
+	Prepared_free(prep);
+	LineReader_free(empty);
+	LineReader_free(reader);
+	
+	SC_flushOutput(&output);
+	fflush(out);
+	destroy(output.buf);
+	return errors;
+}
+
+static int* SC_csvColumns(const Prepared* prep, char* header, unsigned* count, Error** err) {
+	*count = 0;
+	*err = NULL;
+	
+	/* Columns that aren't parameters are skipped */
+	unsigned capacity = 8;
+	int* ret = fcalloc(capacity, sizeof(*ret));
+	char* cursor = strsep(&header, "\r");
+	char* name;
+	while((name = SC_nextCsvField(&cursor)) != NULL) {
+		if(*count == capacity) {
+			capacity *= 2;
+			ret = frealloc(ret, capacity * sizeof(*ret));
+		}
+		
+		ret[(*count)++] = Prepared_paramIndex(prep, name);
+	}
+	
+	unsigned i;
+	for(i = 0; i < Prepared_paramCount(prep); i++) {
+		bool found = false;
+		unsigned col;
+		for(col = 0; col < *count; col++) {
+			found = found || ret[col] == (int)i;
+		}
+		
+		if(!found) {
+			*err = missingColumn(Prepared_paramName(prep, i));
+			destroy(ret);
+			return NULL;
+		}
+	}
+	
+	return ret;
+}
+
+static char* SC_nextCsvField(char** cursor) {
+	char* p = *cursor;
+	if(p == NULL) {
+		return NULL;
+	}
+	
+	while(*p == ' ' || *p == '\t') {
+		p++;
+	}
+	
+	/* Quoted fields can contain commas, with "" standing for a quote. They're unquoted in place */
+	char* field = p;
+	char* end = p;
+	bool quoted = *p == '"';
+	if(quoted) {
+		p++;
+		while(*p != '\0') {
+			if(*p == '"') {
+				if(p[1] != '"') {
+					p++;
+					break;
+				}
+				p++;
+			}
+			*end++ = *p++;
+		}
+	}
+	
+	char* comma = strchr(p, ',');
+	*cursor = comma != NULL ? comma + 1 : NULL;
+	
+	if(!quoted) {
+		end = comma ?: p + strlen(p);
+		while(end > field && (end[-1] == ' ' || end[-1] == '\t')) {
+			end--;
+		}
+	}
+	
+	*end = '\0';
+	return field;
+}
+
+static Value* SC_parseCell(SuperCalc* sc, char* cell) {
+	/* Error positions are relative to the cell */
+	sc->input.line = cell;
+	
+	const char* p = cell;
+	Value* parsed = Value_parseTop(&p);
+	if(parsed->type == VAL_ERR || Value_isNumber(parsed)) {
+		return parsed;
+	}
+	
+	/* Allows cells like 1/3 or <1, 2> */
+	Value* ret = Value_eval(parsed, sc->ctx);
+	Value_free(parsed);
+	return ret;
+}
+
+static void SC_evalPending(void* data, size_t index) {
+	struct ParallelRun* run = data;
+	struct PendingLine* pending = &run->lines[index];
+	if(pending->result != NULL) {
+		/* Failed to parse */
+		return;
+	}
+	
+	Context* fork = Context_fork(run->ctx, &pending->ansRead);
+	pending->result = Statement_evalResult(CAST_NONNULL(pending->stmt), fork, V_NONE, &pending->updatesAns);
+	Context_freeFork(fork);
+}
+
+static unsigned SC_flushPending(SuperCalc* sc, struct BatchOutput* output, struct ParallelRun* run) {
+	/* Waking the workers costs more than evaluating a few lines */
+	bool parallel = run->count >= SC_JOBS_MIN;
+	if(parallel) {
+		WorkPool_run(run->pool, run->count, &SC_evalPending, run);
+	}
+	
+	unsigned errors = 0;
+	size_t i;
+	for(i = 0; i < run->count; i++) {
+		struct PendingLine* pending = &run->lines[i];
+		Value* result = pending->result;
+		
+		if(pending->stmt != NULL) {
+			if(!parallel) {
+				result = Statement_eval(CAST_NONNULL(pending->stmt), sc->ctx, V_NONE);
+			}
+			else if(i > 0 && pending->ansRead) {
+				/* It saw ans from before this run instead of the previous line's result, so run it again */
+				Value_free(result);
+				result = Statement_eval(CAST_NONNULL(pending->stmt), sc->ctx, V_NONE);
+			}
+			else if(pending->updatesAns && result->type != VAL_ERR) {
+				Context_setGlobal(sc->ctx, "ans", Value_copy(result));
+			}
+			
+			Statement_free(pending->owned);
+		}
+		
+		if(!SC_writeResult(output, pending->lineNumber, CAST_NONNULL(result))) {
+			errors++;
+		}
+		
+		Value_free(result);
+	}
+	
+	memset(run->lines, 0, run->count * sizeof(*run->lines));
+	run->count = 0;
+	return errors;
+}
+
+static unsigned SC_runParallel(SuperCalc* sc, struct BatchOutput* output) {
+	struct ParallelRun run = {
+		sc->ctx,
+		WorkPool_new(sc->jobs),
+		fcalloc(SC_JOBS_CHUNK, sizeof(*run.lines)),
+		0
+	};
+	
+	unsigned errors = 0;
+	char* line;
+	while((line = nextLine("")) != NULL) {
+		unsigned lineNumber = sc->input.lineNumber;
+		const char* p = line;
+		trimSpaces(&p);
+		
+		if(*p == '\0') {
+			continue;
+		}
+		
+		/*
+		 Anything that could change the context is run on its own, once
+		 everything before it has finished and before anything after it starts.
+		 Deletions, imports and commands always can.
+		*/
+		Value* ret;
+		ParsedLine directive;
+		if(ParsedLine_parseDirective(p, &directive)) {
+			errors += SC_flushPending(sc, output, &run);
+			ret = SC_runParsed(sc, &directive);
+			ParsedLine_destroy(&directive);
+		}
+		else {
+			/* Parse in order here, since continuation lines come from the same reader */
+			const Statement* stmt;
+			Statement* owned;
+			ret = SC_parseLine(sc, p, &stmt, &owned);
+			
+			/* Statements without a name to assign only read the context */
+			if(ret != NULL || stmt->var->name == NULL) {
+				struct PendingLine* pending = &run.lines[run.count++];
+				pending->lineNumber = lineNumber;
+				pending->stmt = stmt;
+				pending->owned = owned;
+				pending->result = ret;
+				
+				if(run.count == SC_JOBS_CHUNK) {
+					errors += SC_flushPending(sc, output, &run);
+				}
+				continue;
+			}
+			
+			errors += SC_flushPending(sc, output, &run);
+			ret = SC_runStatement(sc, CAST_NONNULL(stmt), V_NONE);
+			Statement_free(owned);
+		}
+		
 		if(ret != NULL) {
-			if(ret->type != VAL_VAR) {
-				Value_print(ret, v);
+			if(!SC_writeResult(output, lineNumber, ret)) {
+				errors++;
 			}
 			Value_free(ret);
-			ret = NULL;
 		}
 	}
 	
-	putchar('\n');
+	errors += SC_flushPending(sc, output, &run);
+	
+	WorkPool_free(run.pool);
+	destroy(run.lines);
+	return errors;
+}
+
+static void SC_flushOutput(struct BatchOutput* output) {
+	fwrite(output->buf, 1, output->len, output->fp);
+	output->len = 0;
+}
+
+static void SC_writeOutput(struct BatchOutput* output, const char* str, size_t len) {
+	if(output->len + len > SC_BATCH_BUFSIZE) {
+		SC_flushOutput(output);
+		
+		/* Too big to be worth buffering */
+		if(len > SC_BATCH_BUFSIZE) {
+			fwrite(str, 1, len, output->fp);
+			return;
+		}
+	}
+	
+	memcpy(output->buf + output->len, str, len);
+	output->len += len;
+}
+
+static void SC_writePrefix(struct BatchOutput* output, unsigned lineNumber, char kind) {
+	/* Formatted by hand, since printf costs more than evaluating a simple line */
+	char prefix[16];
+	char* p = prefix + sizeof(prefix);
+	*--p = '\t';
+	*--p = kind;
+	*--p = '\t';
+	do {
+		*--p = (char)('0' + lineNumber % 10);
+		lineNumber /= 10;
+	} while(lineNumber != 0);
+	
+	SC_writeOutput(output, p, (size_t)(prefix + sizeof(prefix) - p));
+}
+
+static bool SC_writeResult(struct BatchOutput* output, unsigned lineNumber, const Value* val) {
+	if(val->type == VAL_ERR) {
+		const Error* err = val->err;
+		if(!Error_canRecover(err)) {
+			SC_flushOutput(output);
+			fflush(output->fp);
+			Error_raise(err, true);
+			UNREACHABLE;
+		}
+		
+		/* Messages end with a newline already */
+		SC_writePrefix(output, lineNumber, '!');
+		SC_writeOutput(output, err->msg, strlen(err->msg));
+		return false;
+	}
+	
+	/* Defining a function has no result to show */
+	if(val->type == VAL_VAR) {
+		return true;
+	}
+	
+	SC_writePrefix(output, lineNumber, '=');
+	
+	char* repr = Value_repr(val, false, true);
+	SC_writeOutput(output, repr, strlen(repr));
+	SC_writeOutput(output, "\n", 1);
+	destroy(repr);
+	return true;
+}
+
+static void SC_forgetImports(SuperCalc* sc) {
+	struct ImportedFile* cur = sc->imported;
+	while(cur != NULL) {
+		struct ImportedFile* next = cur->next;
+		destroy(cur->path);
+		destroy(cur);
+		cur = next;
+	}
+	
+	sc->imported = NULL;
 }
 
 Error* SuperCalc_importFile(SuperCalc* sc, const char* filename) {
+	InputState* old = Input_enter(&sc->input);
+	Error* ret = SC_import(sc, filename, false);
+	Input_enter(old);
+	return ret;
+}
+
+Error* SuperCalc_reloadFile(SuperCalc* sc, const char* filename) {
+	InputState* old = Input_enter(&sc->input);
+	Error* ret = SC_import(sc, filename, true);
+	Input_enter(old);
+	return ret;
+}
+
+static Error* SC_import(SuperCalc* sc, const char* filename, bool force) {
+	/* If the file can't be found, let SC_loadFile report why */
+	struct stat st;
+	char* path = stat(filename, &st) == 0 ? realpath(filename, NULL) : NULL;
+	if(path == NULL) {
+		return SC_loadFile(sc, filename);
+	}
+	
+	/* The same file may be reached through another path, like a symlink */
+	struct ImportedFile* mod;
+	for(mod = sc->imported; mod != NULL; mod = mod->next) {
+		if(strcmp(mod->path, path) == 0 || (mod->dev == st.st_dev && mod->ino == st.st_ino)) {
+			break;
+		}
+	}
+	
+	/* Skip files that were already imported and haven't changed since */
+	if(mod != NULL && !force
+		&& mod->dev == st.st_dev && mod->ino == st.st_ino
+		&& mod->mtime.tv_sec == ST_MTIM(st).tv_sec
+		&& mod->mtime.tv_nsec == ST_MTIM(st).tv_nsec)
+	{
+		destroy(path);
+		return NULL;
+	}
+	
+	Error* ret = SC_loadFile(sc, filename);
+	if(ret != NULL) {
+		/* A file that failed to import can be tried again */
+		destroy(path);
+		return ret;
+	}
+	
+	if(mod == NULL) {
+		mod = fmalloc(sizeof(*mod));
+		mod->next = sc->imported;
+		sc->imported = mod;
+	}
+	else {
+		destroy(mod->path);
+	}
+	
+	mod->path = path;
+	mod->dev = st.st_dev;
+	mod->ino = st.st_ino;
+	mod->mtime = ST_MTIM(st);
+	
+	return NULL;
+}
+
+static Error* SC_loadFile(SuperCalc* sc, const char* filename) {
+	SccSource src;
+	char* sccPath = NULL;
+	bool compile = sc->compileImports && Scc_sourceInfo(filename, &src);
+	
+	if(compile) {
+		/* Skip parsing entirely if there's an up to date compiled copy */
+		sccPath = Scc_path(filename);
+		SccReader* compiled = SccReader_open(sccPath, &src);
+		if(compiled != NULL) {
+			/* An entry that can't be decoded is parsed again from the source, which also rewrites it */
+			size_t count;
+			struct CompiledEntry* entries = SC_decodeCompiled(compiled, &count);
+			SccReader_free(compiled);
+			if(entries != NULL) {
+				destroy(sccPath);
+				return SC_runCompiled(sc, entries, count, filename);
+			}
+		}
+	}
+	
 	errno = 0;
-	FILE* fp = fopen(filename, "r");
-	if(fp == NULL) {
+	LineReader* reader = LineReader_open(filename);
+	if(reader == NULL) {
+		destroy(sccPath);
 		return importError(filename, strerror(errno));
 	}
 	
-	/* Save old globals and swap in the new ones */
-	char* old_g_line = g_line;
-	unsigned old_g_lineNumber = g_lineNumber;
-	FILE* old_g_inputFile = g_inputFile;
-	const char* old_g_inputFileName = g_inputFileName;
+	/* Record statements from this file only, not the file importing it */
+	SccWriter* old_recorder = sc->recorder;
+	sc->recorder = compile ? SccWriter_new() : NULL;
+	
+	/* Save the old input and swap in the file */
+	InputState saved = sc->input;
+	sc->input.lineNumber = 0;
+	sc->input.fileName = filename;
 	
-	char* new_line = fmalloc(SC_LINE_SIZE);
-	g_line = new_line;
-	g_lineNumber = 0;
-	g_inputFile = fp;
-	g_inputFileName = filename;
+	Parser* parser = Parser_new(filename);
+	Parser_useCache(parser, sc->cache);
 	
+	/* Feed the file in chunks, evaluating each line as soon as its statement is complete */
 	Error* ret = NULL;
+	size_t fed = 0;
+	char* line;
+	while(ret == NULL && (line = LineReader_next(reader)) != NULL) {
+		size_t len = strlen(line);
+		Parser_feed(parser, line, len);
+		Parser_feed(parser, "\n", 1);
+		fed += len + 1;
+		
+		if(fed >= SC_IMPORT_CHUNK || !LineReader_hasLine(reader)) {
+			ret = SC_takeError(SC_runParser(sc, parser));
+			fed = 0;
+		}
+	}
+	
+	if(ret == NULL) {
+		Parser_finish(parser);
+		ret = SC_takeError(SC_runParser(sc, parser));
+	}
 	
-	/* Evaluate each line one-by-one */
-	while(nextLine("") != NULL) {
-		Value* val = SuperCalc_runLine(sc, new_line, V_NONE);
-		if(val != NULL && val->type == VAL_ERR) {
-			ret = val->err;
-			val->err = CAST_NONNULL(NULL);
-			Value_free(val);
+	Parser_free(parser);
+	
+	/* Only a complete import is worth saving. If saving fails, the next import just parses again */
+	if(ret == NULL && sc->recorder != NULL) {
+		SccWriter_save(sc->recorder, CAST_NONNULL(sccPath), &src);
+	}
+	
+	SccWriter_free(sc->recorder);
+	sc->recorder = old_recorder;
+	destroy(sccPath);
+	
+	/* Restore the previous input and free the file's reader */
+	sc->input.line = saved.line;
+	sc->input.lineNumber = saved.lineNumber;
+	sc->input.fileName = saved.fileName;
+	LineReader_free(reader);
+	
+	return ret;
+}
+
+/* Decodes every entry up front, so nothing runs unless the whole file is readable */
+static struct CompiledEntry* SC_decodeCompiled(SccReader* compiled, size_t* count) {
+	struct CompiledEntry* ret = NULL;
+	size_t cap = 0;
+	*count = 0;
+	
+	for(;;) {
+		if(*count == cap) {
+			cap = cap ? cap * 2 : 64;
+			ret = frealloc(ret, cap * sizeof(*ret));
+		}
+		
+		struct CompiledEntry* entry = &CAST_NONNULL(ret)[*count];
+		SCCENTRY kind = SccReader_next(compiled, &entry->stmt, &entry->line, &entry->lineNumber);
+		if(kind == SCC_END) {
+			return ret;
+		}
+		else if(kind == SCC_CORRUPT) {
 			break;
 		}
 		
-		Value_free(val);
+		++*count;
 	}
 	
-	/* Restore previous global FILE object and free the new one */
-	g_inputFile = old_g_inputFile;
-	fclose(fp);
-	
-	/* Restore previous global line buffer and free the new one */
-	g_line = old_g_line;
-	destroy(new_line);
-	g_lineNumber = old_g_lineNumber;
-	g_inputFileName = old_g_inputFileName;
+	size_t i;
+	for(i = 0; i < *count; i++) {
+		Statement_free(CAST_NONNULL(ret)[i].stmt);
+		destroy(CAST_NONNULL(ret)[i].line);
+	}
 	
-	return ret;
+	destroy(ret);
+	return NULL;
 }
 
-Value* SuperCalc_runLine(SuperCalc* sc, char* code, VERBOSITY v) {
-	/* Strip trailing newline and comments */
-	code = strsep(&code, "#\r\n");
+static Error* SC_runCompiled(SuperCalc* sc, struct CompiledEntry* entries, size_t count, const char* filename) {
+	/* Save the old input and swap in the file */
+	InputState saved = sc->input;
+	SccWriter* old_recorder = sc->recorder;
 	
-	const char* p = code;
-	trimSpaces(&p);
+	sc->input.fileName = filename;
+	sc->recorder = NULL;
 	
-	if(*p == '~') {
-		/* Variable deletion */
-		p++;
+	Error* ret = NULL;
+	
+	/* Run each entry in the order its line appeared */
+	size_t i;
+	for(i = 0; i < count; i++) {
+		struct CompiledEntry* entry = &entries[i];
 		
-		char* name = nextToken(&p);
-		if(name == NULL) {
-			/* '~~~' means reset interpreter */
-			if(p[0] == '~' && p[1] == '~') {
-				/* Wipe out context */
-				Context_clear(sc->ctx);
-				SC_registerModules(sc);
-				return NULL;
-			}
+		/* Entries after an error are only freed */
+		if(ret == NULL) {
+			sc->input.lineNumber = entry->lineNumber;
 			
-			if(*p == '\0') {
-				return ValErr(earlyEnd(p));
+			Value* val;
+			if(entry->stmt != NULL) {
+				val = SC_runStatement(sc, CAST_NONNULL(entry->stmt), V_NONE);
+			}
+			else {
+				sc->input.line = entry->line;
+				val = SC_runLine(sc, CAST_NONNULL(entry->line), V_NONE);
 			}
 			
-			Value* err = ValErr(badChar(p));
-			return err;
+			ret = SC_takeError(val);
 		}
 		
-		Context_del(sc->ctx, name);
-		
-		destroy(name);
-		return NULL;
+		Statement_free(entry->stmt);
+		destroy(entry->line);
 	}
-	else if(*p == '@') {
-		/* File import */
-		p++;
-		
-		if(sc->importDepth > 9) {
-			Value* err = ValErr(badImportDepth(p));
-			return err;
+	
+	destroy(entries);
+	
+	/* Restore the previous input */
+	sc->recorder = old_recorder;
+	sc->input.line = saved.line;
+	sc->input.lineNumber = saved.lineNumber;
+	sc->input.fileName = saved.fileName;
+	
+	return ret;
+}
+
+static Value* SC_cmdMode(SuperCalc* sc, const char* arg) {
+	NUMMODE mode;
+	for(mode = MODE_EXACT; mode < (NUMMODE)ARRSIZE(_sc_mode_names); mode++) {
+		if(strcmp(arg, _sc_mode_names[mode]) == 0) {
+			Context_setMode(sc->ctx, mode);
+			return NULL;
+		}
+	}
+	
+	return ValErr(badMode(arg));
+}
+
+static Value* SC_cmdDecimals(SuperCalc* sc, const char* arg) {
+	/* Literals are built while parsing, so this is a parser setting rather than part of the context */
+	if(strcmp(arg, "exact") == 0) {
+		sc->input.exactDecimals = true;
+	}
+	else if(strcmp(arg, "real") == 0) {
+		sc->input.exactDecimals = false;
+	}
+	else {
+		return ValErr(badDecimals(arg));
+	}
+	
+	/* Cached statements were parsed with the old setting */
+	StmtCache_clear(sc->cache);
+	return NULL;
+}
+
+static Value* SC_cmdSave(SuperCalc* sc, const char* arg) {
+	Error* err = SuperCalc_saveSnapshot(sc, arg);
+	return err ? ValErr(err) : NULL;
+}
+
+static Value* SC_cmdLoad(SuperCalc* sc, const char* arg) {
+	Error* err = SuperCalc_loadSnapshot(sc, arg);
+	return err ? ValErr(err) : NULL;
+}
+
+Error* SuperCalc_saveSnapshot(SuperCalc* sc, const char* filename) {
+	return Snapshot_save(sc->ctx, filename);
+}
+
+Error* SuperCalc_loadSnapshot(SuperCalc* sc, const char* filename) {
+	Error* err = Snapshot_load(sc->ctx, filename);
+	if(err == NULL) {
+		/* The snapshot replaced everything, including whatever was imported */
+		SC_forgetImports(sc);
+	}
+	
+	return err;
+}
+
+bool SuperCalc_setMode(SuperCalc* sc, const char* name) {
+	Value* err = SC_cmdMode(sc, name);
+	if(err != NULL) {
+		Value_free(err);
+		return false;
+	}
+	
+	return true;
+}
+
+bool SuperCalc_setDecimals(SuperCalc* sc, const char* name) {
+	Value* err = SC_cmdDecimals(sc, name);
+	if(err != NULL) {
+		Value_free(err);
+		return false;
+	}
+	
+	return true;
+}
+
+static Value* SC_runCommand(SuperCalc* sc, const ParsedLine* line) {
+	unsigned i;
+	for(i = 0; i < ARRSIZE(_sc_commands); i++) {
+		if(strcmp(CAST_NONNULL(line->name), _sc_commands[i].name) == 0) {
+			Value* ret = _sc_commands[i].func(sc, CAST_NONNULL(line->arg));
+			SC_recordLine(sc, CAST_NONNULL(line->text));
+			return ret;
 		}
+	}
+	
+	return ValErr(badCommand(line->name));
+}
+
+Value* SuperCalc_runLine(SuperCalc* sc, char* code, VERBOSITY v) {
+	InputState* old = Input_enter(&sc->input);
+	Value* ret = SC_runLine(sc, code, v);
+	Input_enter(old);
+	return ret;
+}
+
+Value* SuperCalc_runLines(SuperCalc* sc, const char* code) {
+	InputState* old = Input_enter(&sc->input);
+	unsigned lineNumber = sc->input.lineNumber;
+	char* line = sc->input.line;
+	
+	Parser* parser = Parser_new(sc->input.fileName);
+	Parser_useCache(parser, sc->cache);
+	Parser_feed(parser, code, strlen(code));
+	Parser_finish(parser);
+	Value* ret = SC_runParser(sc, parser);
+	Parser_free(parser);
+	
+	sc->input.lineNumber = lineNumber;
+	sc->input.line = line;
+	Input_enter(old);
+	return ret;
+}
+
+static Value* SC_runParser(SuperCalc* sc, Parser* parser) {
+	Value* ret = NULL;
+	ParsedLine line;
+	while(Parser_next(parser, &line) == PARSE_LINE) {
+		/* Errors and recorded lines belong to the line where this one started */
+		sc->input.line = line.text;
+		sc->input.lineNumber = line.lineNumber;
 		
-		++sc->importDepth;
-		Error* ret = SuperCalc_importFile(sc, p);
-		--sc->importDepth;
+		Value_free(ret);
+		ret = SC_runParsed(sc, &line);
+		sc->input.line = NULL;
+		ParsedLine_destroy(&line);
 		
-		if(ret != NULL) {
-			return ValErr(ret);
+		if(ret != NULL && ret->type == VAL_ERR) {
+			break;
 		}
+	}
+	
+	return ret;
+}
+
+static Error* SC_takeError(Value* val) {
+	Error* ret = NULL;
+	if(val != NULL && val->type == VAL_ERR) {
+		ret = val->err;
+		val->err = CAST_NONNULL(NULL);
+	}
+	
+	Value_free(val);
+	return ret;
+}
+
+static Value* SC_runParsed(SuperCalc* sc, ParsedLine* line) {
+	Error* err = NULL;
+	
+	switch(line->type) {
+		case LINE_STATEMENT:
+			return SC_runStatement(sc, CAST_NONNULL(line->stmt), line->verbosity);
+		
+		case LINE_DELETE:
+			SC_recordLine(sc, CAST_NONNULL(line->text));
+			err = Context_del(sc->ctx, CAST_NONNULL(line->name));
+			break;
+		
+		case LINE_CLEAR:
+			/* Wipe out context, including everything imported into it */
+			SC_recordLine(sc, CAST_NONNULL(line->text));
+			Context_clear(sc->ctx);
+			SC_forgetImports(sc);
+			SymbolTable_clear(sc->symbols);
+			break;
+		
+		case LINE_IMPORT:
+			SC_recordLine(sc, CAST_NONNULL(line->text));
+			if(sc->importDepth > 9) {
+				err = badImportDepth(line->name);
+				break;
+			}
+			
+			++sc->importDepth;
+			err = SC_import(sc, CAST_NONNULL(line->name), line->force);
+			--sc->importDepth;
+			break;
+		
+		case LINE_COMMAND:
+			return SC_runCommand(sc, line);
+		
+		case LINE_ERROR:
+			err = line->err;
+			line->err = NULL;
+			break;
+	}
+	
+	return err ? ValErr(err) : NULL;
+}
+
+static Value* SC_runLine(SuperCalc* sc, char* code, VERBOSITY v) {
+	/* Strip trailing newline and comments */
+	code = strsep(&code, "#\r\n");
+	
+	const char* p = code;
+	trimSpaces(&p);
+	if(*p == '\0') {
 		return NULL;
 	}
-	else if(*p == '\0') {
+	
+	/* Deletions, imports and commands are run just like the ones a Parser finds */
+	ParsedLine line;
+	if(ParsedLine_parseDirective(p, &line)) {
+		Value* ret = SC_runParsed(sc, &line);
+		ParsedLine_destroy(&line);
+		return ret;
+	}
+	
+	const Statement* stmt;
+	Statement* owned;
+	Value* err = SC_parseLine(sc, p, &stmt, &owned);
+	if(err != NULL) {
+		return err;
+	}
+	
+	/* Evaluate statement */
+	Value* result = SC_runStatement(sc, stmt, v);
+	Statement_free(owned);
+	return result;
+}
+
+static Value* SC_parseLine(SuperCalc* sc, const char* p, const Statement** stmt, Statement** owned) {
+	*owned = NULL;
+	
+	/* Trailing whitespace doesn't change the statement, so leave it out of the cache key */
+	size_t len = strlen(p);
+	while(len > 0 && (p[len - 1] == ' ' || p[len - 1] == '\t')) {
+		len--;
+	}
+	
+	/* Reuse the parse tree if this exact line has been seen before */
+	*stmt = StmtCache_get(sc->cache, p, len);
+	if(*stmt != NULL) {
 		return NULL;
 	}
 	
 	/* Parse the user's input */
-	Statement* stmt = Statement_parse(&p);
-	
-	/* Print statement depending with specified level of verbosity */
-	Statement_print(stmt, sc, v);
+	const char* text = p;
+	unsigned lineNumber = sc->input.lineNumber;
+	Statement* parsed = Statement_parse(&p);
 	
 	/* Error? Go to next loop iteration */
-	if(Statement_didError(stmt)) {
-		Value* ret = stmt->var->val;
-		stmt->var->val = CAST_NONNULL(NULL);
-		Statement_free(stmt);
+	if(Statement_didError(parsed)) {
+		Value* ret = parsed->var->val;
+		parsed->var->val = CAST_NONNULL(NULL);
+		Statement_free(parsed);
 		return ret;
 	}
 	
-	/* Evaluate statement */
-	Value* result = Statement_eval(stmt, sc->ctx, v);
-	Statement_free(stmt);
+	/*
+	 Only cache statements that fit on this line. One that continued onto
+	 more lines isn't described by `text` alone, which may not even be
+	 valid anymore.
+	*/
+	if(sc->input.lineNumber != lineNumber) {
+		*stmt = *owned = parsed;
+		return NULL;
+	}
 	
-	return result;
+	*stmt = StmtCache_put(sc->cache, text, len, parsed);
+	return NULL;
+}
+
+static Value* SC_runStatement(SuperCalc* sc, const Statement* stmt, VERBOSITY v) {
+	/* Compiling an import, so remember the parsed statement */
+	if(sc->recorder != NULL) {
+		SccWriter_addStatement(sc->recorder, stmt, sc->input.lineNumber);
+	}
+	
+	/* Print statement depending with specified level of verbosity */
+	Statement_print(stmt, sc, v);
+	
+	return Statement_eval(stmt, sc->ctx, v);
+}
+
+static void SC_recordLine(SuperCalc* sc, const char* line) {
+	/* Lines that aren't statements are compiled as their text and run again when loaded */
+	if(sc->recorder != NULL) {
+		SccWriter_addLine(sc->recorder, line, sc->input.lineNumber);
+	}
 }
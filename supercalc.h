@@ -13,25 +13,79 @@
 #include <stdbool.h>
 
 typedef struct SuperCalc SuperCalc;
+struct ImportedFile;
 #include "value.h"
 #include "context.h"
+#include "stmtcache.h"
+#include "symbol.h"
+#include "scc.h"
 #include "generic.h"
+#include "prepared.h"
 
 
 ASSUME_NONNULL_BEGIN
 
 struct SuperCalc {
 	OWNED Context* ctx;
+	OWNED StmtCache* cache;
+	
+	/* Names parsed by this interpreter, until it's cleared */
+	OWNED SymbolTable* symbols;
+	
+	/* Made current on whichever thread is running this interpreter */
+	InputState input;
+	
+	/* Whether imports are saved as and loaded from .scc files */
+	bool compileImports;
+	
+	/* Collects the statements of the file currently being compiled */
+	UNOWNED SccWriter* _Nullable recorder;
+	
+	/* Number of threads SuperCalc_runBatch evaluates lines on */
+	unsigned jobs;
+	
+	/* Files that have already been imported, so they're only imported once */
+	OWNED struct ImportedFile* _Nullable imported;
 	bool interactive;
 	uint8_t importDepth;
 };
 
 RETURNS_OWNED SuperCalc* SuperCalc_new(void);
 void SuperCalc_free(CONSUMED SuperCalc* _Nullable sc);
+
+/*
+ A new session that can use everything defined in `lib` without copying or
+ modifying it. Sessions of the same library can run on different threads at
+ once, as long as `lib` itself is left alone until they are all freed.
+*/
+RETURNS_OWNED SuperCalc* SuperCalc_newSession(UNOWNED const SuperCalc* lib);
 void SuperCalc_run(UNOWNED SuperCalc* sc);
+unsigned SuperCalc_runBatch(UNOWNED SuperCalc* sc, int in, UNOWNED FILE* out);
+unsigned SuperCalc_runJsonl(UNOWNED SuperCalc* sc, int in, UNOWNED FILE* out);
+
+/*
+ Evaluates `expr` once for every row of CSV read from `in`, after the header
+ row names its parameters. Results are written like SuperCalc_runBatch, with
+ the row's line number. Returns the number of errors.
+*/
+unsigned SuperCalc_runCsv(UNOWNED SuperCalc* sc, const char* expr, int in, UNOWNED FILE* out);
+
+/* Prepares `expr` in this interpreter, which must outlive it */
+RETURNS_OWNED Prepared* _Nullable SuperCalc_prepare(UNOWNED SuperCalc* sc, const char* expr, OUT Error* _Nullable* _Nonnull err);
 RETURNS_OWNED Error* SuperCalc_importFile(UNOWNED SuperCalc* sc, const char* filename);
+RETURNS_OWNED Error* SuperCalc_reloadFile(UNOWNED SuperCalc* sc, const char* filename);
+RETURNS_OWNED Error* _Nullable SuperCalc_saveSnapshot(UNOWNED SuperCalc* sc, const char* filename);
+RETURNS_OWNED Error* _Nullable SuperCalc_loadSnapshot(UNOWNED SuperCalc* sc, const char* filename);
 RETURNS_OWNED Value* _Nullable SuperCalc_runLine(UNOWNED SuperCalc* sc, UNOWNED char* str, VERBOSITY v);
 
+/*
+ Runs every line in `code`, where statements may continue onto the next line,
+ stopping at the first error. Returns the last line's result or that error.
+*/
+RETURNS_OWNED Value* _Nullable SuperCalc_runLines(UNOWNED SuperCalc* sc, const char* code);
+bool SuperCalc_setMode(UNOWNED SuperCalc* sc, const char* name);
+bool SuperCalc_setDecimals(UNOWNED SuperCalc* sc, const char* name);
+
 ASSUME_NONNULL_END
 
 #endif /* SC_SUPERCALC_H */
@@ -0,0 +1,173 @@
+/*
+  symbol.c
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include "symbol.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "generic.h"
+
+
+#define SYMTAB_INITIAL_SIZE 256
+
+struct Symbol {
+	/* Values on several threads can share a name, so this is only changed atomically */
+	unsigned refs;
+	char name[];
+};
+
+struct SymEntry {
+	struct Symbol* _Nullable sym;
+	size_t len;
+	uint32_t hash;
+};
+
+/* Open addressing hash table, kept at most half full */
+struct SymbolTable {
+	OWNED struct SymEntry* _Nullable entries;
+	size_t size;
+	size_t count;
+};
+
+
+static struct Symbol* symbolOf(const char* name);
+static struct Symbol* newSymbol(const char* str, size_t len);
+static uint32_t hashName(const char* str, size_t len);
+static struct SymEntry* findSlot(struct SymEntry* entries, size_t size, const char* str, size_t len, uint32_t hash);
+static void growTable(SymbolTable* table);
+
+
+static struct Symbol* symbolOf(const char* name) {
+	return (struct Symbol*)(name - offsetof(struct Symbol, name));
+}
+
+static struct Symbol* newSymbol(const char* str, size_t len) {
+	struct Symbol* ret = fmalloc(sizeof(*ret) + len + 1);
+	ret->refs = 1;
+	memcpy(ret->name, str, len);
+	ret->name[len] = '\0';
+	return ret;
+}
+
+/* FNV-1a */
+static uint32_t hashName(const char* str, size_t len) {
+	uint32_t hash = 2166136261u;
+	
+	size_t i;
+	for(i = 0; i < len; i++) {
+		hash ^= (unsigned char)str[i];
+		hash *= 16777619u;
+	}
+	
+	return hash;
+}
+
+static struct SymEntry* findSlot(struct SymEntry* entries, size_t size, const char* str, size_t len, uint32_t hash) {
+	size_t mask = size - 1;
+	size_t i = hash & mask;
+	
+	while(entries[i].sym != NULL) {
+		if(entries[i].hash == hash && entries[i].len == len && memcmp(entries[i].sym->name, str, len) == 0) {
+			break;
+		}
+		
+		i = (i + 1) & mask;
+	}
+	
+	return &entries[i];
+}
+
+static void growTable(SymbolTable* table) {
+	size_t newSize = table->size ? table->size * 2 : SYMTAB_INITIAL_SIZE;
+	struct SymEntry* entries = fcalloc(newSize, sizeof(*entries));
+	
+	size_t i;
+	for(i = 0; i < table->size; i++) {
+		struct SymEntry* entry = &table->entries[i];
+		if(entry->sym != NULL) {
+			*findSlot(entries, newSize, entry->sym->name, entry->len, entry->hash) = *entry;
+		}
+	}
+	
+	destroy(table->entries);
+	table->entries = entries;
+	table->size = newSize;
+}
+
+const char* Symbol_intern(const char* str, size_t len) {
+	SymbolTable* table = Input_current()->symbols;
+	if(table == NULL) {
+		return newSymbol(str, len)->name;
+	}
+	
+	if((table->count + 1) * 2 > table->size) {
+		growTable(table);
+	}
+	
+	uint32_t hash = hashName(str, len);
+	struct SymEntry* slot = findSlot(CAST_NONNULL(table->entries), table->size, str, len, hash);
+	
+	/* The table keeps its own reference */
+	if(slot->sym == NULL) {
+		slot->sym = newSymbol(str, len);
+		slot->len = len;
+		slot->hash = hash;
+		table->count++;
+	}
+	
+	return Symbol_retain(CAST_NONNULL(slot->sym)->name);
+}
+
+const char* Symbol_internStr(const char* str) {
+	return Symbol_intern(str, strlen(str));
+}
+
+const char* Symbol_retain(const char* sym) {
+	__atomic_add_fetch(&symbolOf(sym)->refs, 1, __ATOMIC_RELAXED);
+	return sym;
+}
+
+void Symbol_release(const char* sym) {
+	if(sym == NULL) {
+		return;
+	}
+	
+	struct Symbol* symbol = symbolOf(sym);
+	if(__atomic_sub_fetch(&symbol->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+		destroy(symbol);
+	}
+}
+
+SymbolTable* SymbolTable_new(void) {
+	return fmalloc(sizeof(SymbolTable));
+}
+
+void SymbolTable_free(SymbolTable* table) {
+	if(!table) {
+		return;
+	}
+	
+	SymbolTable_clear(table);
+	destroy(table->entries);
+	destroy(table);
+}
+
+void SymbolTable_clear(SymbolTable* table) {
+	size_t i;
+	for(i = 0; i < table->size; i++) {
+		struct SymEntry* entry = &table->entries[i];
+		if(entry->sym != NULL) {
+			Symbol_release(CAST_NONNULL(entry->sym)->name);
+			entry->sym = NULL;
+		}
+	}
+	
+	table->count = 0;
+}
@@ -0,0 +1,42 @@
+/*
+  symbol.h
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#ifndef SC_SYMBOL_H
+#define SC_SYMBOL_H
+
+#include <stddef.h>
+
+#include "annotations.h"
+
+typedef struct SymbolTable SymbolTable;
+
+
+ASSUME_NONNULL_BEGIN
+
+/*
+ Identifier names, reference counted so they can be shared between values
+ without copying. Names are interned into the symbol table of the input being
+ read (see InputState), so each interpreter allocates every distinct name only
+ once. Without a table, each name is allocated on its own.
+*/
+RETURNS_OWNED const char* Symbol_intern(const char* str, size_t len);
+RETURNS_OWNED const char* Symbol_internStr(const char* str);
+RETURNS_OWNED const char* Symbol_retain(const char* sym);
+void Symbol_release(CONSUMED const char* _Nullable sym);
+
+/*
+ Only one thread may intern into a table at a time. Names handed out stay
+ valid after the table is cleared or freed, for as long as they're retained.
+*/
+RETURNS_OWNED SymbolTable* SymbolTable_new(void);
+void SymbolTable_free(CONSUMED SymbolTable* _Nullable table);
+void SymbolTable_clear(SymbolTable* table);
+
+ASSUME_NONNULL_END
+
+#endif /* SC_SYMBOL_H */
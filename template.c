@@ -11,19 +11,36 @@
 #include <stdlib.h>
 #include <errno.h>
 #include <string.h>
+#include <pthread.h>
 
 #include "support.h"
 #include "generic.h"
 #include "error.h"
 #include "placeholder.h"
+#include "symbol.h"
 
 struct Template {
 	OWNED Value* _Nonnull tree;
 	INVARIANT(num_placeholders <= capacity) unsigned num_placeholders;
 	unsigned capacity;
 	OWNED Value* _Nonnull * _Nullable_unless(capacity > 0) placeholders;
+	
+	/* Filling temporarily swaps values into the tree, so only one thread may do it at a time */
+	pthread_mutex_t fillLock;
 };
 
+/* Arguments of a template being evaluated, which its placeholders refer to */
+struct TemplateArgs {
+	UNOWNED const Value* _Nonnull const* _Nullable args;
+	unsigned count;
+	
+	/* Template whose evaluation called into this one, if any */
+	const struct TemplateArgs* _Nullable outer;
+};
+
+/* Innermost template being evaluated on this thread */
+static _Thread_local const struct TemplateArgs* _Nullable _template_args = NULL;
+
 /*
  Example: "@1i*4 + @1i - @2f"
  
@@ -47,10 +64,6 @@ struct Template {
 */
 
 static Value* parse_internalName(const char** expr) {
-	if(**expr != '@') {
-		RAISE(badChar(*expr), true);
-	}
-	
 	/* Must match regex "@[a-zA-Z]{2,}" */
 	if(!(isalpha((*expr)[1]) && isalpha((*expr)[2]))){
 		return NULL;
@@ -66,7 +79,8 @@ static Value* parse_internalName(const char** expr) {
 	destroy(token);
 	
 	/* Wrap in Value object */
-	Value* ret = ValVar(varname);
+	Value* ret = ValVar(Symbol_internStr(varname));
+	destroy(varname);
 	return ret;
 }
 
@@ -81,11 +95,15 @@ static Value* parse_extra(const char** expr, void* data) {
 	Template* tp = data;
 	Placeholder* ph = Placeholder_parse(expr);
 	if(ph->type == PH_ERR) {
-		RAISE(syntaxError(*expr, "Unable to parse placeholder"), true);
+		Placeholder_free(ph);
+		return ValErr(syntaxError(*expr, "Unable to parse placeholder"));
 	}
 	
 	unsigned index = ph->index > 0 ? ph->index - 1 : tp->num_placeholders;
 	
+	/* Number every placeholder so evaluation can find its argument */
+	ph->index = index + 1;
+	
 	if(index >= tp->num_placeholders) {
 		tp->num_placeholders = index + 1;
 	}
@@ -106,7 +124,8 @@ static Value* parse_extra(const char** expr, void* data) {
 	/* Already encountered a format code with the specified index, so use same ptr */
 	if(tp->placeholders[index] != NULL) {
 		if(ph->type != tp->placeholders[index]->ph->type) {
-			RAISE(typeError("Type mismatch of numbered placeholders."), true);
+			Placeholder_free(ph);
+			return ValErr(typeError("Type mismatch of numbered placeholders."));
 		}
 		
 		Placeholder_free(ph);
@@ -120,29 +139,26 @@ static Value* parse_extra(const char** expr, void* data) {
 
 Template* Template_create(const char* fmt) {
 	Template* ret = fcalloc(1, sizeof(*ret));
-	
-	char* old_g_line = g_line;
-	unsigned old_g_lineNumber = g_lineNumber;
-	FILE* old_g_inputFile = g_inputFile;
-	const char* old_g_inputFileName = g_inputFileName;
+	pthread_mutex_init(&ret->fillLock, NULL);
 	
 	/* I pinky promise not to modify fmt's contents */
-	g_line = (char*)fmt;
-	g_lineNumber = 1;
-	g_inputFile = NULL;
-	g_inputFileName = "<template>";
+	InputState input;
+	InputState_init(&input);
+	input.line = (char*)fmt;
+	input.lineNumber = 1;
+	input.fileName = "<template>";
+	InputState* old = Input_enter(&input);
 	
 	/* Like normal parsing but handle '@' specially by building placeholders */
 	parser_cb cb = {&parse_extra, ret};
 	ret->tree = Value_parse(&fmt, 0, 0, &cb);
 	
-	g_line = old_g_line;
-	g_lineNumber = old_g_lineNumber;
-	g_inputFile = old_g_inputFile;
-	g_inputFileName = old_g_inputFileName;
+	Input_enter(old);
+	InputState_destroy(&input);
 	
+	/* A template that failed to parse keeps the error, and filling it gives a copy */
 	if(ret->tree->type == VAL_ERR) {
-		RAISE(ret->tree->err, true);
+		return ret;
 	}
 	
 	/*
@@ -169,6 +185,7 @@ void Template_free(Template* tp) {
 	
 	/* Call release on these */
 	destroy(tp->placeholders);
+	pthread_mutex_destroy(&tp->fillLock);
 	destroy(tp);
 }
 
@@ -190,9 +207,9 @@ static Value* next_value(PLACETYPE type, va_list args) {
 		case PH_EXPR:  return ValExpr(va_arg(args, BinOp*));
 		case PH_UNARY: return ValUnary(va_arg(args, UnOp*));
 		case PH_CALL:  return ValCall(va_arg(args, FuncCall*));
-		case PH_VAR:   return ValVar(va_arg(args, char*));
+		case PH_VAR:   return ValVar(Symbol_internStr(va_arg(args, const char*)));
 		case PH_VEC:   return ValVec(va_arg(args, Vector*));
-		case PH_VAL:   return Value_copy(va_arg(args, Value*));
+		case PH_VAL:   return va_arg(args, Value*);
 			
 		default:
 			return ValErr(typeError("Unexpected placeholder type %d", type));
@@ -200,20 +217,26 @@ static Value* next_value(PLACETYPE type, va_list args) {
 }
 
 Value* Template_fillv(const Template* tp, va_list args) {
-	Value* ret = NULL;
+	if(tp->tree->type == VAL_ERR) {
+		return Value_copy(tp->tree);
+	}
+	
+	/* Every placeholder up to the highest one used must be in the template */
+	unsigned i;
+	for(i = 0; i < tp->num_placeholders; i++) {
+		if(tp->placeholders[i] == NULL) {
+			return ValErr(missingPlaceholder(i + 1));
+		}
+	}
+	
+	pthread_mutex_lock((pthread_mutex_t*)&tp->fillLock);
 	
 	/* Backup placeholder array */
 	Placeholder** orig = fmalloc(tp->num_placeholders * sizeof(*orig));
 	
 	/* Fill in placeholders */
-	unsigned i;
 	for(i = 0; i < tp->num_placeholders; i++) {
 		Value* cur = tp->placeholders[i];
-		if(cur == NULL) {
-			RAISE(missingPlaceholder(i), true);
-			break;
-		}
-		
 		if(cur->type != VAL_PLACE) {
 			badValType(cur->type);
 		}
@@ -225,10 +248,7 @@ Value* Template_fillv(const Template* tp, va_list args) {
 		destroy(arg);
 	}
 	
-	/* Only copy tree when there's no error */
-	if(ret == NULL) {
-		ret = Value_copy(tp->tree);
-	}
+	Value* ret = Value_copy(tp->tree);
 	
 	/* Undo placeholder replacement */
 	for(i = 0; i < tp->num_placeholders; i++) {
@@ -244,24 +264,69 @@ Value* Template_fillv(const Template* tp, va_list args) {
 		}
 	}
 	
+	pthread_mutex_unlock((pthread_mutex_t*)&tp->fillLock);
+	
 	destroy(orig);
 	return ret;
 }
 
-Value* Template_staticFill(Template** ptp, const char* fmt, ...) {
-	if(*ptp == NULL) {
-		*ptp = Template_create(fmt);
+static Template* staticTemplate(Template** ptp, const char* fmt) {
+	Template* tp = __atomic_load_n(ptp, __ATOMIC_ACQUIRE);
+	if(tp != NULL) {
+		return tp;
 	}
 	
+	/* Several threads may race to create it, in which case all but one throw theirs away */
+	Template* expected = NULL;
+	tp = Template_create(fmt);
+	if(!__atomic_compare_exchange_n(ptp, &expected, tp, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+		Template_free(tp);
+		tp = CAST_NONNULL(expected);
+	}
+	
+	return tp;
+}
+
+Value* Template_staticFill(Template** ptp, const char* fmt, ...) {
+	Template* tp = staticTemplate(ptp, fmt);
+	
 	va_list args;
 	va_start(args, fmt);
 	
-	Value* ret = Template_fillv(*ptp, args);
+	Value* ret = Template_fillv(tp, args);
 	
 	va_end(args);
 	return ret;
 }
 
+static Value* _Nullable checkEval(const Template* tp) {
+	if(tp->tree->type == VAL_ERR) {
+		return Value_copy(tp->tree);
+	}
+	
+	unsigned i;
+	for(i = 0; i < tp->num_placeholders; i++) {
+		if(tp->placeholders[i] == NULL) {
+			return ValErr(missingPlaceholder(i + 1));
+		}
+	}
+	
+	return NULL;
+}
+
+static Value* evalWith(const Template* tp, const Context* ctx, const Value* const* args) {
+	struct TemplateArgs frame;
+	frame.args = args;
+	frame.count = tp->num_placeholders;
+	frame.outer = _template_args;
+	
+	_template_args = &frame;
+	Value* ret = Value_eval(tp->tree, ctx);
+	_template_args = frame.outer;
+	
+	return ret;
+}
+
 Value* Template_eval(const Template* tp, const Context* ctx, ...) {
 	va_list args;
 	va_start(args, ctx);
@@ -273,26 +338,76 @@ Value* Template_eval(const Template* tp, const Context* ctx, ...) {
 }
 
 Value* Template_evalv(const Template* tp, const Context* ctx, va_list args) {
-	Value* filled = Template_fillv(tp, args);
-	Value* ret = Value_eval(filled, ctx);
-	Value_free(filled);
+	Value* err = checkEval(tp);
+	if(err != NULL) {
+		return err;
+	}
+	
+	/* Collect the arguments, then evaluate the shared tree which looks them up as it goes */
+	unsigned i;
+	Value* local[8];
+	Value** owned = tp->num_placeholders <= ARRSIZE(local) ? local : fcalloc(tp->num_placeholders, sizeof(*owned));
+	
+	for(i = 0; i < tp->num_placeholders; i++) {
+		owned[i] = next_value(tp->placeholders[i]->ph->type, args);
+	}
+	
+	Value* ret = evalWith(tp, ctx, (const Value* const*)owned);
+	
+	for(i = 0; i < tp->num_placeholders; i++) {
+		Value_free(owned[i]);
+	}
+	
+	if(owned != local) {
+		destroy(owned);
+	}
+	
 	return ret;
 }
 
+Value* Template_evalArgs(const Template* tp, const Context* ctx, const Value* const* args) {
+	return checkEval(tp) ?: evalWith(tp, ctx, args);
+}
+
 Value* Template_staticEval(Template** ptp, const Context* ctx, const char* fmt, ...) {
-	if(*ptp == NULL) {
-		*ptp = Template_create(fmt);
-	}
+	Template* tp = staticTemplate(ptp, fmt);
 	
 	va_list args;
 	va_start(args, fmt);
 	
-	Value* ret = Template_evalv(*ptp, ctx, args);
+	Value* ret = Template_evalv(tp, ctx, args);
 	
 	va_end(args);
 	return ret;
 }
 
+Value* Template_staticEvalArgs(Template** ptp, const Context* ctx, const char* fmt, const Value* const* args) {
+	return Template_evalArgs(staticTemplate(ptp, fmt), ctx, args);
+}
+
+const Value* Template_argument(const Placeholder* ph) {
+	const struct TemplateArgs* frame = _template_args;
+	if(frame == NULL || ph->index == 0 || ph->index > frame->count) {
+		return NULL;
+	}
+	
+	return frame->args[ph->index - 1];
+}
+
+Value* Template_evalArgument(const Placeholder* ph, const Context* ctx) {
+	const Value* arg = Template_argument(ph);
+	if(arg == NULL) {
+		return ValErr(typeError("Placeholder outside of a template."));
+	}
+	
+	/* Arguments were written in the caller's template, so their placeholders refer to its arguments */
+	const struct TemplateArgs* frame = _template_args;
+	_template_args = CAST_NONNULL(frame)->outer;
+	Value* ret = Value_eval(arg, ctx);
+	_template_args = frame;
+	return ret;
+}
+
 unsigned Template_placeholderCount(const Template* tp) {
 	return tp->num_placeholders;
 }
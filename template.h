@@ -20,10 +20,14 @@ Template_staticFill(&name, fmt, __VA_ARGS__)
 #define TP_EVAL(name, ctx, fmt, ...) \
 Template_staticEval(&name, ctx, fmt, __VA_ARGS__)
 
+#define TP_EVAL_ARGS(name, ctx, fmt, args) \
+Template_staticEvalArgs(&name, ctx, fmt, args)
+
 typedef struct Template Template;
 #include "value.h"
 #include "context.h"
 #include "generic.h"
+#include "placeholder.h"
 
 
 ASSUME_NONNULL_BEGIN
@@ -39,11 +43,21 @@ RETURNS_OWNED Value* Template_fill(const Template* tp, OWNED ...);
 RETURNS_OWNED Value* Template_fillv(const Template* tp, OWNED va_list args);
 RETURNS_OWNED Value* Template_staticFill(Template* _Nullable * _Nonnull ptp, const char* fmt, OWNED ...);
 
-/* Fill in placeholders and evaluate result */
+/* Evaluate the template with its placeholders standing for the arguments, without filling in a copy */
 RETURNS_OWNED Value* Template_eval(const Template* tp, const Context* ctx, OWNED ...);
 RETURNS_OWNED Value* Template_evalv(const Template* tp, const Context* ctx, OWNED va_list args);
 RETURNS_OWNED Value* Template_staticEval(Template* _Nullable * _Nonnull ptp, const Context* ctx, const char* fmt, OWNED ...);
 
+/* Same as Template_eval, but the arguments (one for each placeholder) are only borrowed */
+RETURNS_OWNED Value* Template_evalArgs(const Template* tp, const Context* ctx, UNOWNED const Value* const* args);
+RETURNS_OWNED Value* Template_staticEvalArgs(Template* _Nullable * _Nonnull ptp, const Context* ctx, const char* fmt, UNOWNED const Value* const* args);
+
+/* Argument of the template being evaluated for a placeholder, or NULL when none is */
+const Value* _Nullable Template_argument(const Placeholder* ph);
+
+/* Value_eval of a placeholder, which evaluates its argument */
+RETURNS_OWNED Value* Template_evalArgument(const Placeholder* ph, const Context* ctx);
+
 /* Number of placeholders that must be filled */
 unsigned Template_placeholderCount(const Template* tp);
 
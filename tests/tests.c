@@ -9,10 +9,28 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 #include "utest/utest.h"
 #include "test_helpers.h"
 #include "value.h"
+#include "supercalc.h"
+#include "parser.h"
+#include "linereader.h"
+#include "symbol.h"
+#include "serial.h"
+#include "unop.h"
+#include "placeholder.h"
+#include "server.h"
+#include "libsupercalc.h"
 
 
 UTEST_MAIN();
@@ -21,10 +39,8 @@ UTEST_MAIN();
 UTEST_F_SETUP(SC) {
 	ASSERT_TRUE(true);
 	F->ctx = Context_new();
-	register_math(F->ctx);
-	register_vector(F->ctx);
-	g_inputFile = fopen("/dev/null", "r");
-	g_inputFileName = NULL;
+	Input_current()->file = fopen("/dev/null", "r");
+	Input_current()->fileName = NULL;
 }
 
 UTEST_F_TEARDOWN(SC) {
@@ -32,8 +48,8 @@ UTEST_F_TEARDOWN(SC) {
 	_fixtureNext(F);
 	Context_free(F->ctx);
 	F->ctx = CAST_NONNULL(NULL);
-	fclose(g_inputFile);
-	g_inputFile = NULL;
+	fclose(Input_current()->file);
+	Input_current()->file = NULL;
 }
 
 
@@ -65,6 +81,33 @@ UTEST_F(SC, implicitMul) {
 	ASSERT_TRUE(IsValReal(EVAL(), 2.0 * M_PI));
 }
 
+UTEST_F(SC, internedNames) {
+	/* Every mention of a name in one interpreter shares one interned string */
+	SymbolTable* symbols = SymbolTable_new();
+	Input_current()->symbols = symbols;
+	Value* val = PARSEVAL("foo * f(foo)");
+	Input_current()->symbols = NULL;
+	ASSERT_TRUE(IsBinOp(val, BIN_MUL));
+	ASSERT_EQ(val->expr->a->type, VAL_VAR);
+	ASSERT_EQ(val->expr->b->type, VAL_CALL);
+	
+	const char* name = val->expr->a->name;
+	ASSERT_STREQ(name, "foo");
+	ASSERT_EQ(name, val->expr->b->call->arglist->args[0]->name);
+	
+	/* Names outlive the table for as long as something still uses them */
+	SymbolTable_free(symbols);
+	Value* copy = Value_copy(val);
+	ASSERT_EQ(name, copy->expr->a->name);
+	ASSERT_STREQ(copy->expr->a->name, "foo");
+	Value_free(copy);
+	
+	/* Without a table, each name is allocated on its own */
+	val = PARSEVAL("bar + bar");
+	ASSERT_STREQ(val->expr->a->name, val->expr->b->name);
+	ASSERT_NE(val->expr->a->name, val->expr->b->name);
+}
+
 UTEST_F(SC, orderAdd) {
 	Value* val = PARSEVAL("4 + 3 + 2");
 	ASSERT_TRUE(IsBinOp(val, BIN_ADD));
@@ -83,6 +126,28 @@ UTEST_F(SC, orderPow) {
 	ASSERT_TRUE(IsValInt(EVAL(), 262144));
 }
 
+UTEST_F(SC, orderMixed) {
+	/* 1 + 2 * 3 ^ -4 - 5  =>  (1 + (2 * (3 ^ (-1 * 4)))) - 5 */
+	Value* val = PARSEVAL("1 + 2 * 3 ^ -4 - 5");
+	ASSERT_TRUE(IsBinOp(val, BIN_SUB));
+	ASSERT_TRUE(IsValInt(val->expr->b, 5));
+	
+	Value* sum = val->expr->a;
+	ASSERT_TRUE(IsBinOp(sum, BIN_ADD));
+	ASSERT_TRUE(IsValInt(sum->expr->a, 1));
+	
+	Value* prod = sum->expr->b;
+	ASSERT_TRUE(IsBinOp(prod, BIN_MUL));
+	ASSERT_TRUE(IsValInt(prod->expr->a, 2));
+	
+	Value* power = prod->expr->b;
+	ASSERT_TRUE(IsBinOp(power, BIN_POW));
+	ASSERT_TRUE(IsValInt(power->expr->a, 3));
+	ASSERT_TRUE(IsBinInts(power->expr->b, BIN_MUL, -1, 4));
+	
+	ASSERT_TRUE(IsValFrac(EVAL(), -322, 81));
+}
+
 UTEST_F(SC, factorial) {
 	Value* val = PARSEVAL("5!");
 	ASSERT_EQ(val->type, VAL_UNARY);
@@ -264,6 +329,22 @@ UTEST_F(SC, nestedVectors) {
 	);
 }
 
+UTEST_F(SC, chainedSubscript) {
+	Value* val = PARSEVAL("a[3][i + 1]");
+	ASSERT_EQ(val->type, VAL_INDEX);
+	ASSERT_EQ(val->sub->base->type, VAL_VAR);
+	ASSERT_EQ(val->sub->indices->count, 2u);
+	ASSERT_TRUE(IsValInt(val->sub->indices->args[0], 3));
+	
+	RUN("a = <1, 2, 3, <4, 5>>");
+	RUN("i = 0");
+	ASSERT_TRUE(IsValInt(EVALSTR("a[3][i + 1]"), 5));
+	
+	/* A variable named like the builtin doesn't get in the way */
+	RUN("elem = 7");
+	ASSERT_TRUE(IsValInt(EVALSTR("a[2] + elem"), 10));
+}
+
 UTEST_F(SC, getFuncVecChained) {
 	RUN("getVec() = <1, 2, 3, <4, 5>>");
 	ASSERT_TRUE(IsValInt(EVALSTR("getVec()[3][1]"), 5));
@@ -291,6 +372,20 @@ UTEST_F(SC, vectorMap) {
 	);
 }
 
+UTEST_F(SC, nestedTemplates) {
+	/* mag is sqrt(dot(v, v)), whose argument sqrt passes on to its own template */
+	ASSERT_TRUE(IsValInt(EVALSTR("mag(<3, 4>)"), 5));
+	ASSERT_VALEQ(EVALSTR("norm(<3, 4>)"), VAL_VEC, 2,
+		VAL_FRAC, 3ll, 5ll,
+		VAL_FRAC, 4ll, 5ll
+	);
+	
+	/* Each call to map's template calls another template */
+	ASSERT_TRUE(IsValVecInts(EVALSTR("map(sqrt, <4, 9, 16>)"), 3, 2,3,4));
+	RUN("f(x) = sqrt(dot(x, x))");
+	ASSERT_TRUE(IsValVecInts(EVALSTR("map(f, <<3, 4>, <5, 12>>)"), 2, 5,13));
+}
+
 UTEST_F(SC, vectorMul) {
 	ASSERT_TRUE(IsValVecInts(EVALSTR("<1, 2, 3> * <4, 7, 2>"), 3, 4,14,6));
 }
@@ -405,3 +500,1035 @@ UTEST_F(SC, vecMapSqrtFracs) {
 			VAL_FRAC, 7ll, 3ll
 	);
 }
+
+UTEST_F(SC, intOverflowPromotes) {
+	Value* res = EVALSTR("9223372036854775807 + 1");
+	ASSERT_TRUE(IsValReal(res, 9223372036854775808.0));
+	ASSERT_TRUE(res->flags & VF_OVERFLOW);
+	
+	ASSERT_TRUE(IsValReal(EVALSTR("2^64"), 18446744073709551616.0));
+	ASSERT_TRUE(IsValReal(EVALSTR("-9223372036854775807 - 2"), -9223372036854775809.0));
+	ASSERT_TRUE(IsValInt(EVALSTR("2^62 + (2^62 - 1)"), 9223372036854775807ll));
+	
+	/* Operations on an overflowed value keep the flag */
+	res = EVALSTR("(2^70) / 4");
+	ASSERT_TRUE(IsValReal(res, 295147905179352825856.0));
+	ASSERT_TRUE(res->flags & VF_OVERFLOW);
+}
+
+UTEST_F(SC, fracOverflowStaysExact) {
+	/* The naive cross products overflow, but the reduced result fits */
+	ASSERT_TRUE(IsValInt(EVALSTR("(4611686018427387904/3) * (9/4611686018427387904)"), 3));
+	ASSERT_TRUE(IsValFrac(EVALSTR("1/3037000499 * 1/3037000499"), 1, 9223372030926249001ll));
+	ASSERT_TRUE(IsValFrac(EVALSTR("1/4611686018427387904 + 1/4611686018427387904"), 1, 2305843009213693952ll));
+	
+	/* These differ by less than a long double can tell apart */
+	Fraction* a = Fraction_new(4611686018427387903ll, 4611686018427387904ll);
+	Fraction* b = Fraction_new(4611686018427387902ll, 4611686018427387903ll);
+	Value* bval = ValFrac(b);
+	ASSERT_GT(Fraction_cmp(a, bval), 0);
+	Fraction_free(a);
+	Value_free(bval);
+	
+	a = Fraction_new(-4611686018427387903ll, 4611686018427387904ll);
+	b = Fraction_new(-4611686018427387902ll, 4611686018427387903ll);
+	bval = ValFrac(b);
+	ASSERT_LT(Fraction_cmp(a, bval), 0);
+	ASSERT_EQ(Fraction_cmp(b, bval), 0);
+	Fraction_free(a);
+	Value_free(bval);
+	
+	/* Roots that are exact but too big fall back to reals */
+	Value* res = EVALSTR("4611686018427387904^(3/2)");
+	ASSERT_TRUE(IsValReal(res, 9903520314283042199192993792.0));
+	ASSERT_TRUE(res->flags & VF_OVERFLOW);
+}
+
+UTEST_F(SC, lazyFracCanonical) {
+	/* Intermediate sums aren't reduced, but results always are */
+	ASSERT_TRUE(IsValFrac(EVALSTR("1/6 + 1/6 + 1/4 - 1/12"), 1, 2));
+	ASSERT_TRUE(IsValFrac(EVALSTR("x = 2/9 * 3/4"), 1, 6));
+	ASSERT_TRUE(IsValFrac(EVALSTR("x"), 1, 6));
+	ASSERT_VALEQ(EVALSTR("<1/4 + 1/4, 1/6 * 3/5>"), VAL_VEC, 2,
+		VAL_FRAC, 1ll,2ll,
+		VAL_FRAC, 1ll,10ll
+	);
+	
+	/* Whole numbers are never left as fractions */
+	ASSERT_TRUE(IsValInt(EVALSTR("<1, 2, 3>[(1/2) * 4]"), 3));
+	ASSERT_TRUE(IsValInt(EVALSTR("dot(<1/2, 1/3, 1/6>, <2, 3, 6>)"), 3));
+}
+
+UTEST_F(SC, floatMode) {
+	RUN("x = 1/3");
+	Context_setMode(F->ctx, MODE_FLOAT);
+	
+	ASSERT_TRUE(IsValReal(EVALSTR("3 / 4"), 0.75));
+	ASSERT_TRUE(IsValReal(EVALSTR("2 ^ -2"), 0.25));
+	ASSERT_TRUE(IsValReal(EVALSTR("(2 / 8) ^ 2"), 0.0625));
+	ASSERT_TRUE(IsValReal(EVALSTR("x * 3"), 1.0));
+	
+	/* Integers are still exact */
+	ASSERT_TRUE(IsValInt(EVALSTR("6 / 3"), 2));
+	ASSERT_TRUE(IsValInt(EVALSTR("<1, 2, 3>[4 / 2]"), 3));
+	
+	Context_setMode(F->ctx, MODE_EXACT);
+	ASSERT_TRUE(IsValFrac(EVALSTR("3 / 4"), 3, 4));
+}
+
+UTEST_F(SC, modularBuiltins) {
+	ASSERT_TRUE(IsValInt(EVALSTR("powmod(3, 200, 1000000007)"), 136318165));
+	ASSERT_TRUE(IsValInt(EVALSTR("powmod(2, 100, 2^62)"), 0));
+	ASSERT_TRUE(IsValInt(EVALSTR("powmod(-7, 3, 10)"), 7));
+	ASSERT_TRUE(IsValInt(EVALSTR("powmod(3, -1, 7)"), 5));
+	ASSERT_TRUE(IsValInt(EVALSTR("mulmod(9223372036854775806, 9223372036854775806, 9223372036854775807)"), 1));
+	ASSERT_TRUE(IsValInt(EVALSTR("invmod(3, 7)"), 5));
+	
+	/* Elementwise over vectors */
+	ASSERT_TRUE(IsValVecInts(EVALSTR("powmod(<2, 3, 5>, 3, 7)"), 3, 1, 6, 6));
+	ASSERT_TRUE(IsValVecInts(EVALSTR("mulmod(<2, 3>, <4, 5>, 7)"), 2, 1, 1));
+	
+	ASSERT_VALEQ(EVALSTR("invmod(2, 4)"), VAL_ERR,
+		ERR_MATH, "Math Error: 2 is not invertible modulo 4.\n"
+	);
+	
+	ASSERT_VALEQ(EVALSTR("powmod(2, 2, 0)"), VAL_ERR,
+		ERR_MATH, "Math Error: Builtin 'powmod' expects a positive integer modulus.\n"
+	);
+}
+
+UTEST_F(SC, importLongLines) {
+	char path[] = "/tmp/sc_test_XXXXXX";
+	int fd = mkstemp(path);
+	ASSERT_NE(fd, -1);
+	FILE* fp = fdopen(fd, "w");
+	ASSERT_TRUE(fp != NULL);
+	
+	/* Much longer than any fixed line buffer, and the last line has no newline */
+	fprintf(fp, "v = <0");
+	for(int i = 1; i < 5000; i++) {
+		fprintf(fp, ", %d", i);
+	}
+	fprintf(fp, "> # comment\nlast = v[4999] +\n 1");
+	fclose(fp);
+	
+	SuperCalc* sc = SuperCalc_new();
+	Error* err = SuperCalc_importFile(sc, path);
+	unlink(path);
+	ASSERT_TRUE(err == NULL);
+	
+	Variable* last = Context_get(sc->ctx, "last");
+	ASSERT_TRUE(last != NULL);
+	ASSERT_TRUE(IsValInt(last->val, 5000));
+	SuperCalc_free(sc);
+}
+
+UTEST_F(SC, statementCache) {
+	SuperCalc* sc = SuperCalc_new();
+	char line[64];
+	
+	strcpy(line, "x = 2");
+	Value_free(SuperCalc_runLine(sc, line, V_NONE));
+	
+	/* Same text, so the second run reuses the parse tree but still sees the new x */
+	for(int i = 0; i < 2; i++) {
+		strcpy(line, "x = x * 3  # comment");
+		Value_free(SuperCalc_runLine(sc, line, V_NONE));
+	}
+	
+	ASSERT_EQ(StmtCache_hits(sc->cache), 1ull);
+	ASSERT_EQ(StmtCache_misses(sc->cache), 2ull);
+	ASSERT_TRUE(IsValInt(Context_get(sc->ctx, "x")->val, 18));
+	
+	/* Changing how literals parse invalidates the cache */
+	strcpy(line, "0.5");
+	Value* val = SuperCalc_runLine(sc, line, V_NONE);
+	ASSERT_TRUE(IsValReal(val, 0.5));
+	Value_free(val);
+	
+	ASSERT_TRUE(SuperCalc_setDecimals(sc, "exact"));
+	strcpy(line, "0.5");
+	val = SuperCalc_runLine(sc, line, V_NONE);
+	ASSERT_TRUE(IsValFrac(val, 1, 2));
+	Value_free(val);
+	ASSERT_TRUE(SuperCalc_setDecimals(sc, "real"));
+	
+	SuperCalc_free(sc);
+}
+
+UTEST_F(SC, compiledImport) {
+	char path[] = "/tmp/sc_test_XXXXXX";
+	int fd = mkstemp(path);
+	ASSERT_NE(fd, -1);
+	FILE* fp = fdopen(fd, "w");
+	ASSERT_TRUE(fp != NULL);
+	
+	fprintf(fp,
+		"sq(x) = x ^ 2  # function\n"
+		"v = <1, 2/3, 4.5>\n"
+		"tmp = 1\n"
+		"~tmp\n"
+		"mode \"float\"\n"
+		"total = sq(v[0] + 2) + 5! +\n"
+		"  -v[2]\n");
+	fclose(fp);
+	
+	char* sccPath = Scc_path(path);
+	
+	/* The first import parses the file and compiles it, the second just loads the result */
+	for(int i = 0; i < 2; i++) {
+		SuperCalc* sc = SuperCalc_new();
+		sc->compileImports = true;
+		
+		Error* err = SuperCalc_importFile(sc, path);
+		ASSERT_TRUE(err == NULL);
+		ASSERT_EQ(access(sccPath, R_OK), 0);
+		ASSERT_EQ(StmtCache_misses(sc->cache), i == 0 ? 4ull : 0ull);
+		
+		ASSERT_TRUE(IsValReal(Context_get(sc->ctx, "total")->val, 124.5));
+		ASSERT_TRUE(Context_get(sc->ctx, "tmp") == NULL);
+		ASSERT_EQ(Context_getMode(sc->ctx), MODE_FLOAT);
+		SuperCalc_free(sc);
+	}
+	
+	unlink(sccPath);
+	unlink(path);
+	destroy(sccPath);
+}
+
+UTEST_F(SC, compiledImportFallback) {
+	char path[] = "/tmp/sc_test_XXXXXX";
+	int fd = mkstemp(path);
+	ASSERT_NE(fd, -1);
+	FILE* fp = fdopen(fd, "w");
+	ASSERT_TRUE(fp != NULL);
+	
+	/* The middle statement compiles, but is nested too deeply to read back */
+	fprintf(fp, "n += 1\ndeep = 0");
+	for(int i = 0; i < 10000; i++) {
+		fprintf(fp, " + 0");
+	}
+	fprintf(fp, "\nn += 1\n");
+	fclose(fp);
+	
+	char* sccPath = Scc_path(path);
+	
+	/* Nothing runs from a compiled file that can't be read completely, so the source is parsed instead */
+	for(int i = 0; i < 2; i++) {
+		SuperCalc* sc = SuperCalc_new();
+		sc->compileImports = true;
+		Context_setGlobal(sc->ctx, "n", ValInt(0));
+		
+		Error* err = SuperCalc_importFile(sc, path);
+		ASSERT_TRUE(err == NULL);
+		ASSERT_EQ(access(sccPath, R_OK), 0);
+		ASSERT_TRUE(IsValInt(Context_get(sc->ctx, "n")->val, 2));
+		ASSERT_TRUE(IsValInt(Context_get(sc->ctx, "deep")->val, 0));
+		SuperCalc_free(sc);
+	}
+	
+	unlink(sccPath);
+	unlink(path);
+	destroy(sccPath);
+}
+
+UTEST_F(SC, importOnce) {
+	char path[] = "/tmp/sc_test_XXXXXX";
+	int fd = mkstemp(path);
+	ASSERT_NE(fd, -1);
+	ASSERT_EQ(write(fd, "n += 1\n", 7), 7);
+	close(fd);
+	
+	SuperCalc* sc = SuperCalc_new();
+	char line[64];
+	
+	strcpy(line, "n = 0");
+	Value_free(SuperCalc_runLine(sc, line, V_NONE));
+	
+	/* A diamond of imports only runs the shared file once */
+	for(int i = 0; i < 3; i++) {
+		snprintf(line, sizeof(line), "@%s", path);
+		ASSERT_TRUE(SuperCalc_runLine(sc, line, V_NONE) == NULL);
+	}
+	ASSERT_TRUE(IsValInt(Context_get(sc->ctx, "n")->val, 1));
+	
+	/* Unless it's forced */
+	snprintf(line, sizeof(line), "@!%s", path);
+	ASSERT_TRUE(SuperCalc_runLine(sc, line, V_NONE) == NULL);
+	ASSERT_TRUE(IsValInt(Context_get(sc->ctx, "n")->val, 2));
+	
+	/* Or the file changed */
+	struct timespec times[2] = {{0, UTIME_OMIT}, {12345, 0}};
+	ASSERT_EQ(utimensat(AT_FDCWD, path, times, 0), 0);
+	snprintf(line, sizeof(line), "@%s", path);
+	ASSERT_TRUE(SuperCalc_runLine(sc, line, V_NONE) == NULL);
+	ASSERT_TRUE(IsValInt(Context_get(sc->ctx, "n")->val, 3));
+	
+	SuperCalc_free(sc);
+	unlink(path);
+}
+
+UTEST_F(SC, pushParser) {
+	Parser* parser = Parser_new("<push>");
+	ParsedLine line;
+	
+	/* Chunks split in the middle of lines and statements */
+	const char* chunk1 = "x = 1 +";
+	Parser_feed(parser, chunk1, strlen(chunk1));
+	ASSERT_EQ(Parser_next(parser, &line), PARSE_NEED_MORE);
+	ASSERT_TRUE(line.stmt == NULL);
+	
+	const char* chunk2 = "\n 2\n# comment\n\ny = x";
+	Parser_feed(parser, chunk2, strlen(chunk2));
+	ASSERT_EQ(Parser_next(parser, &line), PARSE_LINE);
+	ASSERT_EQ(line.type, LINE_STATEMENT);
+	ASSERT_EQ(line.lineNumber, 1u);
+	Value* val = Statement_eval(line.stmt, F->ctx, V_NONE);
+	ASSERT_TRUE(IsValInt(val, 3));
+	Value_free(val);
+	ParsedLine_destroy(&line);
+	
+	/* The last line only counts once the input is finished */
+	ASSERT_EQ(Parser_next(parser, &line), PARSE_NEED_MORE);
+	ASSERT_TRUE(Parser_hasPending(parser));
+	const char* chunk3 = " * 4";
+	Parser_feed(parser, chunk3, strlen(chunk3));
+	Parser_finish(parser);
+	ASSERT_EQ(Parser_next(parser, &line), PARSE_LINE);
+	ASSERT_EQ(line.lineNumber, 5u);
+	val = Statement_eval(line.stmt, F->ctx, V_NONE);
+	ASSERT_TRUE(IsValInt(val, 12));
+	Value_free(val);
+	ParsedLine_destroy(&line);
+	
+	ASSERT_EQ(Parser_next(parser, &line), PARSE_END);
+	ASSERT_FALSE(Parser_hasPending(parser));
+	Parser_free(parser);
+}
+
+UTEST_F(SC, parserDirectives) {
+	Parser* parser = Parser_new("<push>");
+	Parser_allowVerbosity(parser);
+	ParsedLine line;
+	
+	const char* input =
+		"~ x\n"
+		"~~~\n"
+		"@!lib.sc\n"
+		"mode \"float\"\n"
+		"?t 1 +\n"
+		"2\n"
+		"mode \"float\n"
+		"~\n";
+	Parser_feed(parser, input, strlen(input));
+	Parser_finish(parser);
+	
+	ASSERT_EQ(Parser_next(parser, &line), PARSE_LINE);
+	ASSERT_EQ(line.type, LINE_DELETE);
+	ASSERT_STREQ(line.name, "x");
+	ParsedLine_destroy(&line);
+	
+	ASSERT_EQ(Parser_next(parser, &line), PARSE_LINE);
+	ASSERT_EQ(line.type, LINE_CLEAR);
+	ParsedLine_destroy(&line);
+	
+	ASSERT_EQ(Parser_next(parser, &line), PARSE_LINE);
+	ASSERT_EQ(line.type, LINE_IMPORT);
+	ASSERT_STREQ(line.name, "lib.sc");
+	ASSERT_TRUE(line.force);
+	ParsedLine_destroy(&line);
+	
+	ASSERT_EQ(Parser_next(parser, &line), PARSE_LINE);
+	ASSERT_EQ(line.type, LINE_COMMAND);
+	ASSERT_STREQ(line.name, "mode");
+	ASSERT_STREQ(line.arg, "float");
+	ASSERT_STREQ(line.text, "mode \"float\"");
+	ParsedLine_destroy(&line);
+	
+	/* Verbosity comes before the statement, which continues onto the next line */
+	ASSERT_EQ(Parser_next(parser, &line), PARSE_LINE);
+	ASSERT_EQ(line.type, LINE_STATEMENT);
+	ASSERT_EQ(line.verbosity, V_TREE);
+	ASSERT_EQ(line.lineNumber, 5u);
+	ParsedLine_destroy(&line);
+	
+	ASSERT_EQ(Parser_next(parser, &line), PARSE_LINE);
+	ASSERT_EQ(line.type, LINE_ERROR);
+	ASSERT_EQ(line.err->type, ERR_SYNTAX);
+	ASSERT_EQ(line.lineNumber, 7u);
+	ParsedLine_destroy(&line);
+	
+	/* A deletion can't continue past the end of the input */
+	ASSERT_EQ(Parser_next(parser, &line), PARSE_LINE);
+	ASSERT_EQ(line.type, LINE_ERROR);
+	ParsedLine_destroy(&line);
+	
+	ASSERT_EQ(Parser_next(parser, &line), PARSE_END);
+	Parser_free(parser);
+}
+
+UTEST_F(SC, runLines) {
+	SuperCalc* sc = SuperCalc_new();
+	
+	/* The same dispatch as the prompt, across lines of one request */
+	char* line = strdup("mode \"float\"");
+	Value_free(SuperCalc_runLine(sc, line, V_NONE));
+	destroy(line);
+	
+	Value* ret = SuperCalc_runLines(sc, "mode \"exact\"\nq = 1 +\n 2\n~q\nw = 1/2 # half\n\nw + 1");
+	ASSERT_TRUE(IsValFrac(ret, 3, 2));
+	Value_free(ret);
+	ASSERT_EQ(Context_getMode(sc->ctx), MODE_EXACT);
+	
+	/* Stops at the first error, whatever comes after it */
+	ret = SuperCalc_runLines(sc, "q\nw = 5");
+	ASSERT_EQ(ret->type, VAL_ERR);
+	ASSERT_EQ(ret->err->type, ERR_NAME);
+	Value_free(ret);
+	ret = SuperCalc_runLines(sc, "w");
+	ASSERT_TRUE(IsValFrac(ret, 1, 2));
+	Value_free(ret);
+	
+	ret = SuperCalc_runLines(sc, "bogus \"x\"");
+	ASSERT_EQ(ret->type, VAL_ERR);
+	ASSERT_EQ(ret->err->type, ERR_NAME);
+	Value_free(ret);
+	
+	SuperCalc_free(sc);
+}
+
+UTEST_F(SC, extendedMode) {
+	Context_setMode(F->ctx, MODE_EXTENDED);
+	
+	/* Squaring the double-double root of 2 should give 2 back to ~32 digits */
+	Value* res = EVALSTR("sqrt(2)");
+	ASSERT_EQ(res->type, VAL_XREAL);
+	DDReal err = DDReal_sub(DDReal_mul(*res->xreal, *res->xreal), DDReal_fromInt(2));
+	ASSERT_LT(fabs(err.hi), 1e-30);
+	
+	res = EVALSTR("ln(e) - 1");
+	ASSERT_EQ(res->type, VAL_XREAL);
+	ASSERT_LT(fabs(res->xreal->hi), 1e-30);
+	
+	/* Exact arithmetic is unaffected */
+	ASSERT_TRUE(IsValFrac(EVALSTR("1/3 + 1/6"), 1, 2));
+	ASSERT_TRUE(IsValInt(EVALSTR("2 ^ 10"), 1024));
+	
+	/* Overflow gives inf rather than an error term of inf - inf */
+	const char* overflows[] = {"1e300 * 1e300", "1e308 + 1e308", "2.0 ^ 1100", "10 ^ 400", "1e308 / 1e-10"};
+	unsigned i;
+	for(i = 0; i < sizeof(overflows) / sizeof(overflows[0]); i++) {
+		res = EVALSTR(overflows[i]);
+		ASSERT_EQ(res->type, VAL_XREAL);
+		ASSERT_TRUE(isinf(res->xreal->hi) && res->xreal->hi > 0);
+	}
+	
+	/* Factors near the top of the range don't overflow while being split */
+	res = EVALSTR("-1e308");
+	ASSERT_EQ(res->type, VAL_XREAL);
+	ASSERT_EQ(res->xreal->hi, -1e308);
+	
+	/* Integer overflow is still marked when the result is redone in extended precision */
+	res = EVALSTR("9223372036854775807 + 1");
+	ASSERT_EQ(res->type, VAL_XREAL);
+	ASSERT_EQ(res->xreal->hi, 9223372036854775808.0);
+	ASSERT_TRUE(res->flags & VF_OVERFLOW);
+	char* repr = Value_repr(res, false, true);
+	ASSERT_TRUE(strstr(repr, "(overflow)") != NULL);
+	destroy(repr);
+	ASSERT_TRUE(EVALSTR("(2^70) / 4")->flags & VF_OVERFLOW);
+	
+	Context_setMode(F->ctx, MODE_EXACT);
+	ASSERT_TRUE(IsValReal(EVALSTR("pi"), M_PI));
+}
+
+UTEST_F(SC, builtinTable) {
+	/* The generated table has to agree with the builtin arrays */
+	unsigned i;
+	for(i = 0; i < g_mathBuiltinCount; i++) {
+		Variable* var = Builtin_lookup(g_mathBuiltins[i].name);
+		ASSERT_TRUE(var != NULL);
+		ASSERT_TRUE(var->val->blt == &g_mathBuiltins[i]);
+	}
+	for(i = 0; i < g_vectorBuiltinCount; i++) {
+		Variable* var = Builtin_lookup(g_vectorBuiltins[i].name);
+		ASSERT_TRUE(var != NULL);
+		ASSERT_TRUE(var->val->blt == &g_vectorBuiltins[i]);
+	}
+	ASSERT_TRUE(Builtin_lookup("ans") == NULL);
+	ASSERT_TRUE(Builtin_lookup("sqr") == NULL);
+	
+	/* Variables shadow builtins until they're deleted */
+	Context_setGlobal(F->ctx, "e", ValInt(5));
+	ASSERT_TRUE(IsValInt(EVALSTR("e"), 5));
+	ASSERT_TRUE(Context_del(F->ctx, "e") == NULL);
+	ASSERT_TRUE(IsValReal(EVALSTR("e"), M_E));
+}
+
+UTEST_F(SC, cachedLookups) {
+	/* Function bodies are evaluated over and over, so their lookups are cached */
+	RUN("f(x) = x + a");
+	RUN("a = 1");
+	ASSERT_TRUE(IsValInt(EVALSTR("f(1)"), 2));
+	RUN("a = 5");
+	ASSERT_TRUE(IsValInt(EVALSTR("f(1)"), 6));
+	ASSERT_TRUE(Context_del(F->ctx, "a") == NULL);
+	ASSERT_EQ(EVALSTR("f(1)")->type, VAL_ERR);
+	RUN("a = 2");
+	ASSERT_TRUE(IsValInt(EVALSTR("f(1)"), 3));
+	
+	/* Parameters are never mistaken for the global they were cached as */
+	RUN("g(a) = f(a) * a");
+	ASSERT_TRUE(IsValInt(EVALSTR("g(3)"), 15));
+	
+	/* A builtin that was called stops being used once a variable shadows it */
+	RUN("h(x) = abs(x)");
+	ASSERT_TRUE(IsValInt(EVALSTR("h(-3)"), 3));
+	RUN("abs(x) = 7");
+	ASSERT_TRUE(IsValInt(EVALSTR("h(-3)"), 7));
+	ASSERT_TRUE(Context_del(F->ctx, "abs") == NULL);
+	ASSERT_TRUE(IsValInt(EVALSTR("h(-3)"), 3));
+	
+	/* Clearing everything invalidates every cache */
+	Context_clear(F->ctx);
+	ASSERT_EQ(EVALSTR("f(1)")->type, VAL_ERR);
+}
+
+UTEST_F(SC, borrowedReads) {
+	/* Globals are read where they're stored, which mustn't change them */
+	RUN("v = <1/2, 1/3>");
+	ASSERT_TRUE(IsValFrac(EVALSTR("dot(v, v)"), 13, 36));
+	RUN("g = |x| x * 2");
+	ASSERT_TRUE(IsValVecInts(EVALSTR("map(g, <1, 2, 3>)"), 3, 2,4,6));
+	ASSERT_TRUE(IsValInt(EVALSTR("g(5)"), 10));
+	ASSERT_VALEQ(EVALSTR("map(g, v)"), VAL_VEC, 2,
+		VAL_INT, 1ll,
+		VAL_FRAC, 2ll, 3ll
+	);
+	ASSERT_VALEQ(EVALSTR("v"), VAL_VEC, 2,
+		VAL_FRAC, 1ll, 2ll,
+		VAL_FRAC, 1ll, 3ll
+	);
+	
+	/* Fractions stored before switching to floating mode still have to be converted */
+	Context_setMode(F->ctx, MODE_FLOAT);
+	ASSERT_TRUE(IsValReal(EVALSTR("dot(v, v)"), 13.0 / 36.0));
+	Context_setMode(F->ctx, MODE_EXACT);
+	
+	/* Literal functions are borrowed from the tree, but constants like pi are still evaluated */
+	ASSERT_TRUE(IsValVecInts(EVALSTR("map(|x| x + 1, <1, 2>)"), 2, 2,3));
+	ASSERT_EQ(EVALSTR("dot(pi, v)")->type, VAL_ERR);
+}
+
+UTEST_F(SC, decimalLiterals) {
+	/* The fast path must round exactly like strtod */
+	ASSERT_TRUE(IsValReal(EVALSTR("0.1"), 0.1));
+	ASSERT_TRUE(IsValReal(EVALSTR("123.456e-7"), 123.456e-7));
+	ASSERT_TRUE(IsValReal(EVALSTR("1e300"), 1e300));
+	ASSERT_TRUE(IsValReal(EVALSTR("3.14159265358979323846264338"), 3.14159265358979323846264338));
+	ASSERT_TRUE(IsValReal(EVALSTR("99999999999999999999"), 99999999999999999999.0));
+	ASSERT_TRUE(IsValInt(EVALSTR("9223372036854775807"), 9223372036854775807LL));
+	
+	/* Literals out of a double's range are rejected rather than becoming inf or 0 */
+	ASSERT_VALEQ(PARSEVAL("1e400"), VAL_ERR,
+		ERR_SYNTAX, "Syntax Error: Unexpected character: '1'.\n"
+	);
+	ASSERT_VALEQ(PARSEVAL("1e-400"), VAL_ERR,
+		ERR_SYNTAX, "Syntax Error: Unexpected character: '1'.\n"
+	);
+	
+	/* No digits after the e means it's the constant */
+	ASSERT_TRUE(IsValReal(EVALSTR("2e"), 2 * M_E));
+	
+	Input_current()->exactDecimals = true;
+	ASSERT_TRUE(IsValFrac(EVALSTR("0.1"), 1, 10));
+	ASSERT_TRUE(IsValFrac(EVALSTR("0.1 + 0.2"), 3, 10));
+	ASSERT_TRUE(IsValFrac(EVALSTR("2.50"), 5, 2));
+	ASSERT_TRUE(IsValInt(EVALSTR("1.5e3"), 1500));
+	ASSERT_TRUE(IsValFrac(EVALSTR("25e-3"), 1, 40));
+	
+	/* Too many digits for a fraction, so it stays a real */
+	ASSERT_TRUE(IsValReal(EVALSTR("1e-30"), 1e-30));
+	Input_current()->exactDecimals = false;
+}
+
+UTEST_F(SC, snapshot) {
+	char path[] = "/tmp/sc_test_XXXXXX";
+	int fd = mkstemp(path);
+	ASSERT_NE(fd, -1);
+	close(fd);
+	
+	static const char* const lines[] = {
+		"sq(x) = x ^ 2",
+		"v = <1, 2/3, sq(3)>",
+		"half = 1/2",
+		"s = sqrt",
+		"half * 4",
+		"mode \"float\"",
+	};
+	
+	SuperCalc* sc = SuperCalc_new();
+	char line[64];
+	size_t i;
+	for(i = 0; i < ARRSIZE(lines); i++) {
+		strcpy(line, lines[i]);
+		Value_free(SuperCalc_runLine(sc, line, V_NONE));
+	}
+	
+	snprintf(line, sizeof(line), "save \"%s\"", path);
+	ASSERT_TRUE(SuperCalc_runLine(sc, line, V_NONE) == NULL);
+	SuperCalc_free(sc);
+	
+	/* Loading replaces whatever was there before */
+	sc = SuperCalc_new();
+	strcpy(line, "junk = 5");
+	Value_free(SuperCalc_runLine(sc, line, V_NONE));
+	snprintf(line, sizeof(line), "load \"%s\"", path);
+	ASSERT_TRUE(SuperCalc_runLine(sc, line, V_NONE) == NULL);
+	
+	ASSERT_TRUE(Context_get(sc->ctx, "junk") == NULL);
+	ASSERT_EQ(Context_getMode(sc->ctx), MODE_FLOAT);
+	ASSERT_TRUE(IsValInt(Context_get(sc->ctx, "ans")->val, 2));
+	ASSERT_TRUE(IsValFrac(Context_get(sc->ctx, "half")->val, 1, 2));
+	
+	Value* v = Context_get(sc->ctx, "v")->val;
+	ASSERT_EQ(v->type, VAL_VEC);
+	ASSERT_TRUE(IsValFrac(v->vec->vals->args[1], 2, 3));
+	ASSERT_TRUE(IsValInt(v->vec->vals->args[2], 9));
+	
+	/* Functions keep their parsed bodies and builtins still resolve */
+	strcpy(line, "sq(5) + s(16)");
+	Value* val = SuperCalc_runLine(sc, line, V_NONE);
+	ASSERT_TRUE(IsValReal(val, 29));
+	Value_free(val);
+	
+	/* A corrupt file is rejected without touching the context */
+	fd = open(path, O_WRONLY);
+	ASSERT_NE(fd, -1);
+	ASSERT_EQ(pwrite(fd, "X", 1, 40), 1);
+	close(fd);
+	
+	snprintf(line, sizeof(line), "load \"%s\"", path);
+	val = SuperCalc_runLine(sc, line, V_NONE);
+	ASSERT_TRUE(val != NULL && val->type == VAL_ERR);
+	Value_free(val);
+	ASSERT_TRUE(Context_get(sc->ctx, "sq") != NULL);
+	
+	SuperCalc_free(sc);
+	unlink(path);
+}
+
+UTEST_F(SC, serialLimits) {
+	/* Values nested deeper than a reader will go are rejected instead of overflowing the stack */
+	Value* deep = ValInt(3);
+	unsigned i;
+	for(i = 1; i < 10000; i++) {
+		deep = ValUnary(UnOp_new(UN_FACT, deep));
+	}
+	
+	SerialWriter w;
+	memset(&w, 0, sizeof(w));
+	Serial_putValue(&w, deep);
+	SerialReader r = {CAST_NONNULL(w.data), CAST_NONNULL(w.data) + w.len, 0};
+	Value* val = Serial_getValue(&r);
+	ASSERT_TRUE(val != NULL);
+	Value_free(val);
+	
+	deep = ValUnary(UnOp_new(UN_FACT, deep));
+	w.len = 0;
+	Serial_putValue(&w, deep);
+	r = (SerialReader){CAST_NONNULL(w.data), CAST_NONNULL(w.data) + w.len, 0};
+	ASSERT_TRUE(Serial_getValue(&r) == NULL);
+	Value_free(deep);
+	
+	/* So are placeholders of unknown types */
+	Value* ph = ValPlace(Placeholder_new(PH_VAL, 1));
+	w.len = 0;
+	Serial_putValue(&w, ph);
+	Value_free(ph);
+	r = (SerialReader){CAST_NONNULL(w.data), CAST_NONNULL(w.data) + w.len, 0};
+	val = Serial_getValue(&r);
+	ASSERT_TRUE(val != NULL && val->type == VAL_PLACE && val->ph->type == PH_VAL);
+	Value_free(val);
+	
+	CAST_NONNULL(w.data)[2] = PH_VAL + 1;
+	r = (SerialReader){CAST_NONNULL(w.data), CAST_NONNULL(w.data) + w.len, 0};
+	ASSERT_TRUE(Serial_getValue(&r) == NULL);
+	Serial_freeWriter(&w);
+}
+
+UTEST_F(SC, batchMode) {
+	static const char input[] =
+		"x = 3\n"
+		"1/0\n"
+		"\n"
+		"sq(a) = a ^ 2  # comment\n"
+		"<1, 2> * sq(x)\n"
+		"nope\n"
+		"x / 2";
+	
+	/* A pipe can't be mapped, so this reads it in blocks */
+	int fds[2];
+	ASSERT_EQ(pipe(fds), 0);
+	ASSERT_EQ(write(fds[1], input, sizeof(input) - 1), (ssize_t)(sizeof(input) - 1));
+	close(fds[1]);
+	
+	char* output = NULL;
+	size_t outputSize = 0;
+	FILE* out = open_memstream(&output, &outputSize);
+	ASSERT_TRUE(out != NULL);
+	
+	/* Whatever the interpreter was reading from before is left alone */
+	SuperCalc* sc = SuperCalc_new();
+	LineReader* reader = LineReader_empty();
+	sc->input.reader = reader;
+	ASSERT_EQ(SuperCalc_runBatch(sc, fds[0], out), 2u);
+	ASSERT_TRUE(sc->input.reader == reader);
+	LineReader_free(reader);
+	SuperCalc_free(sc);
+	close(fds[0]);
+	fclose(out);
+	
+	ASSERT_STREQ(output,
+		"1\t=\t3\n"
+		"2\t!\tMath Error: Division by zero.\n"
+		"4\t=\t|a| a ^ 2\n"
+		"5\t=\t<9, 18>\n"
+		"6\t!\tName Error: No variable named 'nope' found.\n"
+		"7\t=\t3/2 (1.5)\n");
+	free(output);
+}
+
+static char* runBatchString(unsigned jobs, const char* input) {
+	int fds[2];
+	if(pipe(fds) != 0) {
+		return NULL;
+	}
+	
+	size_t len = strlen(input);
+	if(write(fds[1], input, len) != (ssize_t)len) {
+		return NULL;
+	}
+	close(fds[1]);
+	
+	char* output = NULL;
+	size_t outputSize = 0;
+	FILE* out = open_memstream(&output, &outputSize);
+	
+	SuperCalc* sc = SuperCalc_new();
+	sc->jobs = jobs;
+	SuperCalc_runBatch(sc, fds[0], out);
+	SuperCalc_free(sc);
+	
+	close(fds[0]);
+	fclose(out);
+	return output;
+}
+
+UTEST_F(SC, parallelBatch) {
+	/* Enough lines in a row to be evaluated in parallel, with some that depend on ans */
+	char input[8192] = "twice() = ans * 2\nv = <1, 2, 3>\n";
+	for(int i = 0; i < 100; i++) {
+		char line[64];
+		switch(i % 5) {
+			case 0: snprintf(line, sizeof(line), "%d / 7 + v[%d]\n", i, i % 3); break;
+			case 1: snprintf(line, sizeof(line), "sqrt(%d) * 2\n", i); break;
+			case 2: snprintf(line, sizeof(line), "ans + 1\n"); break;
+			case 3: snprintf(line, sizeof(line), "twice()\n"); break;
+			case 4: snprintf(line, sizeof(line), i % 20 == 4 ? "v = v * 2\n" : "1/0\n"); break;
+		}
+		strcat(input, line);
+	}
+	
+	/* Lines that change the context wait for the ones before them, even when split across lines */
+	strcat(input, "w =\n  v[1] / 3\nw + 1\n~w\nw\nmode \"float\"\n1/3\n");
+	
+	char* serial = runBatchString(1, input);
+	char* parallel = runBatchString(4, input);
+	ASSERT_TRUE(serial != NULL && parallel != NULL);
+	ASSERT_STREQ(serial, parallel);
+	ASSERT_TRUE(strstr(parallel, "\t=\t67/3 (") != NULL);
+	ASSERT_TRUE(strstr(parallel, "\t!\tName Error: No variable named 'w' found.\n") != NULL);
+	ASSERT_TRUE(strstr(parallel, "\t=\t0.333333333333333\n") != NULL);
+	free(serial);
+	free(parallel);
+}
+
+UTEST_F(SC, jsonlMode) {
+	static const char input[] =
+		"{\"id\": 1, \"expr\": \"x = 3\"}\n"
+		"{\"expr\": \"x / 2\", \"id\": \"half\"}\n"
+		"{\"id\": 3, \"expr\": \"1/0\", \"extra\": [1, {\"a\": null}]}\n"
+		"not json\n"
+		"\n"
+		"{\"id\": 5, \"expr\": \"<x,\\t\\u0031>\"}\n"
+		"{\"id\": 6, \"expr\": \"9223372036854775807 + 1\"}\n"
+		"{\"id\": 7, \"expr\": \"2\\nxyz\"}\n"
+		"{\"id\": 8, \"expr\": \"1 +\\n 2\"}\n";
+	
+	int fds[2];
+	ASSERT_EQ(pipe(fds), 0);
+	ASSERT_EQ(write(fds[1], input, sizeof(input) - 1), (ssize_t)(sizeof(input) - 1));
+	close(fds[1]);
+	
+	char* output = NULL;
+	size_t outputSize = 0;
+	FILE* out = open_memstream(&output, &outputSize);
+	ASSERT_TRUE(out != NULL);
+	
+	SuperCalc* sc = SuperCalc_new();
+	ASSERT_EQ(SuperCalc_runJsonl(sc, fds[0], out), 3u);
+	SuperCalc_free(sc);
+	close(fds[0]);
+	fclose(out);
+	
+	ASSERT_STREQ(output,
+		"{\"id\":1,\"value\":\"3\",\"approx\":3,\"error\":null}\n"
+		"{\"id\":\"half\",\"value\":\"3/2\",\"approx\":1.5,\"error\":null}\n"
+		"{\"id\":3,\"value\":null,\"approx\":null,\"error\":\"Math Error: Division by zero.\"}\n"
+		"{\"id\":null,\"value\":null,\"approx\":null,\"error\":\"Runtime Error: Invalid request: expected an object.\"}\n"
+		"{\"id\":5,\"value\":\"<3, 1>\",\"approx\":null,\"error\":null}\n"
+		"{\"id\":6,\"value\":\"9.22337203685478e+18\",\"approx\":9.2233720368547758e+18,\"overflow\":true,\"error\":null}\n"
+		"{\"id\":7,\"value\":null,\"approx\":null,\"error\":\"Name Error: No variable named 'xyz' found.\"}\n"
+		"{\"id\":8,\"value\":\"3\",\"approx\":3,\"error\":null}\n");
+	free(output);
+}
+
+static void* serveThread(void* server) {
+	Server_run(server);
+	return NULL;
+}
+
+static FILE* serverConnect(const char* path) {
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+	
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(fd < 0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+		return NULL;
+	}
+	
+	FILE* ret = fdopen(fd, "r+");
+	setvbuf(ret, NULL, _IOLBF, 0);
+	return ret;
+}
+
+static const char* serverRequest(FILE* conn, const char* request) {
+	static char response[256];
+	fprintf(conn, "%s\n", request);
+	fflush(conn);
+	if(fgets(response, sizeof(response), conn) == NULL) {
+		return "";
+	}
+	
+	response[strcspn(response, "\n")] = '\0';
+	return response;
+}
+
+UTEST_F(SC, serveSessions) {
+	char libPath[] = "/tmp/sc_test_XXXXXX";
+	int fd = mkstemp(libPath);
+	ASSERT_TRUE(fd >= 0);
+	static const char lib[] = "k = 7\nsq(x) = x ^ 2\n";
+	ASSERT_EQ(write(fd, lib, sizeof(lib) - 1), (ssize_t)(sizeof(lib) - 1));
+	close(fd);
+	
+	SuperCalc* sc = SuperCalc_new();
+	ASSERT_TRUE(SuperCalc_importFile(sc, libPath) == NULL);
+	
+	char sockPath[64];
+	snprintf(sockPath, sizeof(sockPath), "%s.sock", libPath);
+	Error* err = NULL;
+	Server* server = Server_new(sc, sockPath, 2, &err);
+	ASSERT_TRUE(server != NULL);
+	pthread_t thread;
+	ASSERT_EQ(pthread_create(&thread, NULL, &serveThread, server), 0);
+	
+	FILE* a = serverConnect(sockPath);
+	FILE* b = serverConnect(sockPath);
+	ASSERT_TRUE(a != NULL && b != NULL);
+	
+	/* Each connection has its own session on top of the shared library */
+	ASSERT_STREQ(serverRequest(a, "{\"id\": 1, \"expr\": \"k = sq(k)\"}"),
+		"{\"id\":1,\"value\":\"49\",\"approx\":49,\"error\":null}");
+	ASSERT_STREQ(serverRequest(b, "{\"id\": 2, \"expr\": \"k\"}"),
+		"{\"id\":2,\"value\":\"7\",\"approx\":7,\"error\":null}");
+	ASSERT_STREQ(serverRequest(a, "{\"id\": 3, \"expr\": \"k + ans\"}"),
+		"{\"id\":3,\"value\":\"98\",\"approx\":98,\"error\":null}");
+	
+	/* Deleting a name the session changed uncovers the shared one again */
+	ASSERT_STREQ(serverRequest(a, "{\"id\": 4, \"expr\": \"~k\"}"),
+		"{\"id\":4,\"value\":null,\"approx\":null,\"error\":null}");
+	ASSERT_STREQ(serverRequest(a, "{\"id\": 5, \"expr\": \"k\"}"),
+		"{\"id\":5,\"value\":\"7\",\"approx\":7,\"error\":null}");
+	
+	/* Named sessions are shared between connections */
+	ASSERT_STREQ(serverRequest(a, "{\"session\": \"s\", \"id\": 6, \"expr\": \"y = 1/2\"}"),
+		"{\"id\":6,\"value\":\"1/2\",\"approx\":0.5,\"error\":null}");
+	ASSERT_STREQ(serverRequest(b, "{\"session\": \"s\", \"id\": 7, \"expr\": \"y + k\"}"),
+		"{\"id\":7,\"value\":\"15/2\",\"approx\":7.5,\"error\":null}");
+	ASSERT_STREQ(serverRequest(b, "{\"id\": 8, \"expr\": \"y\"}"),
+		"{\"id\":8,\"value\":null,\"approx\":null,\"error\":\"Name Error: No variable named 'y' found.\"}");
+	
+	/* Named sessions last until the server exits, so only so many can be created */
+	char request[128];
+	unsigned i;
+	for(i = 1; i < 1024; i++) {
+		snprintf(request, sizeof(request), "{\"session\": \"s%u\", \"id\": 9, \"expr\": \"1\"}", i);
+		ASSERT_STREQ(serverRequest(a, request), "{\"id\":9,\"value\":\"1\",\"approx\":1,\"error\":null}");
+	}
+	ASSERT_STREQ(serverRequest(a, "{\"session\": \"extra\", \"id\": 10, \"expr\": \"1\"}"),
+		"{\"id\":10,\"value\":null,\"approx\":null,\"error\":\"Runtime Error: Too many named sessions (at most 1024).\"}");
+	ASSERT_STREQ(serverRequest(b, "{\"session\": \"s\", \"id\": 11, \"expr\": \"y\"}"),
+		"{\"id\":11,\"value\":\"1/2\",\"approx\":0.5,\"error\":null}");
+	
+	fclose(a);
+	fclose(b);
+	Server_stop(server);
+	pthread_join(thread, NULL);
+	Server_free(server);
+	SuperCalc_free(sc);
+	unlink(libPath);
+	
+	struct stat st;
+	ASSERT_NE(stat(sockPath, &st), 0);
+}
+
+/* Each thread checks its own interpreter, counting wrong answers */
+static void* embedThread(void* data) {
+	long scale = *(long*)data;
+	sc_interp* interp = sc_new();
+	
+	char line[64];
+	char* result;
+	snprintf(line, sizeof(line), "f(x) = x * %ld", scale);
+	sc_eval(interp, line, &result);
+	sc_free_string(result);
+	
+	long wrong = 0;
+	for(long i = 0; i < 500; i++) {
+		snprintf(line, sizeof(line), "f(%ld) + <1, 2, 3>[1]", i);
+		if(sc_eval(interp, line, &result) != 0 || atol(result) != i * scale + 2) {
+			wrong++;
+		}
+		sc_free_string(result);
+	}
+	
+	/* Incomplete lines are errors instead of waiting for more input */
+	if(sc_eval(interp, "1 +", &result) != -1 || strstr(result, "Premature end") == NULL) {
+		wrong++;
+	}
+	sc_free_string(result);
+	
+	sc_free(interp);
+	*(long*)data = wrong;
+	return NULL;
+}
+
+UTEST_F(SC, embedConcurrent) {
+	pthread_t threads[2];
+	long data[2] = {3, 5};
+	int i;
+	for(i = 0; i < 2; i++) {
+		ASSERT_EQ(pthread_create(&threads[i], NULL, &embedThread, &data[i]), 0);
+	}
+	for(i = 0; i < 2; i++) {
+		pthread_join(threads[i], NULL);
+		ASSERT_EQ(data[i], 0);
+	}
+	
+	/* Errors come back to the caller instead of being printed */
+	sc_interp* interp = sc_new();
+	char* result;
+	ASSERT_EQ(sc_eval(interp, "~ans", &result), -1);
+	ASSERT_TRUE(strstr(result, "Cannot delete special variable") != NULL);
+	sc_free_string(result);
+	ASSERT_EQ(sc_eval(interp, "mode \"float\"", &result), 0);
+	ASSERT_TRUE(result == NULL);
+	ASSERT_EQ(sc_set_mode(interp, "bogus"), -1);
+	sc_free(interp);
+}
+
+UTEST_F(SC, prepared) {
+	sc_interp* interp = sc_new();
+	char* result;
+	ASSERT_EQ(sc_eval(interp, "k = 10", &result), 0);
+	sc_free_string(result);
+	
+	/* Names that are already defined aren't parameters */
+	sc_prepared* stmt = sc_prepare(interp, "3x^2 + y * k + sqrt(x)", &result);
+	ASSERT_TRUE(stmt != NULL);
+	ASSERT_EQ(sc_param_count(stmt), 2);
+	ASSERT_STREQ(sc_param_name(stmt, 0), "x");
+	ASSERT_EQ(sc_param_index(stmt, "y"), 1);
+	ASSERT_EQ(sc_param_index(stmt, "k"), -1);
+	
+	ASSERT_EQ(sc_bind_int(stmt, 0, 4), 0);
+	ASSERT_EQ(sc_execute(stmt, &result), -1);
+	ASSERT_STREQ(result, "Name Error: Parameter 'y' has no value.");
+	sc_free_string(result);
+	
+	long long i;
+	for(i = 0; i < 100; i++) {
+		sc_bind_int(stmt, sc_param_index(stmt, "y"), i);
+		double value;
+		ASSERT_EQ(sc_execute_double(stmt, &value, &result), 0);
+		ASSERT_EQ(value, 50.0 + 10 * i);
+	}
+	
+	ASSERT_EQ(sc_bind_double(stmt, 2, 1.0), -1);
+	ASSERT_EQ(sc_bind_double(stmt, 1, 0.5), 0);
+	ASSERT_EQ(sc_execute(stmt, &result), 0);
+	ASSERT_STREQ(result, "55");
+	sc_free_string(result);
+	sc_prepared_free(stmt);
+	
+	ASSERT_TRUE(sc_prepare(interp, "x +", &result) == NULL);
+	ASSERT_STREQ(result, "Syntax Error: Premature end of input.");
+	sc_free_string(result);
+	sc_free(interp);
+}
+
+UTEST_F(SC, preparedCsv) {
+	static const char input[] =
+		"id,x,y\n"
+		"1,2,3\n"
+		"2, \"1/2\" ,0\n"
+		"\n"
+		"3,4\n"
+		"4,\"<1, 2>\",0\n"
+		"5,nope,1\n"
+		"6,bad\n";
+	
+	int fds[2];
+	ASSERT_EQ(pipe(fds), 0);
+	ASSERT_EQ(write(fds[1], input, sizeof(input) - 1), (ssize_t)(sizeof(input) - 1));
+	close(fds[1]);
+	
+	char* output = NULL;
+	size_t outputSize = 0;
+	FILE* out = open_memstream(&output, &outputSize);
+	ASSERT_TRUE(out != NULL);
+	
+	/* Whatever the interpreter was reading from before is left alone */
+	SuperCalc* sc = SuperCalc_new();
+	LineReader* reader = LineReader_empty();
+	sc->input.reader = reader;
+	ASSERT_EQ(SuperCalc_runCsv(sc, "x * 2 + y", fds[0], out), 3u);
+	ASSERT_TRUE(sc->input.reader == reader);
+	LineReader_free(reader);
+	SuperCalc_free(sc);
+	close(fds[0]);
+	fclose(out);
+	
+	ASSERT_STREQ(output,
+		"2\t=\t7\n"
+		"3\t=\t1\n"
+		"5\t!\tRuntime Error: Expected 3 fields, not 2.\n"
+		"6\t=\t<2, 4>\n"
+		"7\t!\tName Error: No variable named 'nope' found.\n"
+		"8\t!\tRuntime Error: Expected 3 fields, not 2.\n");
+	free(output);
+}
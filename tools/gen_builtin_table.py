@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""
+Generates builtin_table.c, the perfect hash table behind Builtin_lookup.
+
+Run this from the repository root after adding, removing or renaming an
+entry in g_mathBuiltins (defaults_math.c) or g_vectorBuiltins
+(defaults_vector.c).
+"""
+
+import re
+import sys
+
+SOURCES = [
+	("defaults_math.c", "g_mathBuiltins"),
+	("defaults_vector.c", "g_vectorBuiltins"),
+]
+
+# Slots are picked with the top bits of the hash, since FNV's low bits mix poorly
+SLOT_BITS = 7
+SLOTS = 1 << SLOT_BITS
+ENTRY_RE = re.compile(r'\{"(\w+)", &eval_\w+, (?:true|false)\}')
+
+
+def read_builtins():
+	builtins = []
+	for path, table in SOURCES:
+		with open(path) as f:
+			src = f.read()
+		
+		start = src.index("const Builtin %s[] = {" % table)
+		end = src.index("};", start)
+		for i, name in enumerate(ENTRY_RE.findall(src[start:end])):
+			builtins.append((name, table, i))
+	
+	return builtins
+
+
+# Must match builtinSlot in the generated code: FNV-1a with a seeded basis
+def slot(name, seed):
+	h = 2166136261 ^ seed
+	for c in name.encode():
+		h ^= c
+		h = (h * 16777619) & 0xffffffff
+	return h >> (32 - SLOT_BITS)
+
+
+def find_seed(names):
+	for seed in range(1 << 24):
+		slots = {slot(name, seed) for name in names}
+		if len(slots) == len(names):
+			return seed
+	
+	sys.exit("No perfect hash seed found, increase SLOTS")
+
+
+def main():
+	builtins = read_builtins()
+	if len(builtins) >= min(SLOTS, 256):
+		sys.exit("Too many builtins for %d slots" % SLOTS)
+	
+	seed = find_seed([name for name, _, _ in builtins])
+	
+	slots = [0] * SLOTS
+	for i, (name, _, _) in enumerate(builtins):
+		slots[slot(name, seed)] = i + 1
+	
+	out = []
+	out.append("/*")
+	out.append("  builtin_table.c")
+	out.append("  SuperCalc")
+	out.append("")
+	out.append("  Generated by tools/gen_builtin_table.py. Do not edit, run it again instead.")
+	out.append("  Copyright (c) 2026 C0deH4cker. All rights reserved.")
+	out.append("*/")
+	out.append("")
+	out.append('#include "builtin.h"')
+	out.append("#include <string.h>")
+	out.append("#include <stdint.h>")
+	out.append("")
+	out.append('#include "defaults.h"')
+	out.append('#include "value.h"')
+	out.append('#include "variable.h"')
+	out.append("")
+	out.append("")
+	out.append("#define BUILTIN_COUNT %d" % len(builtins))
+	out.append("#define BUILTIN_SLOT_BITS %d" % SLOT_BITS)
+	out.append("#define BUILTIN_SEED 0x%xu" % seed)
+	out.append("")
+	out.append("/* Values and variables handed out by Builtin_lookup */")
+	out.append("static Value _builtinValues[BUILTIN_COUNT] = {")
+	out.append(",\n".join("\t{.type = VAL_BUILTIN, .blt = &%s[%d]}" % (table, i) for _, table, i in builtins))
+	out.append("};")
+	out.append("")
+	out.append("static Variable _builtinVars[BUILTIN_COUNT] = {")
+	out.append(",\n".join('\t{(char*)"%s", &_builtinValues[%d]}' % (name, i) for i, (name, _, _) in enumerate(builtins)))
+	out.append("};")
+	out.append("")
+	out.append("/* One more than the index of the builtin in each hash slot, or zero if it's empty */")
+	out.append("static const uint8_t _builtinSlots[1 << BUILTIN_SLOT_BITS] = {")
+	for row in range(0, SLOTS, 16):
+		out.append("\t" + ", ".join("%2d" % x for x in slots[row:row + 16]) + ("," if row + 16 < SLOTS else ""))
+	out.append("};")
+	out.append("")
+	out.append("")
+	out.append("static unsigned builtinSlot(const char* name) {")
+	out.append("\tuint32_t hash = 2166136261u ^ BUILTIN_SEED;")
+	out.append("\t")
+	out.append("\tfor(; *name != '\\0'; name++) {")
+	out.append("\t\thash ^= (unsigned char)*name;")
+	out.append("\t\thash *= 16777619u;")
+	out.append("\t}")
+	out.append("\t")
+	out.append("\treturn hash >> (32 - BUILTIN_SLOT_BITS);")
+	out.append("}")
+	out.append("")
+	out.append("Variable* Builtin_lookup(const char* name) {")
+	out.append("\tunsigned index = _builtinSlots[builtinSlot(name)];")
+	out.append("\tif(index == 0) {")
+	out.append("\t\treturn NULL;")
+	out.append("\t}")
+	out.append("\t")
+	out.append("\tVariable* var = &_builtinVars[index - 1];")
+	out.append("\treturn strcmp(var->name, name) == 0 ? var : NULL;")
+	out.append("}")
+	
+	with open("builtin_table.c", "w") as f:
+		f.write("\n".join(out) + "\n")
+
+
+if __name__ == "__main__":
+	main()
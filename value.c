@@ -15,6 +15,7 @@
 #include <errno.h>
 #include <math.h>
 #include <float.h>
+#include <limits.h>
 
 #include "support.h"
 #include "error.h"
@@ -29,14 +30,31 @@
 #include "arglist.h"
 #include "supercalc.h"
 #include "template.h"
+#include "symbol.h"
 
 
+/*
+ Right spine of a partially parsed expression tree, from the root down to the
+ node that is still missing its right operand. Operator nodes are only ever
+ attached along this spine, so keeping it as a stack makes parsing linear.
+*/
+typedef struct {
+	BinOp* _Nonnull * _Nullable nodes;
+	unsigned count;
+	unsigned cap;
+} Spine;
+
 static Value* allocValue(VALTYPE type);
-static void treeAddValue(BinOp** tree, BinOp** prev, BINTYPE op, Value* val);
+static void spinePush(Spine* spine, BinOp* node);
+static void spineAdd(Spine* spine, BINTYPE op, Value* val);
+static void spineFree(Spine* spine);
+static Value* parseNumSlow(const char** expr);
+static Value* _Nullable exactDecimal(unsigned long long mant, int exp10);
 static Value* parseNum(const char** expr);
 static Value* subscriptVector(Value* val, const char** expr, parser_cb* cb);
 static Value* callFunc(Value* val, const char** expr, parser_cb* cb);
 static Value* parseToken(const char** expr, parser_cb* cb);
+static bool isSettled(const Value* val, const Context* ctx);
 
 
 /* By default, the '@' character is illegal */
@@ -80,10 +98,22 @@ Value* ValReal(double val) {
 	return ret;
 }
 
+Value* ValOverflow(double val) {
+	Value* ret = ValReal(val);
+	ret->flags |= VF_OVERFLOW;
+	return ret;
+}
+
 Value* ValFrac(Fraction* frac) {
+	/* Fractions are simplified by whoever builds them, so just check for whole numbers */
+	if(frac->d == 1) {
+		Value* ret = ValInt(frac->n);
+		Fraction_free(frac);
+		return ret;
+	}
+	
 	Value* ret = allocValue(VAL_FRAC);
 	ret->frac = frac;
-	Fraction_reduce(ret);
 	return ret;
 }
 
@@ -105,7 +135,7 @@ Value* ValCall(FuncCall* call) {
 	return ret;
 }
 
-Value* ValVar(char* name) {
+Value* ValVar(const char* name) {
 	Value* ret = allocValue(VAL_VAR);
 	ret->name = name;
 	return ret;
@@ -123,7 +153,7 @@ Value* ValFunc(Function* func) {
 	return ret;
 }
 
-Value* ValBuiltin(Builtin* blt) {
+Value* ValBuiltin(const Builtin* blt) {
 	Value* ret = allocValue(VAL_BUILTIN);
 	ret->blt = blt;
 	return ret;
@@ -135,6 +165,18 @@ Value* ValPlace(Placeholder* ph) {
 	return ret;
 }
 
+Value* ValIndex(Subscript* sub) {
+	Value* ret = allocValue(VAL_INDEX);
+	ret->sub = sub;
+	return ret;
+}
+
+Value* ValXReal(DDReal val) {
+	Value* ret = allocValue(VAL_XREAL);
+	ret->xreal = DDReal_new(val);
+	return ret;
+}
+
 void Value_free(Value* val) {
 	if(!val) {
 		return;
@@ -157,10 +199,6 @@ void Value_free(Value* val) {
 			Fraction_free(val->frac);
 			break;
 		
-		case VAL_VAR:
-			destroy(val->name);
-			break;
-		
 		case VAL_VEC:
 			Vector_free(val->vec);
 			break;
@@ -173,8 +211,21 @@ void Value_free(Value* val) {
 			Function_free(val->func);
 			break;
 		
-		case VAL_BUILTIN:
-			Builtin_free(val->blt);
+		case VAL_XREAL:
+			DDReal_free(val->xreal);
+			break;
+		
+		case VAL_PLACE:
+			Placeholder_free(val->ph);
+			break;
+		
+		case VAL_INDEX:
+			Subscript_free(val->sub);
+			break;
+		
+		case VAL_VAR:
+			Symbol_release(val->name);
+			destroy(val->cache);
 			break;
 		
 		default:
@@ -214,13 +265,21 @@ Value* Value_copy(const Value* val) {
 			break;
 		
 		case VAL_VAR:
-			ret = ValVar(strdup(val->name));
+			ret = ValVar(Symbol_retain(val->name));
 			break;
 		
 		case VAL_VEC:
 			ret = ValVec(Vector_copy(val->vec));
 			break;
 		
+		case VAL_PLACE:
+			ret = ValPlace(Placeholder_copy(val->ph));
+			break;
+		
+		case VAL_INDEX:
+			ret = ValIndex(Subscript_copy(val->sub));
+			break;
+		
 		case VAL_NEG:
 			/* Shouldn't be reached, but so easy to code */
 			ret = ValNeg();
@@ -235,7 +294,11 @@ Value* Value_copy(const Value* val) {
 			break;
 		
 		case VAL_BUILTIN:
-			ret = ValBuiltin(Builtin_copy(val->blt));
+			ret = ValBuiltin(val->blt);
+			break;
+		
+		case VAL_XREAL:
+			ret = ValXReal(*val->xreal);
 			break;
 		
 		default:
@@ -243,6 +306,7 @@ Value* Value_copy(const Value* val) {
 			badValType(val->type);
 	}
 	
+	ret->flags = val->flags;
 	return ret;
 }
 
@@ -266,13 +330,12 @@ Value* Value_eval(const Value* val, const Context* ctx) {
 			ret = FuncCall_eval(val->call, ctx);
 			break;
 		
-		case VAL_FRAC:
-			ret = Value_copy(val);
-			Fraction_reduce(ret);
+		case VAL_INDEX:
+			ret = Subscript_eval(val->sub, ctx);
 			break;
 		
 		case VAL_VAR:
-			var = Variable_get(ctx, val->name);
+			var = Value_lookup(val, ctx);
 			if(var) {
 				ret = Variable_eval(var, ctx);
 			}
@@ -285,6 +348,30 @@ Value* Value_eval(const Value* val, const Context* ctx) {
 			ret = Vector_eval(val->vec, ctx);
 			break;
 		
+		case VAL_PLACE:
+			ret = Template_evalArgument(val->ph, ctx);
+			break;
+		
+		case VAL_FRAC:
+			if(Context_getMode(ctx) == MODE_FLOAT) {
+				/* Fractions computed before switching modes */
+				ret = ValReal(Fraction_asReal(val->frac));
+			}
+			else {
+				/* Lazy fractions are left as-is until Value_canonicalize */
+				ret = Value_copy(val);
+			}
+			break;
+		
+		case VAL_XREAL:
+			if(Context_getMode(ctx) == MODE_FLOAT) {
+				ret = ValReal(DDReal_asReal(*val->xreal));
+			}
+			else {
+				ret = Value_copy(val);
+			}
+			break;
+		
 		/* These can't be simplified, so just copy them */
 		case VAL_INT:
 		case VAL_REAL:
@@ -303,6 +390,93 @@ Value* Value_eval(const Value* val, const Context* ctx) {
 	return ret;
 }
 
+void Value_canonicalize(Value* val) {
+	unsigned i;
+	
+	switch(val->type) {
+		case VAL_FRAC:
+			Fraction_reduce(val);
+			break;
+		
+		case VAL_VEC:
+			for(i = 0; i < val->vec->vals->count; i++) {
+				Value_canonicalize(val->vec->vals->args[i]);
+			}
+			break;
+		
+		default:
+			/* Everything else only has one representation */
+			break;
+	}
+}
+
+Variable* Value_lookup(const Value* val, const Context* ctx) {
+	VarCache* cache = __atomic_load_n(&val->cache, __ATOMIC_ACQUIRE);
+	if(cache == NULL) {
+		/* Parse trees are shared between threads, so only one of them gets to add the cache */
+		VarCache* fresh = fmalloc(sizeof(*fresh));
+		if(__atomic_compare_exchange_n((VarCache**)&val->cache, &cache, fresh, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+			cache = fresh;
+		}
+		else {
+			destroy(fresh);
+		}
+	}
+	
+	return Context_getCached(ctx, val->name, CAST_NONNULL(cache));
+}
+
+static bool isSettled(const Value* val, const Context* ctx) {
+	switch(val->type) {
+		case VAL_INT:
+		case VAL_REAL:
+		case VAL_FUNC:
+			return true;
+		
+		case VAL_FRAC:
+		case VAL_XREAL:
+			/* Floating mode converts these to reals when evaluated */
+			return Context_getMode(ctx) != MODE_FLOAT;
+		
+		case VAL_BUILTIN:
+			/* Constants like pi are evaluated by Value_coerce */
+			return val->blt->isFunction;
+		
+		case VAL_VEC: {
+			/* Only the common case of a vector of numbers, which is what large vectors tend to be */
+			const ArgList* vals = val->vec->vals;
+			unsigned i;
+			for(i = 0; i < vals->count; i++) {
+				if(!Value_isNumber(vals->args[i]) || !isSettled(vals->args[i], ctx)) {
+					return false;
+				}
+			}
+			return true;
+		}
+		
+		default:
+			return false;
+	}
+}
+
+const Value* Value_borrow(const Value* val, const Context* ctx) {
+	switch(val->type) {
+		case VAL_VAR: {
+			Variable* var = Value_lookup(val, ctx);
+			return var != NULL && isSettled(var->val, ctx) ? var->val : NULL;
+		}
+		
+		case VAL_PLACE: {
+			/* An argument that is itself a placeholder belongs to another template's frame */
+			const Value* arg = Template_argument(val->ph);
+			return arg != NULL && arg->type != VAL_PLACE ? Value_borrow(arg, ctx) : NULL;
+		}
+		
+		default:
+			return isSettled(val, ctx) ? val : NULL;
+	}
+}
+
 Value* Value_coerce(const Value* val, const Context* ctx) {
 	Value* ret = Value_eval(val, ctx);
 	
@@ -342,6 +516,19 @@ bool Value_isCallable(const Value* val) {
 	}
 }
 
+bool Value_isNumber(const Value* val) {
+	switch(val->type) {
+		case VAL_INT:
+		case VAL_REAL:
+		case VAL_FRAC:
+		case VAL_XREAL:
+			return true;
+		
+		default:
+			return false;
+	}
+}
+
 double Value_asReal(const Value* val) {
 	double ret;
 	
@@ -358,6 +545,10 @@ double Value_asReal(const Value* val) {
 			ret = Fraction_asReal(val->frac);
 			break;
 		
+		case VAL_XREAL:
+			ret = DDReal_asReal(*val->xreal);
+			break;
+		
 		default:
 			/* Expression couldn't be evaluated, so it's not a number */
 			ret = NAN;
@@ -380,8 +571,7 @@ Value* Value_parseTop(const char** expr) {
 Value* Value_parse(const char** expr, char sep, char end, parser_cb* cb) {
 	Value* val;
 	BINTYPE op = BIN_UNK;
-	BinOp* tree = NULL;
-	BinOp* prev = NULL;
+	Spine spine = {NULL, 0, 0};
 	
 	while(1) {
 		/* Get next value */
@@ -389,17 +579,14 @@ Value* Value_parse(const char** expr, char sep, char end, parser_cb* cb) {
 		
 		/* Error parsing next value? */
 		if(val->type == VAL_ERR) {
-			if(tree) {
-				BinOp_free(tree);
-			}
-			
+			spineFree(&spine);
 			return val;
 		}
 		
 		/* End of input? */
 		if(val->type == VAL_END) {
-			if(tree) {
-				BinOp_free(tree);
+			if(spine.count > 0) {
+				spineFree(&spine);
 				Value_free(val);
 				return ValErr(earlyEnd(*expr));
 			}
@@ -413,14 +600,11 @@ Value* Value_parse(const char** expr, char sep, char end, parser_cb* cb) {
 			
 			BinOp* cur = BinOp_new(BIN_MUL, ValInt(-1), NULL);
 			
-			if(tree) {
-				prev->b = ValExpr(cur);
-			}
-			else {
-				tree = cur;
+			if(spine.count > 0) {
+				spine.nodes[spine.count - 1]->b = ValExpr(cur);
 			}
 			
-			prev = cur;
+			spinePush(&spine, cur);
 			continue;
 		}
 		
@@ -435,10 +619,7 @@ Value* Value_parse(const char** expr, char sep, char end, parser_cb* cb) {
 			/* Invalid operator? Return syntax error */
 			if(op == BIN_UNK) {
 				/* Exit gracefully and return error */
-				if(tree) {
-					BinOp_free(tree);
-				}
-				
+				spineFree(&spine);
 				Value_free(val);
 				return ValErr(badChar(*expr));
 			}
@@ -458,12 +639,12 @@ Value* Value_parse(const char** expr, char sep, char end, parser_cb* cb) {
 				}
 				
 				/* If there was only one value, return it */
-				if(!tree) {
+				if(spine.count == 0) {
 					return val;
 				}
 				
 				/* Otherwise, place the final value into the tree and break out of the parse loop */
-				prev->b = val;
+				spine.nodes[spine.count - 1]->b = val;
 				shouldBreak = true;
 				break;
 			}
@@ -473,59 +654,84 @@ Value* Value_parse(const char** expr, char sep, char end, parser_cb* cb) {
 		}
 		
 		/* Tree not yet begun? Initialize it! */
-		if(tree == NULL) {
-			tree = BinOp_new(op, val, NULL);
-			prev = tree;
+		if(spine.count == 0) {
+			spinePush(&spine, BinOp_new(op, val, NULL));
 		}
 		else {
 			/* Tree already started, so add to it */
-			treeAddValue(&tree, &prev, op, val);
+			spineAdd(&spine, op, val);
 		}
 	}
 	
+	BinOp* tree = spine.nodes[0];
+	destroy(spine.nodes);
 	return ValExpr(tree);
 }
 
-static void treeAddValue(BinOp** tree, BinOp** prev, BINTYPE op, Value* val) {
-	BinOp* parent = *tree;
-	BinOp* cur = *tree;
-	BinOp* next;
+static void spinePush(Spine* spine, BinOp* node) {
+	if(spine->count >= spine->cap) {
+		spine->cap = spine->cap ? spine->cap * 2 : 16;
+		spine->nodes = frealloc(spine->nodes, spine->cap * sizeof(*spine->nodes));
+	}
 	
+	spine->nodes[spine->count++] = node;
+}
+
+static void spineAdd(Spine* spine, BINTYPE op, Value* val) {
 	/*
-	 Descend down the right side of the tree until we find either an empty node or
-	 an operator with a higher precedence than the current one.
+	 The new operator takes the place of the highest spine node that binds at
+	 least as tightly as it does, or else becomes the right operand of the
+	 bottom node. Nodes that bind less tightly always form a prefix of the
+	 spine, so that node can be found by walking up from the bottom, and every
+	 node walked past is finished and never visited again.
 	 */
-	while(cur->b && BinOp_cmp(cur->type, op) < 0) {
-		parent = cur;
-		cur = cur->b->expr;
+	BinOp* prev = spine->nodes[spine->count - 1];
+	unsigned i = spine->count - 1;
+	while(i > 0 && BinOp_cmp(spine->nodes[i - 1]->type, op) >= 0) {
+		i--;
 	}
 	
+	BinOp* cur = spine->nodes[i];
+	BinOp* next;
+	
 	if(BinOp_cmp(cur->type, op) >= 0) {
 		/* Replace current node with new one */
-		if(cur == *tree) {
+		if(i == 0) {
 			/* At the tree's root */
-			next = BinOp_new(op, ValExpr(*tree), NULL);
-			*tree = next;
+			next = BinOp_new(op, ValExpr(cur), NULL);
 		}
 		else {
 			/* Somewhere in the tree */
+			BinOp* parent = spine->nodes[i - 1];
 			assert(parent->b != NULL);
 			next = BinOp_new(op, CAST_NONNULL(parent->b), NULL);
 			parent->b = ValExpr(next);
 		}
 		
-		(*prev)->b = val;
+		prev->b = val;
+		spine->count = i;
 	}
 	else {
 		/* New node is child of current node */
 		next = BinOp_new(op, val, NULL);
-		(*prev)->b = ValExpr(next);
+		prev->b = ValExpr(next);
 	}
 	
-	*prev = next;
+	spinePush(spine, next);
 }
 
-static Value* parseNum(const char** expr) {
+static void spineFree(Spine* spine) {
+	if(spine->count > 0) {
+		BinOp_free(spine->nodes[0]);
+	}
+	
+	destroy(spine->nodes);
+	spine->count = 0;
+	spine->cap = 0;
+}
+
+/* Fallback for literals the scanner doesn't handle itself, like hex */
+static Value* parseNumSlow(const char** expr) {
 	Value* ret;
 	char* end1;
 	char* end2;
@@ -561,6 +767,148 @@ static Value* parseNum(const char** expr) {
 	return ret;
 }
 
+/* Exact value of mant * 10^exp10 as an integer or fraction, or NULL if it doesn't fit */
+static Value* _Nullable exactDecimal(unsigned long long mant, int exp10) {
+	/* Trailing zeros only make the denominator bigger */
+	while(exp10 < 0 && mant != 0 && mant % 10 == 0) {
+		mant /= 10;
+		exp10++;
+	}
+	
+	if(mant > LLONG_MAX) {
+		return NULL;
+	}
+	
+	long long n = (long long)mant;
+	if(mant == 0 || exp10 >= 0) {
+		while(exp10-- > 0) {
+			if(mul_overflow(n, 10, &n)) {
+				return NULL;
+			}
+		}
+		
+		return ValInt(n);
+	}
+	
+	if(-exp10 > 18) {
+		return NULL;
+	}
+	
+	long long d = 1;
+	while(exp10++ < 0) {
+		d *= 10;
+	}
+	
+	return ValFrac(Fraction_new(n, d));
+}
+
+/*
+ Scans a decimal literal in one pass, collecting up to 19 significant digits
+ and a decimal exponent. Most reals are then computed exactly with a single
+ multiply or divide by a power of ten, only leaving long or extreme literals
+ to strtod.
+ */
+static Value* parseNum(const char** expr) {
+	static const double pow10[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+	const unsigned long long mantLimit = (ULLONG_MAX - 9) / 10;
+	const char* start = *expr;
+	const char* p = start;
+	
+	if(p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+		return parseNumSlow(expr);
+	}
+	
+	unsigned long long mant = 0;
+	int exp10 = 0;
+	bool truncated = false;
+	bool isReal = false;
+	bool anyDigits = false;
+	bool inFraction = false;
+	
+	for(;; p++) {
+		if(isdigit(*p)) {
+			anyDigits = true;
+			int digit = *p - '0';
+			
+			if(mant <= mantLimit) {
+				mant = mant * 10 + (unsigned long long)digit;
+				exp10 -= inFraction;
+			}
+			else {
+				/* Out of precision, so only keep track of the magnitude */
+				truncated |= digit != 0;
+				exp10 += !inFraction;
+			}
+		}
+		else if(*p == '.' && !inFraction) {
+			inFraction = true;
+			isReal = true;
+		}
+		else {
+			break;
+		}
+	}
+	
+	if(!anyDigits) {
+		return ValErr(badChar(start));
+	}
+	
+	/* An exponent needs digits, otherwise "2e" is 2 times e */
+	if(*p == 'e' || *p == 'E') {
+		const char* q = p + 1;
+		int sign = 1;
+		if(*q == '+' || *q == '-') {
+			sign = *q == '-' ? -1 : 1;
+			q++;
+		}
+		
+		if(isdigit(*q)) {
+			int exp = 0;
+			for(; isdigit(*q); q++) {
+				if(exp < 100000) {
+					exp = exp * 10 + (*q - '0');
+				}
+			}
+			
+			exp10 += sign * exp;
+			isReal = true;
+			p = q;
+		}
+	}
+	
+	*expr = p;
+	
+	if(!isReal && !truncated && exp10 == 0 && mant <= LLONG_MAX) {
+		return ValInt((long long)mant);
+	}
+	
+	if(isReal && Input_current()->exactDecimals && !truncated) {
+		Value* exact = exactDecimal(mant, exp10);
+		if(exact != NULL) {
+			return exact;
+		}
+	}
+	
+	/* Both the mantissa and the power of ten are exact doubles, so one operation rounds correctly */
+	if(!truncated && mant <= (1ull << 53) && exp10 >= -22 && exp10 <= 22) {
+		double dbl = (double)mant;
+		return ValReal(exp10 < 0 ? dbl / pow10[-exp10] : dbl * pow10[exp10]);
+	}
+	
+	errno = 0;
+	double dbl = strtod(start, NULL);
+	if(errno == ERANGE) {
+		/* Literals too big or small for a double are handled the slow way, which rejects them */
+		*expr = start;
+		return parseNumSlow(expr);
+	}
+	
+	return ValReal(dbl);
+}
+
 static Value* subscriptVector(Value* val, const char** expr, parser_cb* cb) {
 	/* Move past the '[' character */
 	(*expr)++;
@@ -577,14 +925,18 @@ static Value* subscriptVector(Value* val, const char** expr, parser_cb* cb) {
 		(*expr)++;
 	}
 	
-	/* Use builtin function from vector.c */
-	TP(tp);
-	return TP_FILL(tp, "@elem(@@, @@)", val, index);
+	/* Chained subscripts like "v[i][j]" all go in one node */
+	if(val->type == VAL_INDEX) {
+		Subscript_append(val->sub, index);
+		return val;
+	}
+	
+	return ValIndex(Subscript_new(val, index));
 }
 
 static Value* callFunc(Value* val, const char** expr, parser_cb* cb) {
 	/* Ugly, but parses better. Only variables and the results of calls can be funcs */
-	if(val->type != VAL_VAR && val->type != VAL_CALL && val->type != VAL_PLACE && val->type != VAL_FUNC) {
+	if(val->type != VAL_VAR && val->type != VAL_CALL && val->type != VAL_INDEX && val->type != VAL_PLACE && val->type != VAL_FUNC) {
 		return val;
 	}
 	
@@ -604,7 +956,7 @@ static Value* callFunc(Value* val, const char** expr, parser_cb* cb) {
 static Value* parseToken(const char** expr, parser_cb* cb) {
 	Value* ret;
 	
-	char* token = nextToken(expr);
+	const char* token = nextSymbol(expr);
 	if(token == NULL) {
 		return ValErr(badChar(*expr));
 	}
@@ -615,16 +967,14 @@ static Value* parseToken(const char** expr, parser_cb* cb) {
 		Error* err = NULL;
 		ArgList* arglist = ArgList_parse(expr, ',', ')', cb, &err);
 		if(arglist == NULL) {
-			destroy(token);
+			Symbol_release(token);
 			return ValErr(err);
 		}
 		
 		ret = ValCall(FuncCall_create(token, arglist));
-		token = NULL;
 	}
 	else {
 		ret = ValVar(token);
-		token = NULL;
 	}
 	
 	return ret;
@@ -726,7 +1076,9 @@ Value* Value_next(const char** expr, char sep, char end, parser_cb* cb) {
 				break;
 			
 			case '(':
+				/* Values that can't be called are left as they are */
 				tmp = callFunc(ret, expr, cb);
+				again = tmp != ret;
 				break;
 			
 			default:
@@ -734,7 +1086,7 @@ Value* Value_next(const char** expr, char sep, char end, parser_cb* cb) {
 				break;
 		}
 		
-		if(!again || tmp == ret) {
+		if(!again) {
 			break;
 		}
 		
@@ -767,6 +1119,10 @@ char* Value_repr(const Value* val, bool pretty, bool top) {
 			if(pretty && isinf(val->rval)) {
 				ret = strdup(val->rval < 0 ? "-∞" : "∞");
 			}
+			else if(top && (val->flags & VF_OVERFLOW)) {
+				/* Make it obvious that an integer result lost precision */
+				asprintf(&ret, "%.*g (overflow)", DBL_DIG, approx(val->rval));
+			}
 			else {
 				asprintf(&ret, "%.*g", DBL_DIG, approx(val->rval));
 			}
@@ -776,6 +1132,15 @@ char* Value_repr(const Value* val, bool pretty, bool top) {
 			ret = Fraction_repr(val->frac, top);
 			break;
 			
+		case VAL_XREAL:
+			ret = DDReal_repr(*val->xreal);
+			if(top && (val->flags & VF_OVERFLOW)) {
+				char* repr = ret;
+				asprintf(&ret, "%s (overflow)", repr);
+				destroy(repr);
+			}
+			break;
+		
 		case VAL_UNARY:
 			ret = UnOp_repr(val->term, pretty);
 			break;
@@ -788,6 +1153,10 @@ char* Value_repr(const Value* val, bool pretty, bool top) {
 			ret = FuncCall_repr(val->call, pretty);
 			break;
 			
+		case VAL_INDEX:
+			ret = Subscript_repr(val->sub, pretty);
+			break;
+		
 		case VAL_VAR:
 			ret = strdup(pretty ? getPretty(val->name) : val->name);
 			break;
@@ -832,6 +1201,10 @@ char* Value_wrap(const Value* val, bool top) {
 			ret = Fraction_repr(val->frac, top);
 			break;
 		
+		case VAL_XREAL:
+			ret = DDReal_repr(*val->xreal);
+			break;
+		
 		case VAL_UNARY:
 			ret = UnOp_wrap(val->term);
 			break;
@@ -844,6 +1217,10 @@ char* Value_wrap(const Value* val, bool top) {
 			ret = FuncCall_wrap(val->call);
 			break;
 		
+		case VAL_INDEX:
+			ret = Subscript_wrap(val->sub);
+			break;
+		
 		case VAL_VAR:
 			ret = strdup(val->name);
 			break;
@@ -888,6 +1265,10 @@ char* Value_verbose(const Value* val, unsigned indent) {
 			ret = Fraction_repr(val->frac, indent == 0);
 			break;
 		
+		case VAL_XREAL:
+			ret = DDReal_repr(*val->xreal);
+			break;
+		
 		case VAL_UNARY:
 			ret = UnOp_verbose(val->term, indent);
 			break;
@@ -900,6 +1281,10 @@ char* Value_verbose(const Value* val, unsigned indent) {
 			ret = FuncCall_verbose(val->call, indent);
 			break;
 		
+		case VAL_INDEX:
+			ret = Subscript_verbose(val->sub, indent);
+			break;
+		
 		case VAL_VAR:
 			ret = strdup(val->name);
 			break;
@@ -943,6 +1328,10 @@ char* Value_xml(const Value* val, unsigned indent) {
 			ret = Fraction_xml(val->frac);
 			break;
 			
+		case VAL_XREAL:
+			ret = DDReal_xml(*val->xreal);
+			break;
+		
 		case VAL_UNARY:
 			ret = UnOp_xml(val->term, indent);
 			break;
@@ -955,6 +1344,10 @@ char* Value_xml(const Value* val, unsigned indent) {
 			ret = FuncCall_xml(val->call, indent);
 			break;
 			
+		case VAL_INDEX:
+			ret = Subscript_xml(val->sub, indent);
+			break;
+		
 		case VAL_VAR:
 			if(val->name[0] == '@') {
 				asprintf(&ret,
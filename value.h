@@ -33,6 +33,8 @@ typedef struct parser_cb {
 #include "function.h"
 #include "builtin.h"
 #include "placeholder.h"
+#include "ddreal.h"
+#include "subscript.h"
 
 
 ASSUME_NONNULL_BEGIN
@@ -52,12 +54,20 @@ typedef enum {
 	VAL_VEC,
 	VAL_FUNC,
 	VAL_BUILTIN,
-	VAL_PLACE
+	VAL_PLACE,
+	VAL_XREAL,
+	VAL_INDEX
 } VALTYPE;
 
+typedef enum {
+	VF_NONE     = 0,
+	VF_OVERFLOW = 1<<0  /* Real or extended real that was promoted from an overflowing integer operation */
+} VALFLAGS;
+
 
 struct Value {
 	VALTYPE type;
+	VALFLAGS flags;
 	union {
 		      long long    ival;
 		      double       rval;
@@ -66,11 +76,17 @@ struct Value {
 		OWNED UnOp*        term;
 		OWNED BinOp*       expr;
 		OWNED FuncCall*    call;
-		OWNED char*        name;
+		struct {
+			const char*                      name;
+			/* Where the name was last found, filled in lazily */
+			OWNED struct VarCache* _Nullable cache;
+		};
 		OWNED Error*       err;
 		OWNED Function*    func;
-		OWNED Builtin*     blt;
+		const Builtin*     blt;
 		OWNED Placeholder* ph;
+		OWNED DDReal*      xreal;
+		OWNED Subscript*   sub;
 	};
 };
 
@@ -83,15 +99,18 @@ RETURNS_OWNED Value* ValErr(CONSUMED Error* err);
 RETURNS_OWNED Value* ValNeg(void);
 RETURNS_OWNED Value* ValInt(long long val);
 RETURNS_OWNED Value* ValReal(double val);
+RETURNS_OWNED Value* ValOverflow(double val);
 RETURNS_OWNED Value* ValFrac(CONSUMED Fraction* frac);
 RETURNS_OWNED Value* ValExpr(CONSUMED BinOp* expr);
 RETURNS_OWNED Value* ValUnary(CONSUMED UnOp* term);
 RETURNS_OWNED Value* ValCall(CONSUMED FuncCall* call);
-RETURNS_OWNED Value* ValVar(CONSUMED char* name);
+RETURNS_OWNED Value* ValVar(CONSUMED const char* name); /* name is a reference from symbol.h */
 RETURNS_OWNED Value* ValVec(CONSUMED Vector* vec);
 RETURNS_OWNED Value* ValFunc(CONSUMED Function* func);
-RETURNS_OWNED Value* ValBuiltin(CONSUMED Builtin* blt);
+RETURNS_OWNED Value* ValBuiltin(const Builtin* blt);
 RETURNS_OWNED Value* ValPlace(CONSUMED Placeholder* ph);
+RETURNS_OWNED Value* ValXReal(DDReal val);
+RETURNS_OWNED Value* ValIndex(CONSUMED Subscript* sub);
 
 /* Destructor */
 void Value_free(CONSUMED Value* _Nullable val);
@@ -102,10 +121,16 @@ RETURNS_OWNED Value* Value_copy(const Value* val);
 /* Evaluation */
 RETURNS_OWNED Value* Value_eval(const Value* val, const Context* ctx);
 RETURNS_OWNED Value* Value_coerce(const Value* val, const Context* ctx);
+/* Finds the variable a VAL_VAR refers to, remembering it for next time */
+RETURNS_UNOWNED Variable* _Nullable Value_lookup(const Value* val, const Context* ctx);
+/* What Value_coerce would return, without copying it, if that's already stored somewhere. Otherwise NULL */
+RETURNS_UNOWNED const Value* _Nullable Value_borrow(const Value* val, const Context* ctx);
 bool Value_isCallable(const Value* val);
+void Value_canonicalize(INOUT Value* val);
 
 /* Conversion */
 double Value_asReal(const Value* val);
+bool Value_isNumber(const Value* val);
 
 /* Parsing */
 RETURNS_OWNED Value* Value_parseTop(INOUT istring expr);
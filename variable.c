@@ -25,6 +25,7 @@
 
 Variable* Variable_new(char* name, Value* val) {
 	Variable* ret = fmalloc(sizeof(*ret));
+	Value_canonicalize(val);
 	ret->name = name;
 	ret->val = val;
 	return ret;
@@ -66,6 +67,7 @@ void Variable_update(Variable* dst, Value* src) {
 	Value_free(dst->val);
 	
 	/* Move value from src to dst */
+	Value_canonicalize(src);
 	dst->val = src;
 }
 
@@ -269,15 +269,9 @@ Value* Vector_dot(const Vector* vector1, const Vector* vector2, const Context* c
 		
 		/* accum += v1[i] * val2 */
 		TP(tp);
-		Value* v1 = Value_copy(vector1->vals->args[i]);
-		Value* v2 = Value_copy(val2);
-		Value* newAccum = TP_EVAL(tp, ctx, "@@+@@*@@",
-		                accum,
-		                v1,
-		                v2);
-		analyzer_consume(accum);
-		analyzer_consume(v1);
-		analyzer_consume(v2);
+		const Value* args[] = {accum, vector1->vals->args[i], val2};
+		Value* newAccum = TP_EVAL_ARGS(tp, ctx, "@@+@@*@@", args);
+		Value_free(accum);
 		accum = newAccum;
 	}
 	
@@ -315,28 +309,42 @@ Value* Vector_magnitude(const Vector* vec, const Context* ctx) {
 	return TP_EVAL(tp, ctx, "sqrt(dot(@1v,@1v))", Vector_copy(vec));
 }
 
-Value* Vector_elem(const Vector* vec, const Value* index, const Context* ctx) {
-	UNREFERENCED_PARAMETER(ctx);
-	
+const Value* Vector_at(const Vector* vec, const Value* index, Error** err) {
 	if(index->type != VAL_INT) {
-		return ValErr(typeError("Subscript index must be an integer."));
+		*err = typeError("Subscript index must be an integer.");
+		return NULL;
 	}
 	
 	if(index->ival < 0) {
-		return ValErr(mathError("Subscript index cannot be negative."));
+		*err = mathError("Subscript index cannot be negative.");
+		return NULL;
 	}
 	
 	if(index->ival > UINT_MAX) {
-		return ValErr(mathError("Subscript index %lld is too large.", index->ival));
+		*err = mathError("Subscript index %lld is too large.", index->ival);
+		return NULL;
 	}
 	
 	unsigned idx = (unsigned)index->ival;
 	
 	if(idx >= vec->vals->count) {
-		return ValErr(mathError("Index %u is out of range: [0-%u]", idx, vec->vals->count - 1));
+		*err = mathError("Index %u is out of range: [0-%u]", idx, vec->vals->count - 1);
+		return NULL;
+	}
+	
+	return vec->vals->args[idx];
+}
+
+Value* Vector_elem(const Vector* vec, const Value* index, const Context* ctx) {
+	UNREFERENCED_PARAMETER(ctx);
+	
+	Error* err = NULL;
+	const Value* elem = Vector_at(vec, index, &err);
+	if(elem == NULL) {
+		return ValErr(CAST_NONNULL(err));
 	}
 	
-	return Value_copy(vec->vals->args[index->ival]);
+	return Value_copy(elem);
 }
 
 char* Vector_repr(const Vector* vec, bool pretty) {
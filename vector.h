@@ -59,6 +59,8 @@ RETURNS_OWNED Value* Vector_normalize(const Vector* vec, const Context* ctx);
 
 /* Access Values */
 RETURNS_OWNED Value* Vector_elem(const Vector* vec, const Value* index, const Context* ctx);
+/* The element itself rather than a copy, or NULL with *err set when the index is bad */
+RETURNS_UNOWNED const Value* _Nullable Vector_at(const Vector* vec, const Value* index, OUT Error* _Nullable* _Nonnull err);
 
 /* Printing */
 RETURNS_OWNED char* Vector_repr(const Vector* vec, bool pretty);
@@ -0,0 +1,150 @@
+/*
+  workpool.c
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#include "workpool.h"
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "generic.h"
+
+
+struct WorkPool {
+	pthread_mutex_t lock;
+	pthread_cond_t wake;
+	pthread_cond_t done;
+	
+	OWNED pthread_t* threads;
+	unsigned threadCount;
+	
+	/* Current batch of tasks, which changes generation each time WorkPool_run is called */
+	workpool_task_t _Nullable task;
+	void* _Nullable data;
+	size_t count;
+	size_t next;
+	size_t finished;
+	unsigned long generation;
+	bool stopping;
+};
+
+
+static void* workerMain(void* arg);
+static void runTasks(WorkPool* pool);
+
+
+WorkPool* WorkPool_new(unsigned jobs) {
+	WorkPool* ret = fmalloc(sizeof(*ret));
+	pthread_mutex_init(&ret->lock, NULL);
+	pthread_cond_init(&ret->wake, NULL);
+	pthread_cond_init(&ret->done, NULL);
+	
+	ret->threadCount = jobs > 1 ? jobs - 1 : 0;
+	ret->threads = fcalloc(ret->threadCount ?: 1, sizeof(*ret->threads));
+	
+	unsigned i;
+	for(i = 0; i < ret->threadCount; i++) {
+		if(pthread_create(&ret->threads[i], NULL, &workerMain, ret) != 0) {
+			/* Make do with the threads that did start */
+			ret->threadCount = i;
+			break;
+		}
+	}
+	
+	return ret;
+}
+
+void WorkPool_free(WorkPool* pool) {
+	if(!pool) {
+		return;
+	}
+	
+	pthread_mutex_lock(&pool->lock);
+	pool->stopping = true;
+	pthread_cond_broadcast(&pool->wake);
+	pthread_mutex_unlock(&pool->lock);
+	
+	unsigned i;
+	for(i = 0; i < pool->threadCount; i++) {
+		pthread_join(pool->threads[i], NULL);
+	}
+	
+	pthread_cond_destroy(&pool->done);
+	pthread_cond_destroy(&pool->wake);
+	pthread_mutex_destroy(&pool->lock);
+	destroy(pool->threads);
+	destroy(pool);
+}
+
+/* Claims and runs tasks until none are left. Called with the lock held */
+static void runTasks(WorkPool* pool) {
+	/* Claim several tasks at a time so the lock isn't taken for every one */
+	size_t step = pool->count / (4 * (pool->threadCount + 1)) ?: 1;
+	
+	while(pool->next < pool->count) {
+		size_t first = pool->next;
+		size_t last = MIN(first + step, pool->count);
+		pool->next = last;
+		workpool_task_t task = CAST_NONNULL(pool->task);
+		void* data = pool->data;
+		
+		pthread_mutex_unlock(&pool->lock);
+		size_t i;
+		for(i = first; i < last; i++) {
+			task(data, i);
+		}
+		pthread_mutex_lock(&pool->lock);
+		
+		pool->finished += last - first;
+		if(pool->finished == pool->count) {
+			pthread_cond_broadcast(&pool->done);
+		}
+	}
+}
+
+static void* workerMain(void* arg) {
+	WorkPool* pool = arg;
+	unsigned long seen = 0;
+	
+	pthread_mutex_lock(&pool->lock);
+	while(true) {
+		while(!pool->stopping && pool->generation == seen) {
+			pthread_cond_wait(&pool->wake, &pool->lock);
+		}
+		
+		if(pool->stopping) {
+			break;
+		}
+		
+		seen = pool->generation;
+		runTasks(pool);
+	}
+	pthread_mutex_unlock(&pool->lock);
+	
+	return NULL;
+}
+
+void WorkPool_run(WorkPool* pool, size_t count, workpool_task_t task, void* data) {
+	if(count == 0) {
+		return;
+	}
+	
+	pthread_mutex_lock(&pool->lock);
+	pool->task = task;
+	pool->data = data;
+	pool->count = count;
+	pool->next = 0;
+	pool->finished = 0;
+	pool->generation++;
+	pthread_cond_broadcast(&pool->wake);
+	
+	runTasks(pool);
+	while(pool->finished < pool->count) {
+		pthread_cond_wait(&pool->done, &pool->lock);
+	}
+	pthread_mutex_unlock(&pool->lock);
+}
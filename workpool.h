@@ -0,0 +1,40 @@
+/*
+  workpool.h
+  SuperCalc
+
+  Created by C0deH4cker on 10/19/26.
+  Copyright (c) 2026 C0deH4cker. All rights reserved.
+*/
+
+#ifndef SC_WORKPOOL_H
+#define SC_WORKPOOL_H
+
+#include <stddef.h>
+
+#include "annotations.h"
+
+
+ASSUME_NONNULL_BEGIN
+
+/*
+ Fixed set of worker threads for running many independent tasks at once.
+ The thread that calls WorkPool_run helps out too, so a pool for N jobs
+ only starts N - 1 threads.
+*/
+typedef struct WorkPool WorkPool;
+
+/* Called once for each index from 0 to count - 1, in no particular order */
+typedef void (*workpool_task_t)(void* _Nullable data, size_t index);
+
+/* Constructor */
+RETURNS_OWNED WorkPool* WorkPool_new(unsigned jobs);
+
+/* Destructor, which waits for the workers to exit */
+void WorkPool_free(CONSUMED WorkPool* _Nullable pool);
+
+/* Runs every task and returns once they have all finished */
+void WorkPool_run(WorkPool* pool, size_t count, workpool_task_t task, void* _Nullable data);
+
+ASSUME_NONNULL_END
+
+#endif /* SC_WORKPOOL_H */